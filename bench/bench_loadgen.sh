@@ -0,0 +1,126 @@
+#!/bin/sh
+#############################################################################
+# File       : bench_loadgen.sh
+# Description: -ó  - loadgen( ) ǥ ӵ ÷    
+#              ո  --latency   ӵ  1 DURATION ,
+#                 ( ۽ ð  ) loadgen ۽ /޼ ӵ CSV 
+#              (޼ ӵ ǥ  ġų p99 ް Ŀ   ȭ)
+#              : bench_loadgen.sh [-d ] [-s ڵ Ʈ] [-r "ӵ ..."] [-c CPU,Ŭ̾ƮCPU | none]
+#                                       [-o  ͸] [ ...]
+#              : tcpws-raw tcpws-ws tcpws-lws ws-ws ws-lws (⺻ ü,    ǳʶ)
+#############################################################################
+
+DURATION=5
+SIZE=110
+RATES="10000 50000 100000 200000 500000 1000000"
+CPUS=
+OUT=$(cd "$(dirname "$0")" && pwd)/results
+
+usage()
+{
+    echo ": $0 [-d ] [-s ڵ Ʈ] [-r \"ӵ ...\"] [-c CPU,Ŭ̾ƮCPU | none] [-o  ͸] [ ...]" >&2
+    exit 1
+}
+
+while getopts "d:s:r:c:o:h" opt; do
+    case $opt in
+        d) DURATION=$OPTARG ;;
+        s) SIZE=$OPTARG ;;
+        r) RATES=$OPTARG ;;
+        c) CPUS=$OPTARG ;;
+        o) OUT=$OPTARG ;;
+        *) usage ;;
+    esac
+done
+shift $((OPTIND - 1))
+[ $# -eq 0 ] && set -- tcpws-raw tcpws-ws tcpws-lws ws-ws ws-lws
+
+. "$(dirname "$0")/common.sh"
+export LC_ALL=C     #  (EUC-KR) Ʈ  
+LATENCY_LINE='^\[LATENCY\] ڵ p50'
+
+# CPU  (bench_matrix.sh  ⺻)
+if [ -z "$CPUS" ]; then
+    ncpu=$(nproc)
+    if [ "$ncpu" -ge 3 ]; then CPUS=1,2
+    elif [ "$ncpu" -eq 2 ]; then CPUS=0,1
+    else CPUS=none
+    fi
+fi
+if [ "$CPUS" = none ] || ! command -v taskset > /dev/null; then
+    PIN_SERVER=; PIN_CLIENT=; CPUS=none
+else
+    PIN_SERVER="taskset -c ${CPUS%,*}"; PIN_CLIENT="taskset -c ${CPUS#*,}"
+fi
+
+mkdir -p "$OUT/logs" || exit 1
+CURVE_CSV="$OUT/latency_curve.csv"
+echo "server,mode,target_rps,achieved_rps,mb_per_s,lag_p50_us,lag_p99_us,lag_max_us,server_p50_us,server_p90_us,server_p99_us,server_p999_us,server_max_us" > "$CURVE_CSV"
+
+# $1: JSON  , $2: Ű  
+json_value()
+{
+    echo "$1" | sed -n "s/.*\"$2\":\([^,}]*\).*/\1/p"
+}
+
+# $1:  α, $2: ٸ Ằ     "p50 p90 p99 p99.9 max" (ð ʰ  ڿ)
+server_latency()
+{
+    waited=0
+    while [ "$(grep -c "$LATENCY_LINE" "$1")" -lt "$2" ]; do
+        sleep 0.05
+        waited=$((waited + 1))
+        [ $waited -ge 200 ] && return
+    done
+    grep "$LATENCY_LINE" "$1" | tail -n 1 | sed 's/[^0-9.]\{1,\}/ /g' | awk '{ print $2, $4, $6, $8, $9 }'
+}
+
+# $1:  (-)
+run_curve()
+{
+    combo=$1
+    case $combo in
+        tcpws-*) server=server_tcpws ;;
+        ws-*)    server=server_ws ;;
+        *)       echo "   : $combo" >&2; return ;;
+    esac
+    mode=${combo#*-}
+    log="$OUT/logs/loadgen-$combo.log"
+
+    if [ ! -x "$BIN_DIR/$server" ] || [ ! -x "$BIN_DIR/loadgen" ]; then
+        printf "%-10s ǳʶ ( )\n" "$combo"
+        return
+    fi
+
+    $PIN_SERVER stdbuf -oL "$BIN_DIR/$server" --latency > "$log" 2>&1 &
+    SERVER_PID=$!
+    sleep 0.3
+
+    i=1
+    for rate in $RATES; do
+        if ! out=$($PIN_CLIENT "$BIN_DIR/loadgen" --mode "$mode" --rate "$rate" --duration "$DURATION" \
+                   --size "$SIZE" --json 2> "$WORK/loadgen.err"); then
+            printf "%-10s %9s rec/s : %s\n" "$combo" "$rate" "$(head -n 1 "$WORK/loadgen.err")"
+            break
+        fi
+        lat=$(server_latency "$log" $i)
+        [ -z "$lat" ] && lat="- - - - -"
+        set -- $lat
+        echo "$server,$mode,$rate,$(json_value "$out" achieved_rps),$(json_value "$out" achieved_mb_per_s),$(json_value "$out" lag_p50_us),$(json_value "$out" lag_p99_us),$(json_value "$out" lag_max_us),$1,$2,$3,$4,$5" >> "$CURVE_CSV"
+        printf "%-12s %-4s ǥ %9s ޼ %11s rec/s   p50 %10s p99 %10s max %10s us\n" \
+               "$server" "$mode" "$rate" "$(json_value "$out" achieved_rps)" "$1" "$3" "$5"
+        i=$((i + 1))
+    done
+
+    kill $SERVER_PID 2>/dev/null; wait $SERVER_PID 2>/dev/null
+    SERVER_PID=
+    sleep 0.2
+}
+
+echo "ڵ $SIZE Ʈ, ӵ $DURATION , CPU  $CPUS"
+
+for combo in "$@"; do
+    run_curve "$combo"
+done
+
+echo ": $CURVE_CSV ( α $OUT/logs)"
@@ -0,0 +1,230 @@
+#!/bin/sh
+#############################################################################
+# File       : bench_matrix.sh
+# Description: README  ǥ Ŭ̾Ʈ/  src(file) / src(record)  ݺ 
+#              ո      RUNS ,  ҿ ð / Ŭ̾Ʈ
+#              ҿ ð /   MB/s / Ŭ̾Ʈ send ȣ  / Ŭ̾Ʈ CPU(user, sys)
+#              , ǥ, ּ, ִ븦 CSV JSON 
+#              Ŭ̾Ʈ  --json    (client_bytes WS    ۽ŷ,
+#              src(file) Ŭ̾Ʈ --json  ҿ ð ũƮ   ð,   )
+#               Ŭ̾Ʈ taskset  ٸ CPU  ()
+#              Է -d  Ǵ gen_records ɼ(-g,  õ) ,   ڵ 
+#               ڵ  ٸ ǥ (1023 Ʈ Ѵ   ڵ   )
+#              : bench_matrix.sh [-n ݺ] [-w ] [-d  | -g "gen_records ɼ"]
+#                                      [-c CPU,Ŭ̾ƮCPU | none] [-o  ͸] [record] [file]
+#############################################################################
+
+RUNS=5
+WARMUP=1
+DATA=
+GEN_OPTS="--size 44m --seed 42"
+CPUS=
+OUT=$(cd "$(dirname "$0")" && pwd)/results
+CLIENT_TIMEOUT=300
+
+usage()
+{
+    echo ": $0 [-n ݺ] [-w ] [-d  | -g \"gen_records ɼ\"] [-c CPU,Ŭ̾ƮCPU | none] [-o  ͸] [record] [file]" >&2
+    exit 1
+}
+
+while getopts "n:w:d:g:c:o:h" opt; do
+    case $opt in
+        n) RUNS=$OPTARG ;;
+        w) WARMUP=$OPTARG ;;
+        d) DATA=$OPTARG ;;
+        g) GEN_OPTS=$OPTARG ;;
+        c) CPUS=$OPTARG ;;
+        o) OUT=$OPTARG ;;
+        *) usage ;;
+    esac
+done
+shift $((OPTIND - 1))
+[ $# -eq 0 ] && set -- record file
+
+. "$(dirname "$0")/common.sh"
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+EXPECTED=
+export LC_ALL=C     #  (EUC-KR) Ʈ  
+SERVER_LINE=': [0-9]*\.[0-9]\{6\} [^ ]*$'
+
+# CPU : ⺻ CPU 3 ̸̻ 1,2 (0 ͷƮ ó Ƿ ), 2 0,1
+if [ -z "$CPUS" ]; then
+    ncpu=$(nproc)
+    if [ "$ncpu" -ge 3 ]; then CPUS=1,2
+    elif [ "$ncpu" -eq 2 ]; then CPUS=0,1
+    else CPUS=none
+    fi
+fi
+if [ "$CPUS" = none ] || ! command -v taskset > /dev/null; then
+    PIN_SERVER=; PIN_CLIENT=; CPUS=none
+else
+    PIN_SERVER="taskset -c ${CPUS%,*}"; PIN_CLIENT="taskset -c ${CPUS#*,}"
+fi
+
+# Է :   gen_records  ( ɼ̸ ׻  )
+if [ -z "$DATA" ]; then
+    GEN="$ROOT/src(record)/gen_records"
+    [ -x "$GEN" ] || make -C "$ROOT/src(record)" gen_records > /dev/null || exit 1
+    DATA="$WORK/data.txt"
+    $GEN $GEN_OPTS --output "$DATA" 2> "$WORK/gen.txt" || { cat "$WORK/gen.txt" >&2; exit 1; }
+    EXPECTED=$(sed -n 's/^records=\([0-9]*\) .*/\1/p' "$WORK/gen.txt")
+    echo "gen_records $GEN_OPTS: $(cat "$WORK/gen.txt")"
+fi
+[ -r "$DATA" ] || { echo "Է    ϴ: $DATA" >&2; exit 1; }
+
+mkdir -p "$OUT/logs" || exit 1
+RUNS_CSV="$OUT/runs.csv"
+SUMMARY_CSV="$OUT/summary.csv"
+SUMMARY_JSON="$OUT/summary.json"
+echo "variant,server,client,run,bytes,records,server_s,client_s,server_mb_per_s,client_bytes,send_calls,cpu_user_s,cpu_sys_s" > "$RUNS_CSV"
+
+now_s()
+{
+    date +%s.%N
+}
+
+# $1: JSON  , $2: Ű  
+json_value()
+{
+    echo "$1" | sed -n "s/.*\"$2\":\([^,}]*\).*/\1/p"
+}
+
+# $1:  α, $2: ٸ     "Ʈ ڵ ҿð" (ð ʰ  ڿ)
+#   ù °  Ʈ,  °  ڵ  (src(file) ڵ   "-")
+server_result()
+{
+    waited=0
+    while [ "$(grep -c "$SERVER_LINE" "$1")" -lt "$2" ]; do
+        sleep 0.05
+        waited=$((waited + 1))
+        [ $waited -ge 1200 ] && return
+    done
+    grep "$SERVER_LINE" "$1" | tail -n 1 | awk '{
+        t = $0; sub(/^.*: /, "", t); sub(/ .*$/, "", t)
+        s = $0; sub(/: [0-9.]+ [^ ]*$/, "", s)
+        n = 0
+        while (n < 2 && match(s, /[0-9]+/)) { v[++n] = substr(s, RSTART, RLENGTH); s = substr(s, RSTART + RLENGTH) }
+        print v[1], (n > 1 ? v[2] : "-"), t
+    }'
+}
+
+# $1: variant, $2: , $3: Ŭ̾Ʈ
+#    WARMUP +  RUNS , ȸ  runs.csv ߰
+run_combo()
+{
+    variant=$1; server=$2; client=$3
+    dir="$ROOT/src($variant)"
+    log="$OUT/logs/$variant-$server-$client.log"
+
+    if [ ! -x "$dir/$server" ] || [ ! -x "$dir/$client" ]; then
+        printf "%-7s %-13s %-14s ǳʶ ( )\n" "$variant" "$server" "$client"
+        return
+    fi
+
+    # src(file) Ŭ̾Ʈ  (--json) 
+    json=
+    [ "$variant" = record ] && json=--json
+
+    $PIN_SERVER stdbuf -oL "$dir/$server" > "$log" 2>&1 &
+    SERVER_PID=$!
+    sleep 0.3
+
+    i=1; total=$((WARMUP + RUNS))
+    while [ $i -le $total ]; do
+        start=$(now_s)
+        if ! $PIN_CLIENT timeout $CLIENT_TIMEOUT "$dir/$client" $json "$DATA" > "$WORK/client.out" 2>&1; then
+            printf "%-7s %-13s %-14s Ŭ̾Ʈ  (ȸ %d)\n" "$variant" "$server" "$client" $i
+            break
+        fi
+        end=$(now_s)
+        report=$(grep '^{"client"' "$WORK/client.out" | tail -n 1)
+        result=$(server_result "$log" $i)
+        if [ -z "$result" ]; then
+            printf "%-7s %-13s %-14s    (ȸ %d)\n" "$variant" "$server" "$client" $i
+            break
+        fi
+        if [ $i -gt "$WARMUP" ]; then
+            echo "$result" | awk -v v="$variant" -v s="$server" -v c="$client" -v r=$((i - WARMUP)) \
+                -v t0="$start" -v t1="$end" -v cs="$(json_value "$report" wall_s)" \
+                -v cb="$(json_value "$report" bytes)" -v sc="$(json_value "$report" send_calls)" \
+                -v cu="$(json_value "$report" cpu_user_s)" -v cy="$(json_value "$report" cpu_sys_s)" '{
+                printf "%s,%s,%s,%d,%s,%s,%s,%.6f,%.3f,%s,%s,%s,%s\n", v, s, c, r, $1, $2, $3,
+                       (cs != "" ? cs : t1 - t0), ($3 > 0 ? $1 / 1048576 / $3 : 0), cb, sc, cu, cy
+            }' >> "$RUNS_CSV"
+        fi
+        i=$((i + 1))
+    done
+
+    kill $SERVER_PID 2>/dev/null; wait $SERVER_PID 2>/dev/null
+    SERVER_PID=
+    #  Ʈ   (  bind  )
+    sleep 0.2
+
+    awk -F, -v v="$variant" -v s="$server" -v c="$client" -v e="$EXPECTED" \
+        '$1 == v && $2 == s && $3 == c { n++; t += $7; m += $9; r = $6 }
+         END {
+            if (n) printf "%-7s %-13s %-14s %dȸ   %.6f , %.2f MB/s", v, s, c, n, t / n, m / n
+            if (n && e != "" && r != "-" && r != e) printf "  ( ڵ %s,  %s)", r, e
+            if (n) printf "\n"
+         }' "$RUNS_CSV"
+}
+
+echo "Է: $DATA ($(wc -c < "$DATA") Ʈ), ݺ $RUNS ( $WARMUP), CPU  $CPUS"
+
+# README   (Ŭ̾Ʈ  )
+for variant in "$@"; do
+    run_combo "$variant" server_tcpws client_rawtcp
+    run_combo "$variant" server_tcpws client_tcp2ws
+    run_combo "$variant" server_tcpws client_ws2tcp
+    run_combo "$variant" server_ws    client_ws
+    run_combo "$variant" server_tcpws client_ws
+    run_combo "$variant" server_ws    client_tcp2ws
+done
+
+#   ǥ  / ǥ ǥ / ּ / ִ
+awk -F, -v csv="$SUMMARY_CSV" -v json="$SUMMARY_JSON" -v data="$DATA" -v cpus="$CPUS" \
+    -v runs="$RUNS" -v warmup="$WARMUP" -v kernel="$(uname -r)" -v gen="$GEN_OPTS" -v expected="$EXPECTED" '
+    # ǥ : server_s, client_s, server_mb_per_s, send_calls, cpu_user_s, cpu_sys_s (  )
+    NR == 1 { nm = split("7 8 9 11 12 13", mcol, " "); for (j = 1; j <= nm; j++) metric[mcol[j]] = $mcol[j]; next }
+    {
+        key = $1 "," $2 "," $3
+        if (!(key in n)) {
+            order[++keys] = key; bytes[key] = $5; records[key] = ($6 == "-" ? "null" : $6)
+            client_bytes[key] = ($10 == "" ? "null" : $10)
+        }
+        n[key]++
+        for (m = 1; m <= nm; m++) {
+            j = mcol[m]; k = key SUBSEP j
+            if ($j == "") continue
+            cnt[k]++; sum[k] += $j; sq[k] += $j * $j
+            if (!(k in min) || $j < min[k]) min[k] = $j
+            if (!(k in max) || $j > max[k]) max[k] = $j
+        }
+    }
+    END {
+        print "variant,server,client,runs,bytes,records,metric,mean,stddev,min,max" > csv
+        printf "{\"data\":\"%s\",\"generator\":\"%s\",\"expected_records\":%s,\"runs\":%d,\"warmup\":%d,\"cpus\":\"%s\",\"kernel\":\"%s\",\"results\":[",
+               data, (expected != "" ? gen : ""), (expected != "" ? expected : "null"), runs, warmup, cpus, kernel > json
+        for (i = 1; i <= keys; i++) {
+            key = order[i]; split(key, f, ",")
+            printf "%s{\"variant\":\"%s\",\"server\":\"%s\",\"client\":\"%s\",\"runs\":%d,\"bytes\":%s,\"records\":%s,\"client_bytes\":%s",
+                   (i > 1 ? "," : ""), f[1], f[2], f[3], n[key], bytes[key], records[key], client_bytes[key] > json
+            for (m = 1; m <= nm; m++) {
+                j = mcol[m]; k = key SUBSEP j
+                if (!cnt[k]) continue
+                mean = sum[k] / cnt[k]
+                var = cnt[k] > 1 ? (sq[k] - cnt[k] * mean * mean) / (cnt[k] - 1) : 0
+                sd = var > 0 ? sqrt(var) : 0
+                printf "%s,%d,%s,%s,%s,%.6f,%.6f,%s,%s\n", key, n[key], bytes[key],
+                       (records[key] == "null" ? "" : records[key]), metric[j],
+                       mean, sd, min[k], max[k] > csv
+                printf ",\"%s\":{\"mean\":%.6f,\"stddev\":%.6f,\"min\":%s,\"max\":%s}",
+                       metric[j], mean, sd, min[k], max[k] > json
+            }
+            printf "}" > json
+        }
+        print "]}" > json
+    }' "$RUNS_CSV"
+
+echo ": $SUMMARY_CSV, $SUMMARY_JSON (ȸ $RUNS_CSV,  α $OUT/logs)"
@@ -0,0 +1,19 @@
+#!/bin/sh
+#############################################################################
+# File       : bench_profile.sh
+# Description: Ʃ (default / throughput / latency)   
+#               Ŭ̾Ʈ   
+#              : bench_profile.sh <ڵ > [ݺ Ƚ] [ Ǵ   ...]
+#############################################################################
+
+DATA=${1:?": $0 <ڵ > [ݺ Ƚ] [ Ǵ   ...]"}
+RUNS=${2:-3}
+shift; [ $# -gt 0 ] && shift
+. "$(dirname "$0")/common.sh"
+
+[ $# -eq 0 ] && set -- default throughput latency
+
+for profile in "$@"; do
+    run_mode "$(basename "$profile")" "--profile $profile" "--profile $profile" \
+             client_rawtcp client_tcp2ws client_ws2tcp
+done
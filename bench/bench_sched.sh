@@ -0,0 +1,42 @@
+#!/bin/sh
+#############################################################################
+# File       : bench_sched.sh
+# Description:  ٷ  - select 1ȸ recv 1ȸ(quantum 0) / DRR quantum
+#               Ʈ ó  Ʈ Ϸ ð , ִ ť  
+#              : bench_sched.sh <ڵ > [  ] [quantum ...]
+#############################################################################
+
+DATA=${1:?": $0 <ڵ > [  ] [quantum ...]"}
+STREAMS=${2:-4}
+shift; [ $# -gt 0 ] && shift
+. "$(dirname "$0")/common.sh"
+
+[ $# -eq 0 ] && set -- 0 16384 65536 262144
+
+for quantum in "$@"; do
+    log="$WORK/q$quantum.log"
+    stdbuf -oL "$BIN_DIR/server_tcpws" --profile throughput --quantum "$quantum" > "$log" 2>&1 &
+    SERVER_PID=$!
+    sleep 0.3
+
+    "$BIN_DIR/client_rawtcp" --profile throughput "$DATA" > /dev/null || exit 1
+    summary=$(wait_summary "$log" 1) || exit 1
+    printf "quantum=%-7s single      %s\n" "$quantum" "$summary"
+
+    i=0
+    while [ $i -lt "$STREAMS" ]; do
+        "$BIN_DIR/client_rawtcp" --profile throughput "$DATA" > /dev/null &
+        i=$((i + 1))
+    done
+    wait_summary "$log" $((STREAMS + 1)) > /dev/null || exit 1
+
+    #  Ʈ: Ϸ ð ּ/ִ, ִ ť  (ٸ )
+    grep "$SUMMARY" "$log" | tail -n "$STREAMS" | sed 's/.*: \([0-9.]*\) [^ ]*$/\1/' | sort -n | \
+        awk -v q="$quantum" -v n="$STREAMS" 'NR == 1 { min = $1 } { max = $1 }
+            END { printf "quantum=%-7s %d streams  min %s  max %s", q, n, min, max }'
+    grep '^\[SCHED\]' "$log" | tail -n "$STREAMS" | sed 's/.*: \([0-9]*\) us$/\1/' | sort -n | tail -n 1 | \
+        awk '{ printf "  ִ ť  %s us", $1 } END { printf "\n" }'
+
+    kill $SERVER_PID 2>/dev/null; wait $SERVER_PID 2>/dev/null || :
+    SERVER_PID=
+done
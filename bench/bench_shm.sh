@@ -0,0 +1,16 @@
+#!/bin/sh
+#############################################################################
+# File       : bench_shm.sh
+# Description:  ޸  / Unix  / TCP / WS  ڵ ó 
+#              : bench_shm.sh <ڵ > [ݺ Ƚ]
+#############################################################################
+
+DATA=${1:?": $0 <ڵ > [ݺ Ƚ]"}
+RUNS=${2:-3}
+. "$(dirname "$0")/common.sh"
+
+SERVER_OPT="--unix $WORK/stream.sock --shm $WORK/shm.sock"
+run_mode tcp  "$SERVER_OPT" ""                          client_rawtcp
+run_mode ws   "$SERVER_OPT" ""                          client_tcp2ws
+run_mode unix "$SERVER_OPT" "--unix $WORK/stream.sock"  client_rawtcp
+run_mode shm  "$SERVER_OPT" "--shm $WORK/shm.sock"      client_rawtcp
@@ -0,0 +1,59 @@
+#!/bin/sh
+#############################################################################
+# File       : bench_swarm.sh
+# Description:    Ȯ强 - client_swarm  μ   ÷  server_tcpws 
+#                   Ϸ/503 / , հ ó, TCP /WS ׷̵
+#              , Ằ ó CSV 
+#              : bench_swarm.sh [-r  ڵ] [-w WS ] [-d ڵ ] [-o  ͸]
+#                                     [-s " ɼ"] [   ...]
+#############################################################################
+
+RECORDS=1000
+WS_PERCENT=0
+DATA=
+SERVER_OPTS=
+OUT=$(cd "$(dirname "$0")" && pwd)/results
+
+while getopts "r:w:d:o:s:h" opt; do
+    case $opt in
+        r) RECORDS=$OPTARG ;;
+        w) WS_PERCENT=$OPTARG ;;
+        d) DATA=$OPTARG ;;
+        o) OUT=$OPTARG ;;
+        s) SERVER_OPTS=$OPTARG ;;
+        *) echo ": $0 [-r  ڵ] [-w WS ] [-d ڵ ] [-o  ͸] [-s \" ɼ\"] [   ...]" >&2
+           exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+[ $# -eq 0 ] && set -- 10 100 1000 5000
+
+. "$(dirname "$0")/common.sh"
+[ -x "$BIN_DIR/client_swarm" ] || make -C "$BIN_DIR" client_swarm > /dev/null || exit 1
+
+mkdir -p "$OUT" || exit 1
+CSV="$OUT/swarm.csv"
+KEYS="conns opened done shed refused errors peak mb_per_s records_per_s connect_p50_us connect_p99_us upgrade_p50_us upgrade_p99_us conn_mb_per_s_min conn_mb_per_s_p50 conn_mb_per_s_max"
+echo "$KEYS" | tr ' ' ',' > "$CSV"
+
+for conns in "$@"; do
+    stdbuf -oL "$BIN_DIR/server_tcpws" $SERVER_OPTS > "$WORK/server.log" 2>&1 &
+    SERVER_PID=$!
+    sleep 0.3
+
+    out=$("$BIN_DIR/client_swarm" --conns "$conns" --records "$RECORDS" --ws-percent "$WS_PERCENT" \
+          ${DATA:+--data "$DATA"} --json)
+    line=
+    for key in $KEYS; do
+        line="$line${line:+,}$(echo "$out" | sed -n "s/.*\"$key\":\([^,}]*\).*/\1/p")"
+    done
+    echo "$line" >> "$CSV"
+    echo "$line" | awk -F, '{ printf " %6s  Ϸ %6s  503 %6s   %6s   %6s  %9s MB/s  connect p99 %10s us\n",
+                                    $1, $3, $4, $5, $6, $8, $11 }'
+
+    kill $SERVER_PID 2>/dev/null; wait $SERVER_PID 2>/dev/null
+    SERVER_PID=
+    sleep 0.2
+done
+
+echo ": $CSV"
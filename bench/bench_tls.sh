@@ -0,0 +1,18 @@
+#!/bin/sh
+#############################################################################
+# File       : bench_tls.sh
+# Description: 鿡  /   TLS / kTLS   
+#              : bench_tls.sh <ڵ > [ݺ Ƚ]
+#############################################################################
+
+DATA=${1:?": $0 <ڵ > [ݺ Ƚ]"}
+RUNS=${2:-3}
+. "$(dirname "$0")/common.sh"
+
+openssl req -x509 -newkey rsa:2048 -nodes -days 1 -subj /CN=localhost \
+    -keyout "$WORK/key.pem" -out "$WORK/cert.pem" 2>/dev/null || exit 1
+
+TLS_OPT="--cert $WORK/cert.pem --key $WORK/key.pem"
+run_mode plain    ""                   ""                client_rawtcp client_tcp2ws
+run_mode tls-user "$TLS_OPT --no-ktls" "--tls --no-ktls" client_rawtcp client_tcp2ws
+run_mode ktls     "$TLS_OPT"           "--tls"           client_rawtcp client_tcp2ws
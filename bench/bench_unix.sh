@@ -0,0 +1,15 @@
+#!/bin/sh
+#############################################################################
+# File       : bench_unix.sh
+# Description: 127.0.0.1 TCP / Unix SOCK_STREAM / Unix SOCK_SEQPACKET   
+#              : bench_unix.sh <ڵ > [ݺ Ƚ]
+#############################################################################
+
+DATA=${1:?": $0 <ڵ > [ݺ Ƚ]"}
+RUNS=${2:-3}
+. "$(dirname "$0")/common.sh"
+
+UNIX_OPT="--unix $WORK/stream.sock --seqpacket $WORK/seq.sock"
+run_mode tcp       "$UNIX_OPT" ""                            client_rawtcp client_tcp2ws client_ws2tcp
+run_mode unix      "$UNIX_OPT" "--unix $WORK/stream.sock"    client_rawtcp client_tcp2ws client_ws2tcp
+run_mode seqpacket "$UNIX_OPT" "--seqpacket $WORK/seq.sock"  client_rawtcp
@@ -0,0 +1,101 @@
+#!/bin/sh
+#############################################################################
+# File       : bench_wan.sh
+# Description: WAN (RTT) Ŭ̾Ʈ/Ʃ   - wanproxy ߰ root   ߰
+#              RTT wanproxy   (ܹ  = RTT / 2) Ŭ̾Ʈ --unix ߰⿡
+#              , ¸ --ack  Ϸ   ð ۽ ȣ  CSV 
+#              (鿡  ̴ ڵ帶 send /    RTT Բ 巯)
+#              : bench_wan.sh [-r "RTT ms ..."] [-p " ..."] [-x "wanproxy ɼ"]
+#                                   [-d  | -g "gen_records ɼ"] [-o  ͸] [Ŭ̾Ʈ ...]
+#              Ŭ̾Ʈ: client_rawtcp client_tcp2ws client_ws2tcp (⺻ ü, --ack  Ŭ̾Ʈ)
+#############################################################################
+
+RTTS="0 20 50 100"
+PROFILES="default throughput latency"
+PROXY_OPTS=
+DATA=
+GEN_OPTS="--size 8m --seed 42"
+OUT=$(cd "$(dirname "$0")" && pwd)/results
+CLIENT_TIMEOUT=300
+
+usage()
+{
+    echo ": $0 [-r \"RTT ms ...\"] [-p \" ...\"] [-x \"wanproxy ɼ\"] [-d  | -g \"gen_records ɼ\"] [-o  ͸] [Ŭ̾Ʈ ...]" >&2
+    exit 1
+}
+
+while getopts "r:p:x:d:g:o:h" opt; do
+    case $opt in
+        r) RTTS=$OPTARG ;;
+        p) PROFILES=$OPTARG ;;
+        x) PROXY_OPTS=$OPTARG ;;
+        d) DATA=$OPTARG ;;
+        g) GEN_OPTS=$OPTARG ;;
+        o) OUT=$OPTARG ;;
+        *) usage ;;
+    esac
+done
+shift $((OPTIND - 1))
+[ $# -eq 0 ] && set -- client_rawtcp client_tcp2ws client_ws2tcp
+
+. "$(dirname "$0")/common.sh"
+PROXY_PID=
+PROXY_SOCK="$WORK/wan.sock"
+export LC_ALL=C     # /߰ (EUC-KR) Ʈ  
+trap '[ -n "$PROXY_PID" ] && kill $PROXY_PID 2>/dev/null; [ -n "$SERVER_PID" ] && kill $SERVER_PID 2>/dev/null; rm -rf "$WORK"' EXIT
+
+for bin in server_tcpws wanproxy "$@"; do
+    [ -x "$BIN_DIR/$bin" ] || { echo " : $BIN_DIR/$bin" >&2; exit 1; }
+done
+
+# Է :   gen_records  ( ɼ̸ ׻  )
+if [ -z "$DATA" ]; then
+    [ -x "$BIN_DIR/gen_records" ] || make -C "$BIN_DIR" gen_records > /dev/null || exit 1
+    DATA="$WORK/data.txt"
+    "$BIN_DIR/gen_records" $GEN_OPTS --output "$DATA" 2> /dev/null || exit 1
+fi
+[ -r "$DATA" ] || { echo "Է    ϴ: $DATA" >&2; exit 1; }
+
+mkdir -p "$OUT/logs" || exit 1
+WAN_CSV="$OUT/wan.csv"
+echo "rtt_ms,client,profile,e2e_s,mb_per_s,send_calls,bytes_per_call,ack_match" > "$WAN_CSV"
+
+# $1: JSON  , $2: Ű  
+json_value()
+{
+    echo "$1" | sed -n "s/.*\"$2\":\([^,}]*\).*/\1/p"
+}
+
+stdbuf -oL "$BIN_DIR/server_tcpws" > "$OUT/logs/wan-server.log" 2>&1 &
+SERVER_PID=$!
+sleep 0.3
+
+echo "Է: $DATA ($(wc -c < "$DATA") Ʈ), RTT $RTTS ms,  $PROFILES, ߰ ɼ ${PROXY_OPTS:-}"
+
+for rtt in $RTTS; do
+    delay=$(awk -v r="$rtt" 'BEGIN { print r / 2 }')
+    stdbuf -oL "$BIN_DIR/wanproxy" --listen "$PROXY_SOCK" --delay "$delay" $PROXY_OPTS \
+        > "$OUT/logs/wan-proxy-$rtt.log" 2>&1 &
+    PROXY_PID=$!
+    sleep 0.3
+
+    for client in "$@"; do
+        for profile in $PROFILES; do
+            out=$(timeout $CLIENT_TIMEOUT "$BIN_DIR/$client" --unix "$PROXY_SOCK" --ack --json \
+                  --profile "$profile" "$DATA" 2> /dev/null | tail -n 1)
+            if [ -z "$(json_value "$out" e2e_s)" ]; then
+                printf "RTT %4s ms %-14s %-10s \n" "$rtt" "$client" "$profile"
+                continue
+            fi
+            echo "$rtt,$client,$profile,$(json_value "$out" e2e_s),$(json_value "$out" mb_per_s),$(json_value "$out" send_calls),$(json_value "$out" bytes_per_call),$(json_value "$out" ack_match)" >> "$WAN_CSV"
+            printf "RTT %4s ms %-14s %-10s   %10s  %9s MB/s  send %8sȸ (ȣ %s Ʈ)\n" \
+                   "$rtt" "$client" "$profile" "$(json_value "$out" e2e_s)" "$(json_value "$out" mb_per_s)" \
+                   "$(json_value "$out" send_calls)" "$(json_value "$out" bytes_per_call)"
+        done
+    done
+
+    kill $PROXY_PID 2>/dev/null; wait $PROXY_PID 2>/dev/null
+    PROXY_PID=
+done
+
+echo ": $WAN_CSV (/߰ α $OUT/logs)"
@@ -0,0 +1,54 @@
+#############################################################################
+# File       : common.sh
+# Description: ġũ ũƮ  Լ ( ,    )
+#############################################################################
+
+BIN_DIR=$(cd "$(dirname "$0")/../src(record)" && pwd)
+SUMMARY='^\[\(TCP\|WS\|SEQ\|SHM\)\].*[0-9]\.[0-9]\{6\}'
+WORK=$(mktemp -d)
+SUMMARY_TIMEOUT=300     #    ִ  (, bench_matrix.sh CLIENT_TIMEOUT  )
+SERVER_PID=             #  ũƮ    ( ͸ ٸ  ǵ帮 )
+trap '[ -n "$SERVER_PID" ] && kill $SERVER_PID 2>/dev/null; rm -rf "$WORK"' EXIT
+
+#  α    $2      "ҿ ð ڵ/" 
+#   ù °  Ʈ,  °  ڵ 
+# SUMMARY_TIMEOUT ȿ   ( , Ŭ̾Ʈ ߴ ) 
+wait_summary()
+{
+    waited=0
+    while [ "$(grep -c "$SUMMARY" "$1")" -lt "$2" ]; do
+        sleep 0.1
+        waited=$((waited + 1))
+        if [ $waited -ge $((SUMMARY_TIMEOUT * 10)) ]; then
+            echo "    (${SUMMARY_TIMEOUT} ʰ): $1" >&2
+            return 1
+        fi
+    done
+    grep "$SUMMARY" "$1" | tail -n 1 | \
+        sed 's/^[^0-9]*[0-9]*[^0-9]*\([0-9]*\).*: \([0-9.]*\) [^ ]*$/\2 \1/' | \
+        awk '{ printf "%s %12.0f rec/s", $1, ($1 > 0 ? $2 / $1 : 0) }'
+}
+
+# $1:  ̸, $2:  ɼ, $3: Ŭ̾Ʈ ɼ, : Ŭ̾Ʈ 
+# Ŭ̾Ʈ    RUNS Ͽ   ҿ ð 
+run_mode()
+{
+    mode=$1; server_opt=$2; client_opt=$3
+    shift 3
+    for client in "$@"; do
+        log="$WORK/$mode-$client.log"
+        stdbuf -oL "$BIN_DIR/server_tcpws" $server_opt > "$log" 2>&1 &
+        SERVER_PID=$!
+        sleep 0.3
+        i=1
+        while [ $i -le "$RUNS" ]; do
+            "$BIN_DIR/$client" $client_opt "$DATA" > /dev/null || exit 1
+            summary=$(wait_summary "$log" $i) || exit 1
+            printf "%-10s %-14s run%-2d %s\n" "$mode" "$client" $i "$summary"
+            i=$((i + 1))
+        done
+        kill $SERVER_PID 2>/dev/null; wait $SERVER_PID 2>/dev/null
+        SERVER_PID=
+        grep -m1 '^\[TLS\]' "$log" | sed 's/^/    /'
+    done
+}
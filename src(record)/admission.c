@@ -0,0 +1,126 @@
+/*****************************************************************************
+* File       : admission.c
+* Description:   
+*              - ޸: Ằ  (all_data) Ҵ緮 հ +   ġ <= 
+*              -  :     < ѵ
+*              - CPU: ̺Ʈ   1̹Ƿ ھ 1  (EWMA)
+*                      1    ġ <= ѵ
+*****************************************************************************/
+
+#include <stdio.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include "admission.h"
+
+#define CPU_EWMA_WEIGHT  0.5
+
+/*****************************************************************************
+* Function   : admission_init
+* Description: ⺻ ѵ  (1 GiB,   16, ⿭ 32, CPU 90%, Retry-After 1)
+*****************************************************************************/
+void admission_init(struct admission *a)
+{
+    a->mem_budget = (size_t)1 << 30;
+    a->max_active = 16;
+    a->pending_max = 32;
+    a->cpu_limit = 0.9;
+    a->retry_after = 1;
+
+    a->mem_used = 0;
+    a->active = 0;
+    a->pending = 0;
+    a->cpu_util = 0.0;
+    a->cpu_last_us = 0;
+    a->wall_last_ms = 0;
+
+    a->admitted = 0;
+    a->queued = 0;
+    a->shed = 0;
+    a->reported_shed = 0;
+    a->reported_queued = 0;
+}
+
+/*****************************************************************************
+* Function   : admission_decide
+* Description:  (Ǵ ⿭   )   Ǵ
+* Parameters : - int slot_free     :     
+*              - size_t mem_need   :   ʱ  ũ
+* Returns    : ADMIT_ACCEPT / ADMIT_QUEUE / ADMIT_SHED
+*****************************************************************************/
+int admission_decide(struct admission *a, int slot_free, size_t mem_need)
+{
+    size_t mem_est = mem_need;
+    double cpu_est = a->cpu_util;
+
+    //      ũ⸸ŭ ڶ  
+    if (a->active > 0 && a->mem_used / a->active > mem_est)
+        mem_est = a->mem_used / a->active;
+
+    if (a->active > 0)
+        cpu_est += a->cpu_util / a->active;
+
+    if (slot_free && a->active < a->max_active &&
+        a->mem_used + mem_est <= a->mem_budget && cpu_est <= a->cpu_limit)
+        return ADMIT_ACCEPT;
+
+    if (a->pending < a->pending_max)
+        return ADMIT_QUEUE;
+
+    return ADMIT_SHED;
+}
+
+/*****************************************************************************
+* Function   : admission_sample_cpu
+* Description: μ CPU ð  /  ð ھ   (ֱ Ÿ̸ӿ ȣ)
+*****************************************************************************/
+void admission_sample_cpu(struct admission *a, uint64_t now_ms)
+{
+    struct rusage ru;
+    uint64_t cpu_us = 0;
+    double util = 0.0;
+
+    getrusage(RUSAGE_SELF, &ru);
+    cpu_us = (uint64_t)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000 +
+             ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+
+    if (a->wall_last_ms != 0 && now_ms > a->wall_last_ms)
+    {
+        util = (double)(cpu_us - a->cpu_last_us) / ((now_ms - a->wall_last_ms) * 1000.0);
+        a->cpu_util = CPU_EWMA_WEIGHT * util + (1.0 - CPU_EWMA_WEIGHT) * a->cpu_util;
+    }
+
+    a->cpu_last_us = cpu_us;
+    a->wall_last_ms = now_ms;
+}
+
+/*****************************************************************************
+* Function   : admission_format_503
+* Description:    (WS ׷̵ û  ,  TCP Ŭ̾Ʈ   Ȯ)
+* Returns    :  
+*****************************************************************************/
+int admission_format_503(const struct admission *a, char *buf, size_t len)
+{
+    return snprintf(buf, len,
+                    "HTTP/1.1 503 Service Unavailable\r\n"
+                    "Retry-After: %d\r\n"
+                    "Content-Length: 0\r\n"
+                    "Connection: close\r\n\r\n", a->retry_after);
+}
+
+/*****************************************************************************
+* Function   : admission_report
+* Description: /  ٲ     
+*****************************************************************************/
+void admission_report(struct admission *a)
+{
+    if (a->shed == a->reported_shed && a->queued == a->reported_queued)
+        return;
+
+    printf("[ADMISSION]  %zu, ⿭  %zu, (503) %zu |   %d,  %d, "
+           " %zu MB, CPU %.0f%%\n",
+           a->admitted, a->queued, a->shed, a->active, a->pending,
+           a->mem_used >> 20, a->cpu_util * 100.0);
+
+    a->reported_shed = a->shed;
+    a->reported_queued = a->queued;
+}
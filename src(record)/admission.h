@@ -0,0 +1,52 @@
+/*****************************************************************************
+* File       : admission.h
+* Description:    (޸ ,   , ̺Ʈ  ھ CPU )
+*              ѵ  ⿭ ְ, ⿭  503 + Retry-After 
+*****************************************************************************/
+
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ADMIT_ACCEPT  0     // ٷ 
+#define ADMIT_QUEUE   1     // ⿭  (  )
+#define ADMIT_SHED    2     //  (503 + Retry-After)
+
+/*****************************************************************************
+* Structure  : admission
+* Description:   ѵ  뷮, 
+*****************************************************************************/
+struct admission
+{
+    // ѵ
+    size_t mem_budget;          //    ѷ ѵ (Ʈ)
+    int max_active;             //   ѵ
+    int pending_max;            //  ⿭ 
+    double cpu_limit;           // ̺Ʈ  ھ  ѵ (0.0 ~ 1.0)
+    int retry_after;            //   Retry-After ()
+
+    //  뷮
+    size_t mem_used;            // Ằ   Ҵ緮 հ
+    int active;                 //    
+    int pending;                // ⿭  
+    double cpu_util;            // ̺Ʈ  ھ  (EWMA)
+    uint64_t cpu_last_us;       //    CPU ð (user + sys)
+    uint64_t wall_last_ms;      //   ð
+
+    // 
+    size_t admitted;            // ٷ 
+    size_t queued;              // ⿭  
+    size_t shed;                // 503 
+    size_t reported_shed;       //    
+    size_t reported_queued;     //    
+};
+
+void admission_init(struct admission *a);
+int admission_decide(struct admission *a, int slot_free, size_t mem_need);
+void admission_sample_cpu(struct admission *a, uint64_t now_ms);
+int admission_format_503(const struct admission *a, char *buf, size_t len);
+void admission_report(struct admission *a);
+
+#endif
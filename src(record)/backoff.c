@@ -0,0 +1,107 @@
+/*****************************************************************************
+* File       : backoff.c
+* Description:    
+*               ð = max(Retry-After, /2 + [0, /2] ),  = base * 2^õ
+*              ( Ŭ̾Ʈ ÿ ص   ٽ  ʵ л)
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "backoff.h"
+#include "probes.h"
+
+/*****************************************************************************
+* Function   : backoff_init
+* Description: õ  ʱȭ ( õ μ ٸ)
+*****************************************************************************/
+void backoff_init(struct backoff *b, long base_ms, long max_ms, int max_attempts)
+{
+    b->base_ms = base_ms;
+    b->max_ms = max_ms;
+    b->attempt = 0;
+    b->max_attempts = max_attempts;
+
+    srand((unsigned)time(NULL) ^ ((unsigned)getpid() << 16));
+}
+
+/*****************************************************************************
+* Function   : backoff_wait
+* Description:  õ 
+* Parameters : - long retry_after_ms :  ˷  ּ  ð ( 0)
+* Returns    : 0 (õ), -1 (ִ õ Ƚ ʰ)
+*****************************************************************************/
+int backoff_wait(struct backoff *b, long retry_after_ms)
+{
+    long cap = b->base_ms;
+    long delay = 0;
+    struct timespec ts;
+
+    if (b->attempt >= b->max_attempts)
+        return -1;
+
+    if (b->attempt < 20)
+        cap = b->base_ms << b->attempt;
+    if (cap > b->max_ms || cap <= 0)
+        cap = b->max_ms;
+
+    delay = cap / 2 + rand() % (cap / 2 + 1);
+    if (delay < retry_after_ms)
+        delay = retry_after_ms + rand() % (cap / 2 + 1);
+
+    b->attempt++;
+    PROBE3(backpressure, -1, PROBE_BP_BACKOFF, delay);
+    printf(" (503), %ld ms   (%d/%d)\n", delay, b->attempt, b->max_attempts);
+
+    ts.tv_sec = delay / 1000;
+    ts.tv_nsec = (delay % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : backoff_parse_503
+* Description: HTTP  503 Ȯϰ Retry-After() 
+* Returns    : 1 (503), 0 ( )
+*****************************************************************************/
+int backoff_parse_503(const char *response, long *retry_after_ms)
+{
+    const char *p = NULL;
+
+    if (strncmp(response, "HTTP/1.1 503", 12) != 0)
+        return 0;
+
+    *retry_after_ms = 0;
+    for (p = response; (p = strchr(p, '\n')) != NULL; )
+    {
+        p++;
+        if (strncasecmp(p, "Retry-After:", 12) == 0)
+        {
+            *retry_after_ms = atol(p + 12) * 1000;
+            break;
+        }
+    }
+
+    return 1;
+}
+
+/*****************************************************************************
+* Function   : backoff_peek_503
+* Description:   ʴ  Ʈ Ŭ̾Ʈ -  ť 503   ִ Ȯ
+* Returns    : 1 (503 ), 0 ()
+*****************************************************************************/
+int backoff_peek_503(int fd, long *retry_after_ms)
+{
+    char buf[256];
+    ssize_t n = recv(fd, buf, sizeof(buf) - 1, MSG_PEEK | MSG_DONTWAIT);
+
+    if (n <= 0)
+        return 0;
+
+    buf[n] = '\0';
+    return backoff_parse_503(buf, retry_after_ms);
+}
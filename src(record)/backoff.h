@@ -0,0 +1,30 @@
+/*****************************************************************************
+* File       : backoff.h
+* Description:  503 + Retry-After     (   )
+*****************************************************************************/
+
+#ifndef BACKOFF_H
+#define BACKOFF_H
+
+#define BACKOFF_BASE_MS      200
+#define BACKOFF_MAX_MS       30000
+#define BACKOFF_MAX_ATTEMPTS 8
+
+/*****************************************************************************
+* Structure  : backoff
+* Description: õ 
+*****************************************************************************/
+struct backoff
+{
+    long base_ms;               // ù õ  
+    long max_ms;                //  
+    int attempt;                // ݱ õ Ƚ
+    int max_attempts;           // ִ õ Ƚ
+};
+
+void backoff_init(struct backoff *b, long base_ms, long max_ms, int max_attempts);
+int backoff_wait(struct backoff *b, long retry_after_ms);
+int backoff_parse_503(const char *response, long *retry_after_ms);
+int backoff_peek_503(int fd, long *retry_after_ms);
+
+#endif
@@ -10,9 +10,150 @@
 #include <unistd.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
+#include <getopt.h>
+#include <signal.h>
+#include "tls_offload.h"
+#include "transport.h"
+#include "shm_ring.h"
+#include "tune.h"
+#include "backoff.h"
+#include "latency.h"
+#include "probes.h"
+#include "tcpinfo.h"
+#include "client_report.h"
+#include "completion.h"
 
 #define BUF_SIZE 1024
 #define PORT 8331
+#define SHED_CHECK_INTERVAL 1024    //  (503) Ȯ ֱ (ڵ )
+
+static int g_timestamp = 0;         // --timestamp: ڵ տ ۽ ð ǥ ( --latency)
+
+/*****************************************************************************
+* Function   : wait_completion
+* Description: (--ack)  ڵ ڿ  ǥø     ٷ 
+*               ޸𸮴  ǥø  ϰ    
+* Parameters : - const struct completion *sent : ̹ ῡ  Ʈ/ڵ
+*              - uint64_t conn_ns              :  ð (  ð )
+* Returns    : 0 (ġ), -1 (  Ǵ ġ)
+*****************************************************************************/
+static int wait_completion(SSL *ssl, int sock, struct shm_ring *ring, const struct completion *sent,
+                           uint64_t conn_ns, struct client_report *report)
+{
+    char marker[COMPLETION_MAX + 2];
+    size_t len = 0;
+    struct completion reply;
+    int r = 0;
+
+    if (ring != NULL)
+    {
+        len = completion_marker(marker, sizeof(marker), sent);
+        r = shm_ring_write(ring, marker, len, sock);
+    }
+    else
+    {
+        r = completion_send(ssl, sock, COMPLETION_RAW, sent);
+    }
+
+    if (r < 0 || completion_wait(ssl, sock, COMPLETION_RAW, &reply) < 0)
+    {
+        fprintf(stderr, "[ACK]  Ϸ  \n");
+        return -1;
+    }
+
+    report->acked = 1;
+    report->e2e_s = (latency_now_ns() - conn_ns) / 1e9;
+    report->server_s = reply.elapsed_us / 1e6;
+    report->ack_match = completion_report(sent, &reply, report->e2e_s, stdout) == 0;
+    return report->ack_match ? 0 : -1;
+}
+
+/*****************************************************************************
+* Function   : peek_503
+* Description:  ť(TLS ȣȭ )   (503)   ִ Ȯ
+* Returns    : 1 (503 , Retry-After ȯ), 0 ()
+*****************************************************************************/
+static int peek_503(SSL *ssl, int sock, long *retry_after_ms)
+{
+    char buf[256];
+    ssize_t n = 0;
+
+    if (ssl == NULL)
+        return backoff_peek_503(sock, retry_after_ms);
+
+    n = tls_peek(ssl, sock, buf, sizeof(buf) - 1);
+    if (n <= 0)
+        return 0;
+
+    buf[n] = '\0';
+    return backoff_parse_503(buf, retry_after_ms);
+}
+
+/*****************************************************************************
+* Function   : send_records
+* Description:  \n  ڵ  
+*               Ʈ    Ƿ SHED_CHECK_INTERVAL ڵ帶, ׸
+*                  ť   (503)  Ȯ
+*              ( ù ͸   503 , TLS ڵũ  TLS)
+* Parameters : - struct shm_ring *ring :  ޸  ( ̸ NULL)
+*              - long *retry_after_ms  :    ˷  Retry-After
+* Returns    : 0 ( Ϸ Ǵ ), 1 ( 503   õ)
+*****************************************************************************/
+static int send_records(FILE *fp, SSL *ssl, int sock, struct shm_ring *ring,
+                        struct send_batch *batch, long *retry_after_ms)
+{
+    char line_buffer[BUF_SIZE];
+    char stamped[LATENCY_STAMP_LEN + BUF_SIZE];
+    const char *rec = line_buffer;
+    size_t len = 0;
+    size_t records = 0;
+
+    if (g_timestamp)
+        rec = stamped;
+
+    while (fgets(line_buffer, sizeof(line_buffer), fp) != NULL)
+    {
+        len = strlen(line_buffer);
+        if (g_timestamp)
+            len = latency_stamp(stamped, sizeof(stamped), line_buffer, len);
+
+        if (++records % SHED_CHECK_INTERVAL == 0 && peek_503(ssl, sock, retry_after_ms))
+            return 1;
+
+        if (ring != NULL)
+        {
+            if (shm_ring_write(ring, rec, len, sock) < 0)
+            {
+                if (peek_503(NULL, sock, retry_after_ms))
+                    return 1;
+                fprintf(stderr, " ޸    ( )\n");
+                return 0;
+            }
+            //  ۵    īͿ 
+            batch->sent_bytes += len;
+            batch->sent_records++;
+            continue;
+        }
+
+        if (send_batch_put(batch, ssl, sock, rec, len) < 0)
+        {
+            if (peek_503(ssl, sock, retry_after_ms))
+                return 1;
+            perror("  ");
+            return 0;
+        }
+    }
+
+    if (ring == NULL && send_batch_flush(batch, ssl, sock) < 0)
+    {
+        if (peek_503(ssl, sock, retry_after_ms))
+            return 1;
+        perror("  ");
+    }
+
+    // ڵ   ֱ Ȯ   
+    return peek_503(ssl, sock, retry_after_ms);
+}
 
 /*****************************************************************************
 * Function   : main
@@ -23,72 +164,210 @@
 *****************************************************************************/
 int main(int argc, char *argv[])
 {
+    // ɼ
+    int use_tls = 0;
+    int use_ktls = 1;
+    int c;
+    static struct option long_options[] = {
+        { "tls",     no_argument, NULL, 't' },
+        { "no-ktls", no_argument, NULL, 'n' },
+        { "unix",    required_argument, NULL, 'u' },
+        { "seqpacket", required_argument, NULL, 's' },
+        { "shm",     required_argument, NULL, 'm' },
+        { "timestamp", no_argument,     NULL, 'T' },
+        { "json",    no_argument,       NULL, 'j' },
+        { "ack",     no_argument,       NULL, 'a' },
+        TUNE_LONG_OPTIONS,
+        { NULL, 0, NULL, 0 }
+    };
+
+    // TLS
+    SSL_CTX *tls_ctx = NULL;
+    SSL *ssl = NULL;
+
+    //  ޸ 
+    int use_shm = 0;
+    struct shm_ring ring;
+
     //  
     const char *file_path = NULL;
     FILE *fp = NULL;
 
     // Ʈũ 
     int sock = 0;
-    struct sockaddr_in server_addr;
+    const char *unix_path = NULL;
+    int sock_type = SOCK_STREAM;
 
-    //   ó
-    char line_buffer[BUF_SIZE];
-    size_t len = 0;
-    ssize_t sent_len = 0;
+    //   õ
+    struct send_batch batch;
+    struct backoff retry;
+    long retry_after_ms = 0;
+    int shed = 0;
+    struct tcpinfo_stats tcpi;
+
+    //  
+    struct client_report report;
+    int json = 0;
+
+    //  Ϸ Ȯ (--ack)
+    int use_ack = 0;
+    int ack_failed = 0;
+    struct completion sent;
+    uint64_t conn_ns = 0;
+
+    while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1)
+    {
+        int r = tune_option(c, optarg);
+        if (r < 0)
+            return -1;
+        if (r > 0)
+            continue;
+
+        switch (c)
+        {
+            case 't': use_tls = 1; break;
+            case 'n': use_ktls = 0; break;
+            case 'u': unix_path = optarg; break;
+            case 's': unix_path = optarg; sock_type = SOCK_SEQPACKET; break;
+            case 'm': unix_path = optarg; use_shm = 1; break;
+            case 'T': g_timestamp = 1; break;
+            case 'j': json = 1; break;
+            case 'a': use_ack = 1; break;
+            default: break;
+        }
+    }
 
     //  ó
-    if (argc != 2)
+    if (optind != argc - 1)
     {
-        fprintf(stderr, ": %s <  >\n", argv[0]);
+        fprintf(stderr, ": %s [--unix  | --seqpacket  | --shm ] [--tls [--no-ktls]] [--timestamp] [--json] [--ack]\n"
+                        "       %s <  >\n", argv[0], TUNE_USAGE);
         return -1;
     }
 
-    file_path = argv[1];
-    fp = fopen(file_path, "r");
-    if (!fp)
+    if (use_tls && (sock_type == SOCK_SEQPACKET || use_shm))
     {
-        perror("  ");
+        fprintf(stderr, "--seqpacket / --shm 忡 TLS   ϴ\n");
         return -1;
     }
 
-    sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock < 0)
+    // SOCK_SEQPACKET ޽ 1 ڵ 1̹Ƿ   
+    if (send_batch_init(&batch, sock_type == SOCK_SEQPACKET ? 0 : g_tune.write_chunk) < 0)
     {
-        perror("  ");
-        fclose(fp);
+        perror("޸ Ҵ ");
         return -1;
     }
 
-    memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(PORT);
-    inet_pton(AF_INET, "127.0.0.1", &server_addr.sin_addr);
-
-    if (connect(sock, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0)
+    file_path = argv[optind];
+    fp = fopen(file_path, "r");
+    if (!fp)
     {
-        perror("  ");
-        close(sock);
-        fclose(fp);
+        perror("  ");
         return -1;
     }
 
-    printf(" . ڵ   ...\n");
+    backoff_init(&retry, BACKOFF_BASE_MS, BACKOFF_MAX_MS, BACKOFF_MAX_ATTEMPTS);
+    signal(SIGPIPE, SIG_IGN);   //  ῡ  SIGPIPE  EPIPE 
+    client_report_start(&report, "client_rawtcp",
+                        use_shm ? "shm" : sock_type == SOCK_SEQPACKET ? "seqpacket" : unix_path ? "unix" : "tcp",
+                        use_tls);
 
-    while (fgets(line_buffer, sizeof(line_buffer), fp) != NULL)
+    while (1)
     {
-        len = strlen(line_buffer);
-        sent_len = send(sock, line_buffer, len, 0);
-        if (sent_len < 0)
+        if (unix_path != NULL)
+            sock = transport_connect_unix(unix_path, sock_type);
+        else
+            sock = transport_connect_tcp("127.0.0.1", PORT);
+
+        if (sock < 0)
         {
-            perror("  ");
-            break;
+            fclose(fp);
+            return -1;
+        }
+        conn_ns = latency_now_ns();
+
+        if (use_tls)
+        {
+            tls_ctx = tls_ctx ? tls_ctx : tls_client_ctx(use_ktls);
+            ssl = tls_ctx ? tls_connect(tls_ctx, sock) : NULL;
+            if (ssl == NULL)
+            {
+                //  Ͽ ڵũ ģ  TLS 503 Ƿ ⼭ õ 
+                fprintf(stderr, "TLS ڵũ \n");
+                close(sock);
+                SSL_CTX_free(tls_ctx);
+                fclose(fp);
+                return -1;
+            }
+            printf("TLS  (%s, kTLS TX: %s)\n", SSL_get_cipher(ssl), tls_ktls_tx(ssl) ? "on" : "off");
+        }
+
+        //   (memfd + eventfd) ѱ  ڵ   
+        if (use_shm)
+        {
+            if (shm_ring_create(&ring, SHM_RING_DEFAULT_SIZE) < 0 || shm_ring_send_fds(sock, &ring) < 0)
+            {
+                close(sock);
+                fclose(fp);
+                return -1;
+            }
+            printf(" ޸   Ϸ (%u Ʈ)\n", SHM_RING_DEFAULT_SIZE);
         }
+
+        printf(" . ڵ   ...\n");
+
+        shed = send_records(fp, ssl, sock, use_shm ? &ring : NULL, &batch, &retry_after_ms);
+        sent.bytes = batch.sent_bytes;
+        sent.records = batch.sent_records;
+
+        if (use_ack && !shed)
+            ack_failed = wait_completion(ssl, sock, use_shm ? &ring : NULL, &sent, conn_ns, &report) < 0;
+
+        if (use_shm)
+        {
+            report.send_calls += ring.syscalls;
+            shm_ring_destroy(&ring);
+        }
+
+        PROBE3(conn_close, sock, batch.sent_bytes, batch.sent_records);
+
+        // ۽  TCP_INFO (   ũ  ʰ д )
+        tcpinfo_reset(&tcpi);
+        if (!shed && unix_path == NULL && tcpinfo_sample(sock, &tcpi) == 0)
+            tcpinfo_print(&tcpi, stdout);
+        tls_close(ssl);
+        ssl = NULL;
+        close(sock);
+
+        //   ʹ  Ƿ  ó ٽ 
+        if (shed && backoff_wait(&retry, retry_after_ms) == 0)
+        {
+            rewind(fp);
+            batch.len = 0;
+            //  /Ϸ Ȯ  ῡ  縸 (   )
+            batch.sent_bytes = 0;
+            batch.sent_records = 0;
+            batch.send_calls = 0;
+            batch.partial_writes = 0;
+            report.send_calls = 0;
+            continue;
+        }
+        break;
     }
 
-    printf(" ڵ  Ϸ.\n");
+    if (!shed)
+        printf(" ڵ  Ϸ.\n");
+
+    // ڵ帶 Ҵ  (  1 )
+    report.bytes = batch.sent_bytes;
+    report.records = batch.sent_records;
+    report.send_calls += batch.send_calls;
+    report.partial_writes = batch.partial_writes;
+    client_report_print(&report, json, stdout);
 
-    close(sock);
+    send_batch_free(&batch);
+    SSL_CTX_free(tls_ctx);
     fclose(fp);
 
-    return 0;
+    return shed || ack_failed ? -1 : 0;
 }
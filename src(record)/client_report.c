@@ -0,0 +1,87 @@
+/*****************************************************************************
+* File       : client_report.c
+* Description: Ŭ̾Ʈ     ( / JSON  )
+*****************************************************************************/
+
+#include <string.h>
+#include <time.h>
+#include "client_report.h"
+
+/*****************************************************************************
+* Function   : now_ns
+* Description: CLOCK_MONOTONIC  ð (ns)
+*****************************************************************************/
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*****************************************************************************
+* Function   : tv_sec
+* Description: timeval  ()
+*****************************************************************************/
+static double tv_sec(const struct timeval *end, const struct timeval *start)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_usec - start->tv_usec) / 1000000.0;
+}
+
+/*****************************************************************************
+* Function   : client_report_start
+* Description:  ʱȭ   ð/ڿ 뷮  (  ȣ,  ð )
+*****************************************************************************/
+void client_report_start(struct client_report *r, const char *client, const char *transport, int tls)
+{
+    memset(r, 0, sizeof(*r));
+    r->client = client;
+    r->transport = transport;
+    r->tls = tls;
+    getrusage(RUSAGE_SELF, &r->ru_start);
+    r->start_ns = now_ns();
+}
+
+/*****************************************************************************
+* Function   : client_report_print
+* Description:   
+* Parameters : - int json : 1̸ JSON   (Ű  )
+*****************************************************************************/
+void client_report_print(const struct client_report *r, int json, FILE *out)
+{
+    struct rusage ru;
+    double wall = (now_ns() - r->start_ns) / 1e9;
+    double user = 0.0;
+    double sys = 0.0;
+    double per_call = r->send_calls ? (double)r->bytes / r->send_calls : 0.0;
+    double mbps = wall > 0 ? r->bytes / 1048576.0 / wall : 0.0;
+
+    getrusage(RUSAGE_SELF, &ru);
+    user = tv_sec(&ru.ru_utime, &r->ru_start.ru_utime);
+    sys = tv_sec(&ru.ru_stime, &r->ru_start.ru_stime);
+
+    if (json)
+    {
+        fprintf(out, "{\"client\":\"%s\",\"transport\":\"%s\",\"tls\":%s,\"wall_s\":%.6f,"
+                "\"bytes\":%llu,\"records\":%llu,\"frames\":%llu,\"send_calls\":%llu,"
+                "\"partial_writes\":%llu,\"bytes_per_call\":%.1f,\"allocs\":%llu,"
+                "\"cpu_user_s\":%.6f,\"cpu_sys_s\":%.6f,\"mb_per_s\":%.3f,"
+                "\"acked\":%s,\"ack_match\":%s,\"server_s\":%.6f,\"e2e_s\":%.6f}\n",
+                r->client, r->transport, r->tls ? "true" : "false", wall,
+                (unsigned long long)r->bytes, (unsigned long long)r->records,
+                (unsigned long long)r->frames, (unsigned long long)r->send_calls,
+                (unsigned long long)r->partial_writes, per_call, (unsigned long long)r->allocs,
+                user, sys, mbps, r->acked ? "true" : "false", r->ack_match ? "true" : "false",
+                r->server_s, r->e2e_s);
+        fflush(out);
+        return;
+    }
+
+    fprintf(out, "[REPORT] %s (%s%s) ҿ ð %.6f , ۽ %llu Ʈ, ڵ %llu,  %llu\n",
+            r->client, r->transport, r->tls ? "+tls" : "", wall,
+            (unsigned long long)r->bytes, (unsigned long long)r->records, (unsigned long long)r->frames);
+    fprintf(out, "[REPORT] ۽ ȣ %llu (κ  %llu, ȣ %.1f Ʈ), Ҵ %llu, "
+            "CPU user %.3f / sys %.3f , %.2f MB/s\n",
+            (unsigned long long)r->send_calls, (unsigned long long)r->partial_writes, per_call,
+            (unsigned long long)r->allocs, user, sys, mbps);
+}
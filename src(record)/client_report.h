@@ -0,0 +1,42 @@
+/*****************************************************************************
+* File       : client_report.h
+* Description: Ŭ̾Ʈ   
+*              ð ð, Ʈ, ڵ, , ۽ ȣ/κ , Ҵ Ƚ,
+*              getrusage CPU user/sys, MB/s, --ack  Ȯ 
+*              (--json̸ ġũ ũƮ JSON  )
+*****************************************************************************/
+
+#ifndef CLIENT_REPORT_H
+#define CLIENT_REPORT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/resource.h>
+
+/*****************************************************************************
+* Structure  : client_report
+* Description:  1ȸ  ( ð/ڿ 뷮 client_report_start )
+*****************************************************************************/
+struct client_report
+{
+    const char *client;         // Ŭ̾Ʈ ̸
+    const char *transport;      // tcp / unix / seqpacket / shm
+    int tls;
+    uint64_t start_ns;
+    struct rusage ru_start;
+    uint64_t bytes;             // ۽ Ʈ (WS   )
+    uint64_t records;
+    uint64_t frames;            // WS  (  0)
+    uint64_t send_calls;        // send / SSL_write / lws_write ( ޸  eventfd /)
+    uint64_t partial_writes;    // û   ȣ
+    uint64_t allocs;            //   malloc (ڵ/Ӹ Ҵϸ ڵ ŭ)
+    int acked;                  // --ack:  Ϸ  
+    int ack_match;              //  谡  Ʈ/ڵ ġ
+    double server_s;            //    ð
+    double e2e_s;               // Ӻ   (   ð)
+};
+
+void client_report_start(struct client_report *r, const char *client, const char *transport, int tls);
+void client_report_print(const struct client_report *r, int json, FILE *out);
+
+#endif
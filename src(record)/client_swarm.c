@@ -0,0 +1,700 @@
+/*****************************************************************************
+* File       : client_swarm.c
+* Description:  μ    Ŭ̾Ʈ (epoll, ŷ )
+*              Ŭ̾Ʈ μ    ʰ  μ õ   ÿ 
+*              - Ḷ  TCP Ǵ WebSocket (--ws-percent   )
+*              - Ḷ --records ڵ Ʈ (--data ̸ Ằ ٸ ġ )
+*              - --duration     ,     ü
+*                (--churn: ʴ   , ó   ӵ )
+*                  , TCP /WS ׷̵ , Ằ ó  
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "transport.h"
+#include "tune.h"
+#include "backoff.h"
+#include "latency.h"
+#include "probes.h"
+#include "ws_proto.h"
+
+#define PORT            8331
+#define OUT_BUF_SIZE    8192            // Ằ ۽  (õ   8 KB,   Ḹ Ҵ)
+#define CHUNK_MAX       (OUT_BUF_SIZE - 14)   // ڵ  ִ  (WS   14 Ʈ )
+#define REC_ENDS_MAX    512             // ۽  1 ִ ڵ ִ  ( ġ Ͽ)
+#define IN_BUF_SIZE     512             // ڵũ  / 503 Ȯο
+#define MAX_EVENTS      1024
+#define TICK_MS         10
+
+//  
+#define SWARM_CONNECTING    0           // ŷ connect  
+#define SWARM_HANDSHAKE     1           // WS ׷̵  
+#define SWARM_SENDING       2           // ڵ  
+
+//  
+#define SWARM_DONE          0           // ڵ带   
+#define SWARM_SHED          1           //  503 
+#define SWARM_REFUSED       2           //  
+#define SWARM_ERROR         3           // ڵũ  /   /   
+#define SWARM_ABORTED       4           // --duration    ̴ 
+#define SWARM_OUTCOMES      5
+
+/*****************************************************************************
+* Structure  : swarm_conn
+* Description:  1 
+*****************************************************************************/
+struct swarm_conn
+{
+    int fd;                     // -1̸  ĭ
+    int state;
+    int ws;
+    uint64_t open_ns;           // connect 
+    uint64_t established_ns;    // TCP  Ϸ
+    uint64_t ready_ns;          //   (WS 101 )
+    size_t pos;                 // Է    ġ
+    uint64_t records_left;
+    unsigned char *out;         // ۽  ( ߿ Ҵ)
+    size_t out_len;
+    size_t out_off;
+    uint16_t *rec_end;          // ۽   ڵ  ġ (out ڿ Բ Ҵ)
+    int rec_count;              // ۽ ۿ  ڵ 
+    int rec_sent;               //   Ʈ  ڵ 
+    char in[IN_BUF_SIZE];
+    size_t in_len;
+    uint64_t bytes;
+    uint64_t records;
+};
+
+/*****************************************************************************
+* Structure  : swarm
+* Description:  Ŭ̾Ʈ ü ¿ 
+*****************************************************************************/
+struct swarm
+{
+    int epfd;
+    struct swarm_conn *conns;
+    int max_conns;              //    (--conns)
+    int active;
+    int peak;
+    int ws_percent;
+    int ws_acc;                 // WS   (   )
+    const char *unix_path;
+    uint64_t records_per_conn;
+
+    // ڵ : --data  (mmap) Ǵ --size  ռ ڵ
+    const unsigned char *data;
+    size_t data_len;
+    unsigned char synth[CHUNK_MAX];
+    size_t synth_len;
+
+    // 
+    uint64_t opened;
+    uint64_t ws_opened;
+    uint64_t outcome[SWARM_OUTCOMES];
+    uint64_t bytes;
+    uint64_t records;
+    struct hdr_hist connect_lat;    // connect    Ϸ
+    struct hdr_hist upgrade_lat;    //  Ϸ  WS 101 
+    struct hdr_hist complete_lat;   // connect    ڵ ۽
+    struct hdr_hist conn_rate;      // Ϸ Ằ ó (Ʈ/,     ۽)
+};
+
+/*****************************************************************************
+* Function   : raise_fd_limit
+* Description:     hard ѵ ø
+* Returns    :  soft ѵ
+*****************************************************************************/
+static long raise_fd_limit(void)
+{
+    struct rlimit rl;
+
+    if (getrlimit(RLIMIT_NOFILE, &rl) < 0)
+        return 1024;
+    rl.rlim_cur = rl.rlim_max;
+    if (setrlimit(RLIMIT_NOFILE, &rl) < 0)
+        getrlimit(RLIMIT_NOFILE, &rl);
+    return (long)rl.rlim_cur;
+}
+
+/*****************************************************************************
+* Function   : conn_close
+* Description:  ,   (Ϸ  Ϸ ð/ó )
+*****************************************************************************/
+static void conn_close(struct swarm *s, struct swarm_conn *c, int outcome)
+{
+    uint64_t now = latency_now_ns();
+    double secs = 0.0;
+
+    if (outcome == SWARM_DONE)
+    {
+        hdr_record(&s->complete_lat, now - c->open_ns);
+        secs = (now - c->ready_ns) / 1e9;
+        if (secs > 0)
+            hdr_record(&s->conn_rate, (uint64_t)(c->bytes / secs));
+    }
+
+    PROBE3(conn_close, c->fd, c->bytes, c->records);
+    close(c->fd);
+    free(c->out);
+    c->out = NULL;
+    c->fd = -1;
+    s->outcome[outcome]++;
+    s->active--;
+}
+
+/*****************************************************************************
+* Function   : conn_open
+* Description:  ĭ ŷ   (Ϸ EPOLLOUT Ȯ)
+*              Unix  ⿭  EAGAIN ٷ ϹǷ  з 
+* Returns    : 0 (  ), -1 (ٷ )
+*****************************************************************************/
+static int conn_open(struct swarm *s, struct swarm_conn *c, int slot)
+{
+    struct sockaddr_in in_addr;
+    struct sockaddr_un un_addr;
+    struct epoll_event ev;
+    int r = 0;
+
+    memset(c, 0, sizeof(*c));
+    c->fd = socket(s->unix_path ? AF_UNIX : AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    c->open_ns = latency_now_ns();
+    s->opened++;
+    s->active++;
+    if (s->active > s->peak)
+        s->peak = s->active;
+
+    if (c->fd < 0)
+    {
+        c->fd = -1;
+        s->outcome[SWARM_REFUSED]++;
+        s->active--;
+        return -1;
+    }
+
+    // WS ŭ   (: 25% 4  1)
+    s->ws_acc += s->ws_percent;
+    if (s->ws_acc >= 100)
+    {
+        s->ws_acc -= 100;
+        c->ws = 1;
+        s->ws_opened++;
+    }
+
+    c->records_left = s->records_per_conn;
+    if (s->data != NULL)
+    {
+        // Ḷ ٸ ġ  ( ڵ  )
+        c->pos = (size_t)((s->opened * 2654435761ULL) % s->data_len);
+        while (c->pos > 0 && c->pos < s->data_len && s->data[c->pos - 1] != '\n')
+            c->pos++;
+        if (c->pos >= s->data_len)
+            c->pos = 0;
+    }
+
+    tune_apply_socket(&g_tune, c->fd, s->unix_path == NULL);
+    if (s->unix_path != NULL)
+    {
+        memset(&un_addr, 0, sizeof(un_addr));
+        un_addr.sun_family = AF_UNIX;
+        strncpy(un_addr.sun_path, s->unix_path, sizeof(un_addr.sun_path) - 1);
+        r = connect(c->fd, (struct sockaddr *)&un_addr, sizeof(un_addr));
+    }
+    else
+    {
+        memset(&in_addr, 0, sizeof(in_addr));
+        in_addr.sin_family = AF_INET;
+        in_addr.sin_port = htons(PORT);
+        inet_pton(AF_INET, "127.0.0.1", &in_addr.sin_addr);
+        r = connect(c->fd, (struct sockaddr *)&in_addr, sizeof(in_addr));
+    }
+
+    if (r < 0 && errno != EINPROGRESS)
+    {
+        conn_close(s, c, SWARM_REFUSED);
+        return -1;
+    }
+
+    c->state = SWARM_CONNECTING;
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.u32 = (uint32_t)slot;
+    if (epoll_ctl(s->epfd, EPOLL_CTL_ADD, c->fd, &ev) < 0)
+    {
+        conn_close(s, c, SWARM_ERROR);
+        return -1;
+    }
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : conn_fill
+* Description: ۽ ۰    ڵ  ä
+*                ״, WS  ŷ  (CHUNK_MAX Ѵ ڵ  )
+*              ڵ  ⼭  ʰ  ġ  ( Ʈ   conn_event )
+* Returns    : ä Ʈ  (0̸  ڵ ), Ҵ   -1
+*****************************************************************************/
+static int conn_fill(struct swarm *s, struct swarm_conn *c)
+{
+    const unsigned char *chunk = NULL;
+    const unsigned char *nl = NULL;
+    unsigned char *frame = NULL;
+    size_t len = 0;
+    size_t frame_len = 0;
+
+    if (c->out == NULL && (c->out = malloc(OUT_BUF_SIZE + REC_ENDS_MAX * sizeof(uint16_t))) == NULL)
+        return -1;
+    c->rec_end = (uint16_t *)(c->out + OUT_BUF_SIZE);
+    c->out_len = 0;
+    c->out_off = 0;
+    c->rec_count = 0;
+    c->rec_sent = 0;
+
+    while (c->records_left > 0 && c->rec_count < REC_ENDS_MAX)
+    {
+        if (s->data != NULL)
+        {
+            chunk = s->data + c->pos;
+            len = s->data_len - c->pos;
+            if (len > CHUNK_MAX)
+                len = CHUNK_MAX;
+            if ((nl = memchr(chunk, '\n', len)) != NULL)
+                len = nl - chunk + 1;
+        }
+        else
+        {
+            chunk = s->synth;
+            len = s->synth_len;
+        }
+
+        if (c->out_len + len + (c->ws ? 14 : 0) > OUT_BUF_SIZE)
+            break;
+
+        if (c->ws)
+        {
+            frame = create_ws_frame_masked(chunk, len, &frame_len);
+            if (frame == NULL)
+                return -1;
+            memcpy(c->out + c->out_len, frame, frame_len);
+            c->out_len += frame_len;
+            free(frame);
+        }
+        else
+        {
+            memcpy(c->out + c->out_len, chunk, len);
+            c->out_len += len;
+        }
+
+        if (chunk[len - 1] == '\n')
+        {
+            c->records_left--;
+            c->rec_end[c->rec_count++] = (uint16_t)c->out_len;
+        }
+        if (s->data != NULL && (c->pos += len) >= s->data_len)
+            c->pos = 0;
+    }
+
+    return (int)c->out_len;
+}
+
+/*****************************************************************************
+* Function   : conn_event
+* Description:  1 epoll ̺Ʈ ó
+*               Ϸ  (WS) ׷̵ û/  ۽    (̺Ʈ send 1ȸ
+*                ϰ),  ʹ 503  Ȯο 
+*****************************************************************************/
+static void conn_event(struct swarm *s, struct swarm_conn *c, int slot, uint32_t events)
+{
+    static const char request[] =
+        "GET / HTTP/1.1\r\n"
+        "Host: 127.0.0.1:8331\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+        "Sec-WebSocket-Version: 13\r\n\r\n";
+    struct epoll_event ev;
+    uint64_t now = latency_now_ns();
+    long retry_after_ms = 0;
+    socklen_t err_len = sizeof(int);
+    int err = 0;
+    ssize_t n = 0;
+
+    if (c->state == SWARM_CONNECTING)
+    {
+        if (getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &err, &err_len) < 0 || err != 0)
+        {
+            conn_close(s, c, SWARM_REFUSED);
+            return;
+        }
+        c->established_ns = now;
+        hdr_record(&s->connect_lat, now - c->open_ns);
+        PROBE2(conn_connect, c->fd, s->unix_path ? TRANSPORT_UNIX : TRANSPORT_TCP);
+
+        if (!c->ws)
+        {
+            c->ready_ns = now;
+            c->state = SWARM_SENDING;
+            return;
+        }
+
+        // û    (  ۽ ۰  )
+        if (send(c->fd, request, sizeof(request) - 1, MSG_NOSIGNAL) != (ssize_t)(sizeof(request) - 1))
+        {
+            conn_close(s, c, SWARM_ERROR);
+            return;
+        }
+        c->state = SWARM_HANDSHAKE;
+        ev.events = EPOLLIN;
+        ev.data.u32 = (uint32_t)slot;
+        epoll_ctl(s->epfd, EPOLL_CTL_MOD, c->fd, &ev);
+        return;
+    }
+
+    if (events & EPOLLIN)
+    {
+        n = recv(c->fd, c->in + c->in_len, sizeof(c->in) - 1 - c->in_len, 0);
+        if (n == 0 || (n < 0 && errno != EAGAIN))
+        {
+            //    (/ ,  ѵ ʰ )
+            conn_close(s, c, SWARM_ERROR);
+            return;
+        }
+        if (n > 0)
+        {
+            c->in_len += n;
+            c->in[c->in_len] = '\0';
+            if (backoff_parse_503(c->in, &retry_after_ms))
+            {
+                conn_close(s, c, SWARM_SHED);
+                return;
+            }
+
+            if (c->state == SWARM_HANDSHAKE)
+            {
+                if (strstr(c->in, "\r\n\r\n") == NULL)
+                {
+                    if (c->in_len == sizeof(c->in) - 1)
+                        conn_close(s, c, SWARM_ERROR);
+                    return;
+                }
+                if (strstr(c->in, " 101") == NULL)
+                {
+                    conn_close(s, c, SWARM_ERROR);
+                    return;
+                }
+                hdr_record(&s->upgrade_lat, now - c->established_ns);
+                PROBE2(handshake_done, c->fd, PROBE_HS_WS);
+                c->ready_ns = now;
+                c->state = SWARM_SENDING;
+                ev.events = EPOLLIN | EPOLLOUT;
+                ev.data.u32 = (uint32_t)slot;
+                epoll_ctl(s->epfd, EPOLL_CTL_MOD, c->fd, &ev);
+            }
+            c->in_len = 0;
+        }
+    }
+
+    if (c->state == SWARM_SENDING && (events & EPOLLOUT))
+    {
+        if (c->out_off == c->out_len)
+        {
+            if (conn_fill(s, c) < 0)
+            {
+                conn_close(s, c, SWARM_ERROR);
+                return;
+            }
+            if (c->out_len == 0)
+            {
+                conn_close(s, c, SWARM_DONE);
+                return;
+            }
+        }
+
+        n = send(c->fd, c->out + c->out_off, c->out_len - c->out_off, MSG_NOSIGNAL);
+        if (n < 0 && errno != EAGAIN)
+        {
+            conn_close(s, c, SWARM_ERROR);
+            return;
+        }
+        if (n > 0)
+        {
+            c->out_off += n;
+            c->bytes += n;
+            s->bytes += n;
+            while (c->rec_sent < c->rec_count && c->rec_end[c->rec_sent] <= c->out_off)
+            {
+                c->rec_sent++;
+                c->records++;
+                s->records++;
+            }
+        }
+    }
+    else if (events & (EPOLLERR | EPOLLHUP))
+    {
+        conn_close(s, c, SWARM_ERROR);
+    }
+}
+
+/*****************************************************************************
+* Function   : print_rate
+* Description: Ằ ó   (  Ʈ/)
+*****************************************************************************/
+static void print_rate(const struct hdr_hist *h, FILE *out)
+{
+    if (h->count == 0)
+        return;
+
+    fprintf(out, "[SWARM] Ằ ó(۽ ) min %.3f, p10 %.3f, p50 %.3f, p90 %.3f, max %.3f MB/s (%llu)\n",
+            h->min / 1048576.0, hdr_percentile(h, 10.0) / 1048576.0, hdr_percentile(h, 50.0) / 1048576.0,
+            hdr_percentile(h, 90.0) / 1048576.0, h->max / 1048576.0, (unsigned long long)h->count);
+}
+
+/*****************************************************************************
+* Function   : print_result
+* Description:   (--json̸ ġũ ũƮ JSON  )
+*****************************************************************************/
+static void print_result(const struct swarm *s, double elapsed, int json, FILE *out)
+{
+    double mbps = elapsed > 0 ? s->bytes / 1048576.0 / elapsed : 0.0;
+    double rps = elapsed > 0 ? s->records / elapsed : 0.0;
+
+    if (json)
+    {
+        fprintf(out, "{\"client\":\"client_swarm\",\"conns\":%d,\"ws_percent\":%d,\"elapsed_s\":%.6f,"
+                "\"opened\":%llu,\"ws_opened\":%llu,\"done\":%llu,\"shed\":%llu,\"refused\":%llu,"
+                "\"errors\":%llu,\"aborted\":%llu,\"peak\":%d,\"bytes\":%llu,\"records\":%llu,"
+                "\"mb_per_s\":%.3f,\"records_per_s\":%.1f,"
+                "\"connect_p50_us\":%.1f,\"connect_p99_us\":%.1f,\"connect_max_us\":%.1f,"
+                "\"upgrade_p50_us\":%.1f,\"upgrade_p99_us\":%.1f,\"upgrade_max_us\":%.1f,"
+                "\"conn_mb_per_s_min\":%.3f,\"conn_mb_per_s_p50\":%.3f,\"conn_mb_per_s_max\":%.3f}\n",
+                s->max_conns, s->ws_percent, elapsed,
+                (unsigned long long)s->opened, (unsigned long long)s->ws_opened,
+                (unsigned long long)s->outcome[SWARM_DONE], (unsigned long long)s->outcome[SWARM_SHED],
+                (unsigned long long)s->outcome[SWARM_REFUSED], (unsigned long long)s->outcome[SWARM_ERROR],
+                (unsigned long long)s->outcome[SWARM_ABORTED], s->peak,
+                (unsigned long long)s->bytes, (unsigned long long)s->records, mbps, rps,
+                hdr_percentile(&s->connect_lat, 50.0) / 1000.0, hdr_percentile(&s->connect_lat, 99.0) / 1000.0,
+                s->connect_lat.max / 1000.0,
+                hdr_percentile(&s->upgrade_lat, 50.0) / 1000.0, hdr_percentile(&s->upgrade_lat, 99.0) / 1000.0,
+                s->upgrade_lat.max / 1000.0,
+                s->conn_rate.count ? s->conn_rate.min / 1048576.0 : 0.0,
+                hdr_percentile(&s->conn_rate, 50.0) / 1048576.0, s->conn_rate.max / 1048576.0);
+        fflush(out);
+        return;
+    }
+
+    fprintf(out, "[SWARM]  %llu (WS %llu), Ϸ %llu, 503  %llu,   %llu,  %llu, ߴ %llu, ִ  %d\n",
+            (unsigned long long)s->opened, (unsigned long long)s->ws_opened,
+            (unsigned long long)s->outcome[SWARM_DONE], (unsigned long long)s->outcome[SWARM_SHED],
+            (unsigned long long)s->outcome[SWARM_REFUSED], (unsigned long long)s->outcome[SWARM_ERROR],
+            (unsigned long long)s->outcome[SWARM_ABORTED], s->peak);
+    fprintf(out, "[SWARM] ۽ %llu Ʈ, ڵ %llu, %.6f , հ %.2f MB/s, %.0f ڵ/\n",
+            (unsigned long long)s->bytes, (unsigned long long)s->records, elapsed, mbps, rps);
+    hdr_print(&s->connect_lat, "TCP ", out);
+    hdr_print(&s->upgrade_lat, "WS ׷̵", out);
+    hdr_print(&s->complete_lat, " Ϸ(    ۽)", out);
+    print_rate(&s->conn_rate, out);
+}
+
+/*****************************************************************************
+* Function   : map_data
+* Description: ڵ  б   (   )
+* Returns    : 0 (), -1 ()
+*****************************************************************************/
+static int map_data(struct swarm *s, const char *path)
+{
+    struct stat st;
+    void *p = NULL;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0 || fstat(fd, &st) < 0 || st.st_size == 0)
+    {
+        perror("Է   ");
+        if (fd >= 0)
+            close(fd);
+        return -1;
+    }
+
+    p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+    {
+        perror("Է   ");
+        return -1;
+    }
+
+    s->data = p;
+    s->data_len = st.st_size;
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : main
+* Description:    ϸ ڵ带   
+* Returns    : 0 ( ), -1 ( ߻ )
+*****************************************************************************/
+int main(int argc, char *argv[])
+{
+    static struct swarm s;
+    struct epoll_event events[MAX_EVENTS];
+    double duration_s = 0.0;
+    double churn = 0.0;
+    size_t rec_len = 110;
+    const char *data_path = NULL;
+    int json = 0;
+    uint64_t start_ns = 0;
+    uint64_t end_ns = 0;
+    uint64_t now = 0;
+    long fd_limit = 0;
+    int stopping = 0;
+    int slot = 0;
+    int n = 0;
+    int i = 0;
+    int c;
+    static struct option long_options[] = {
+        { "conns",      required_argument, NULL, 'c' },
+        { "ws-percent", required_argument, NULL, 'w' },
+        { "records",    required_argument, NULL, 'r' },
+        { "data",       required_argument, NULL, 'd' },
+        { "size",       required_argument, NULL, 's' },
+        { "duration",   required_argument, NULL, 't' },
+        { "churn",      required_argument, NULL, 'n' },
+        { "unix",       required_argument, NULL, 'u' },
+        { "json",       no_argument,       NULL, 'j' },
+        TUNE_LONG_OPTIONS,
+        { NULL, 0, NULL, 0 }
+    };
+
+    s.max_conns = 1000;
+    s.records_per_conn = 1000;
+
+    while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1)
+    {
+        int r = tune_option(c, optarg);
+        if (r < 0)
+            return -1;
+        if (r > 0)
+            continue;
+
+        switch (c)
+        {
+            case 'c': s.max_conns = atoi(optarg); break;
+            case 'w': s.ws_percent = atoi(optarg); break;
+            case 'r': s.records_per_conn = strtoull(optarg, NULL, 10); break;
+            case 'd': data_path = optarg; break;
+            case 's': rec_len = strtoul(optarg, NULL, 10); break;
+            case 't': duration_s = atof(optarg); break;
+            case 'n': churn = atof(optarg); break;
+            case 'u': s.unix_path = optarg; break;
+            case 'j': json = 1; break;
+            default: s.max_conns = 0; break;
+        }
+    }
+
+    if (s.max_conns <= 0 || s.ws_percent < 0 || s.ws_percent > 100 || s.records_per_conn == 0 ||
+        rec_len < 1 || rec_len > CHUNK_MAX || duration_s < 0 || churn < 0 || optind != argc)
+    {
+        fprintf(stderr, ": %s [--conns   ] [--ws-percent 0~100] [--records  ڵ ]\n"
+                        "       [--data ڵ  | --size ڵ Ʈ] [--duration ] [--churn ʴ  ]\n"
+                        "       [--unix ] [--json] %s\n", argv[0], TUNE_USAGE);
+        return -1;
+    }
+
+    // Ḷ fd 1 + epoll / ǥ  
+    fd_limit = raise_fd_limit();
+    if (s.max_conns > fd_limit - 16)
+    {
+        fprintf(stderr, "   ѵ %ld    %ld  (ulimit -n )\n",
+                fd_limit, fd_limit - 16);
+        s.max_conns = (int)(fd_limit - 16);
+    }
+
+    if (data_path != NULL && map_data(&s, data_path) < 0)
+        return -1;
+    s.synth_len = rec_len;
+    for (i = 0; i + 1 < (int)rec_len; i++)
+        s.synth[i] = "abcdefghijklmnopqrstuvwxyz0123456789"[i % 36];
+    s.synth[rec_len - 1] = '\n';
+
+    s.conns = calloc(s.max_conns, sizeof(struct swarm_conn));
+    s.epfd = epoll_create1(0);
+    if (s.conns == NULL || s.epfd < 0)
+    {
+        perror("ʱȭ ");
+        return -1;
+    }
+    for (i = 0; i < s.max_conns; i++)
+        s.conns[i].fd = -1;
+
+    hdr_init(&s.connect_lat);
+    hdr_init(&s.upgrade_lat);
+    hdr_init(&s.complete_lat);
+    hdr_init(&s.conn_rate);
+
+    start_ns = latency_now_ns();
+    end_ns = duration_s > 0 ? start_ns + (uint64_t)(duration_s * 1e9) : 0;
+    slot = 0;
+
+    while (1)
+    {
+        now = latency_now_ns();
+
+        // --duration     ߴ ϰ 
+        if (end_ns != 0 && now >= end_ns && !stopping)
+        {
+            stopping = 1;
+            for (i = 0; i < s.max_conns; i++)
+                if (s.conns[i].fd >= 0)
+                    conn_close(&s, &s.conns[i], SWARM_ABORTED);
+        }
+
+        //  ĭ   ä (--duration  --conns, --churn̸ ʴ  ѵ ȿ)
+        // ٷ ϸ( , fd )  ƽ ٽ õ
+        while (!stopping && s.active < s.max_conns &&
+               (end_ns != 0 || s.opened < (uint64_t)s.max_conns) &&
+               (churn == 0 || s.opened < (uint64_t)((now - start_ns) / 1e9 * churn) + 1))
+        {
+            while (s.conns[slot].fd >= 0)
+                slot = (slot + 1) % s.max_conns;
+            if (conn_open(&s, &s.conns[slot], slot) < 0)
+                break;
+        }
+
+        if (s.active == 0 && (stopping || (end_ns == 0 && s.opened >= (uint64_t)s.max_conns)))
+            break;
+
+        n = epoll_wait(s.epfd, events, MAX_EVENTS, TICK_MS);
+        if (n < 0 && errno != EINTR)
+        {
+            perror("epoll_wait ");
+            break;
+        }
+        for (i = 0; i < n; i++)
+        {
+            struct swarm_conn *conn = &s.conns[events[i].data.u32];
+            if (conn->fd >= 0)
+                conn_event(&s, conn, (int)events[i].data.u32, events[i].events);
+        }
+    }
+
+    print_result(&s, (latency_now_ns() - start_ns) / 1e9, json, stdout);
+
+    close(s.epfd);
+    free(s.conns);
+    if (s.data != NULL)
+        munmap((void *)s.data, s.data_len);
+
+    return s.outcome[SWARM_DONE] > 0 ? 0 : -1;
+}
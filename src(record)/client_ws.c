@@ -6,7 +6,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <getopt.h>
 #include <libwebsockets.h>
+#include "tune.h"
+#include "backoff.h"
+#include "latency.h"
+#include "probes.h"
+#include "client_report.h"
 
 #define BUF_SIZE 2048
 
@@ -14,6 +20,12 @@ static const char *g_file_to_send = NULL;
 static struct lws *g_wsi = NULL;
 static volatile int force_exit = 0;
 static struct lws_context *g_ctx = NULL;
+static int g_is_tcp = 1;
+static int g_shed = 0;               //  503() ׷̵带 
+static long g_retry_after_ms = 0;
+static int g_timestamp = 0;          // --timestamp: ڵ տ ۽ ð ǥ ( --latency)
+static struct client_report g_report; //   (lws_write 1ȸ = ۽ ȣ 1ȸ,   libwebsockets )
+static int g_json = 0;               // --json:   JSON  ٷ 
 
 /*****************************************************************************
 * Structure  : per_session_data
@@ -24,6 +36,7 @@ struct per_session_data
     FILE *fp;
     int file_eof;
     size_t total_bytes;
+    size_t records;
     int retry_pending;
     char *retry_line;
     size_t retry_len;
@@ -50,6 +63,8 @@ static int callback_file_client(struct lws *wsi,
         case LWS_CALLBACK_CLIENT_ESTABLISHED:
         {
             printf("[DEBUG] CLIENT:  \n");
+            tune_apply_socket(&g_tune, lws_get_socket_fd(wsi), g_is_tcp);
+            PROBE2(handshake_done, lws_get_socket_fd(wsi), PROBE_HS_WS);
 
             pss->fp = fopen(g_file_to_send, "r");
             if (!pss->fp)
@@ -60,6 +75,7 @@ static int callback_file_client(struct lws *wsi,
 
             pss->file_eof = 0;
             pss->total_bytes = 0;
+            pss->records = 0;
             pss->retry_pending = 0;
             pss->retry_line = NULL;
             pss->retry_len = 0;
@@ -78,6 +94,7 @@ static int callback_file_client(struct lws *wsi,
                 {
                     memcpy(buf + LWS_PRE, pss->retry_line, pss->retry_len);
                     m = lws_write(wsi, buf + LWS_PRE, pss->retry_len, LWS_WRITE_TEXT);
+                    g_report.send_calls++;
                     if (m == -1)
                     {
                         fprintf(stderr, "[ERROR] CLIENT:   (-1/%zu)\n", pss->retry_len);
@@ -85,11 +102,15 @@ static int callback_file_client(struct lws *wsi,
                     }
                     else if (m < (int)pss->retry_len)
                     {
+                        g_report.partial_writes++;
                         fprintf(stderr, "[ERROR] CLIENT:   κ  (%d/%zu), \n", m, pss->retry_len);
                         return -1;
                     }
 
                     printf("[DEBUG] CLIENT:   (%zu Ʈ)\n", pss->retry_len);
+                    g_report.bytes += pss->retry_len;
+                    g_report.records++;
+                    g_report.frames++;
                     free(pss->retry_line);
                     pss->retry_line = NULL;
                     pss->retry_len = 0;
@@ -99,7 +120,7 @@ static int callback_file_client(struct lws *wsi,
             else if (!pss->file_eof && fgets(line, sizeof(line), pss->fp))
             {
                 n = strlen(line);
-                if (n > BUF_SIZE - LWS_PRE)
+                if (n + (g_timestamp ? LATENCY_STAMP_LEN : 0) > BUF_SIZE - LWS_PRE)
                 {
                     fprintf(stderr, "[ERROR] CLIENT:  ũ ʰ (%zu Ʈ),  ߴ\n", n);
                     return -1;
@@ -107,21 +128,32 @@ static int callback_file_client(struct lws *wsi,
 
                 pss->total_bytes += n;
 
-                memcpy(buf + LWS_PRE, line, n);
+                if (g_timestamp)
+                    n = latency_stamp((char *)buf + LWS_PRE, BUF_SIZE, line, n);
+                else
+                    memcpy(buf + LWS_PRE, line, n);
                 m = lws_write(wsi, buf + LWS_PRE, n, LWS_WRITE_TEXT);
+                g_report.send_calls++;
                 if (m == -1)
                 {
                     fprintf(stderr, "[ERROR] CLIENT:   (-1/%zu), õ \n", n);
-                    pss->retry_line = strdup(line);
+                    pss->retry_line = strndup((char *)buf + LWS_PRE, n);
+                    g_report.allocs++;
                     pss->retry_len = n;
                     pss->retry_pending = 1;
                     return 0;
                 }
                 else if (m < (int)n)
                 {
+                    g_report.partial_writes++;
                     fprintf(stderr, "[ERROR] CLIENT: κ  (%d/%zu), \n", m, n);
                     return -1;
                 }
+                pss->records++;
+                g_report.bytes += n;
+                g_report.records++;
+                g_report.frames++;
+                PROBE3(records_counted, lws_get_socket_fd(wsi), 1, n);
 
             }
             else if (!pss->file_eof)
@@ -148,7 +180,21 @@ static int callback_file_client(struct lws *wsi,
 
         case LWS_CALLBACK_CLIENT_CONNECTION_ERROR:
         {
-            fprintf(stderr, "[ERROR] CLIENT:   Ǵ \n");
+            char retry_after[16];
+
+            //  ̸ main    
+            if (wsi != NULL && lws_http_client_http_response(wsi) == 503)
+            {
+                g_shed = 1;
+                g_retry_after_ms = 0;
+                if (lws_hdr_copy(wsi, retry_after, sizeof(retry_after), WSI_TOKEN_HTTP_RETRY_AFTER) > 0)
+                    g_retry_after_ms = atol(retry_after) * 1000;
+                force_exit = 1;
+                lws_cancel_service(g_ctx);
+                break;
+            }
+
+            fprintf(stderr, "[ERROR] CLIENT:   Ǵ  (%s)\n", in ? (const char *)in : "-");
             force_exit = 1;
             lws_cancel_service(g_ctx);
             break;
@@ -157,6 +203,7 @@ static int callback_file_client(struct lws *wsi,
         case LWS_CALLBACK_CLOSED:
         {
             printf("[DEBUG] CLIENT:  \n");
+            PROBE3(conn_close, lws_get_socket_fd(wsi), pss->total_bytes, pss->records);
             force_exit = 1;
             lws_cancel_service(g_ctx);
             break;
@@ -192,14 +239,37 @@ int main(int argc, char **argv)
 {
     struct lws_context_creation_info info;
     struct lws_client_connect_info ccinfo;
+    const char *unix_path = NULL;
+    char unix_address[128];
+    struct backoff retry;
+    int c;
+    static struct option long_options[] = {
+        { "unix", required_argument, NULL, 'u' },
+        { "timestamp", no_argument, NULL, 'T' },
+        { "json", no_argument, NULL, 'j' },
+        TUNE_LONG_OPTIONS,
+        { NULL, 0, NULL, 0 }
+    };
+
+    while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1)
+    {
+        if (tune_option(c, optarg) < 0)
+            return -1;
+        if (c == 'u')
+            unix_path = optarg;
+        if (c == 'T')
+            g_timestamp = 1;
+        if (c == 'j')
+            g_json = 1;
+    }
 
-    if (argc < 2)
+    if (optind >= argc)
     {
-        fprintf(stderr, ": %s <  >\n", argv[0]);
+        fprintf(stderr, ": %s [--unix ] [--timestamp] [--json] %s <  >\n", argv[0], TUNE_USAGE);
         return -1;
     }
 
-    g_file_to_send = argv[1];
+    g_file_to_send = argv[optind];
 
     memset(&info, 0, sizeof(info));
     memset(&ccinfo, 0, sizeof(ccinfo));
@@ -217,29 +287,48 @@ int main(int argc, char **argv)
     ccinfo.context = g_ctx;
     ccinfo.address = "127.0.0.1";
     ccinfo.port = 8331;
+    if (unix_path != NULL)
+    {
+        // libwebsockets '+' ϴ ּҸ Unix   η ؼ
+        snprintf(unix_address, sizeof(unix_address), "+%s", unix_path);
+        ccinfo.address = unix_address;
+        ccinfo.port = 0;
+        g_is_tcp = 0;
+    }
     ccinfo.path = "/";
     ccinfo.host = lws_canonical_hostname(g_ctx);
     ccinfo.origin = "origin";
     ccinfo.protocol = "file-transfer";
     ccinfo.ssl_connection = 0;
 
-    g_wsi = lws_client_connect_via_info(&ccinfo);
-    if (!g_wsi)
-    {
-        fprintf(stderr, "CLIENT:   \n");
-        lws_context_destroy(g_ctx);
-        return -1;
-    }
+    backoff_init(&retry, BACKOFF_BASE_MS, BACKOFF_MAX_MS, BACKOFF_MAX_ATTEMPTS);
+    client_report_start(&g_report, "client_ws", g_is_tcp ? "tcp" : "unix", 0);
 
-    while (!force_exit)
+    // ׷̵尡 503() Ǹ      
+    do
     {
-        if (lws_service(g_ctx, 100) < 0)
+        g_shed = 0;
+        force_exit = 0;
+
+        g_wsi = lws_client_connect_via_info(&ccinfo);
+        if (!g_wsi)
         {
-            break;
+            fprintf(stderr, "CLIENT:   \n");
+            lws_context_destroy(g_ctx);
+            return -1;
         }
-    }
+
+        while (!force_exit)
+        {
+            if (lws_service(g_ctx, 100) < 0)
+            {
+                break;
+            }
+        }
+    } while (g_shed && backoff_wait(&retry, g_retry_after_ms) == 0);
 
     lws_context_destroy(g_ctx);
+    client_report_print(&g_report, g_json, stdout);
     printf("CLIENT: α׷  \n");
     return 0;
 }
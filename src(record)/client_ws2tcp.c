@@ -9,82 +9,20 @@
 #include <stdint.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <getopt.h>
+#include "tls_offload.h"
+#include "transport.h"
+#include "tune.h"
+#include "backoff.h"
+#include "latency.h"
+#include "probes.h"
+#include "client_report.h"
+#include "completion.h"
+#include "ws_proto.h"
 
 #define BUF_SIZE 1024
 #define PORT 8331
 
-/*****************************************************************************
-* Function   : create_ws_frame_masked
-* Description: WebSocket   (ؽƮ , ŷ )
-* Parameters : - const unsigned char *payload : ̷ε
-*              - size_t payload_len           : ̷ε 
-*              - size_t *frame_len            :    ȯ 
-* Returns    :   (heap ޸)
-*****************************************************************************/
-unsigned char* create_ws_frame_masked(const unsigned char* payload, size_t payload_len, size_t* frame_len)
-{
-    unsigned char *frame = NULL;
-    size_t i = 0;
-    size_t header_len = 2;
-    size_t extra_len = 0;
-    size_t mask_len = 4;
-    unsigned char mask_key[4] = {0x12, 0x34, 0x56, 0x78};
-
-    if (payload_len > 125 && payload_len < 65536)
-    {
-        extra_len = 2;
-    }
-    else if (payload_len >= 65536)
-    {
-        extra_len = 8;
-    }
-
-    *frame_len = header_len + extra_len + mask_len + payload_len;
-    frame = malloc(*frame_len);
-    if (!frame)
-    {
-        return NULL;
-    }
-
-    frame[0] = 0x81;  // FIN + ؽƮ 
-
-    if (payload_len <= 125)
-    {
-        frame[1] = 0x80 | (unsigned char)payload_len;
-        memcpy(frame + 2, mask_key, 4);
-        for (i = 0; i < payload_len; i++)
-        {
-            frame[6 + i] = payload[i] ^ mask_key[i % 4];
-        }
-    }
-    else if (payload_len < 65536)
-    {
-        frame[1] = 0x80 | 126;
-        frame[2] = (payload_len >> 8) & 0xFF;
-        frame[3] = payload_len & 0xFF;
-        memcpy(frame + 4, mask_key, 4);
-        for (i = 0; i < payload_len; i++)
-        {
-            frame[8 + i] = payload[i] ^ mask_key[i % 4];
-        }
-    }
-    else
-    {
-        frame[1] = 0x80 | 127;
-        for (i = 0; i < 8; i++)
-        {
-            frame[2 + i] = (payload_len >> ((7 - i) * 8)) & 0xFF;
-        }
-        memcpy(frame + 10, mask_key, 4);
-        for (i = 0; i < payload_len; i++)
-        {
-            frame[14 + i] = payload[i] ^ mask_key[i % 4];
-        }
-    }
-
-    return frame;
-}
-
 /*****************************************************************************
 * Function   : main
 * Description:  \n  о WebSocket  TCP  
@@ -98,50 +36,93 @@ int main(int argc, char *argv[])
 
     // Ʈũ 
     int sock = 0;
-    struct sockaddr_in server_addr;
+    const char *unix_path = NULL;
+    int sock_type = SOCK_STREAM;
 
     //  
     char line_buffer[BUF_SIZE];
+    char stamped[LATENCY_STAMP_LEN + BUF_SIZE];
+    char *rec = line_buffer;
+    int use_timestamp = 0;
     size_t line_len = 0;
     unsigned char *ws_frame = NULL;
     size_t frame_len = 0;
+    struct send_batch batch;
+    struct client_report report;
+    int json = 0;
+
+    //  Ϸ Ȯ (--ack)
+    int use_ack = 0;
+    int ack_failed = 0;
+    uint64_t payload_bytes = 0;
+    uint64_t conn_ns = 0;
+    struct completion ack;
+    struct completion reply;
 
     // ڵũ û/
     char request[512];
     char response[512];
+    ssize_t received = 0;
+
+    // ɼ  TLS
+    int use_tls = 0;
+    int use_ktls = 1;
+    int c;
+    static struct option long_options[] = {
+        { "tls",     no_argument, NULL, 't' },
+        { "no-ktls", no_argument, NULL, 'n' },
+        { "unix",    required_argument, NULL, 'u' },
+        { "timestamp", no_argument,     NULL, 'T' },
+        { "json",    no_argument,       NULL, 'j' },
+        { "ack",     no_argument,       NULL, 'a' },
+        TUNE_LONG_OPTIONS,
+        { NULL, 0, NULL, 0 }
+    };
+    SSL_CTX *tls_ctx = NULL;
+    SSL *ssl = NULL;
+
+    //  õ
+    struct backoff retry;
+    long retry_after_ms = 0;
 
-    if (argc != 2)
+    while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1)
     {
-        fprintf(stderr, ": %s <  >\n", argv[0]);
-        return -1;
+        int r = tune_option(c, optarg);
+        if (r < 0)
+            return -1;
+        if (r > 0)
+            continue;
+
+        switch (c)
+        {
+            case 't': use_tls = 1; break;
+            case 'n': use_ktls = 0; break;
+            case 'u': unix_path = optarg; break;
+            case 'T': use_timestamp = 1; rec = stamped; break;
+            case 'j': json = 1; break;
+            case 'a': use_ack = 1; break;
+            default: break;
+        }
     }
 
-    file_path = argv[1];
-    fp = fopen(file_path, "r");
-    if (!fp)
+    if (optind != argc - 1)
     {
-        perror("  ");
+        fprintf(stderr, ": %s [--unix ] [--tls [--no-ktls]] [--timestamp] [--json] [--ack]\n"
+                        "       %s <  >\n", argv[0], TUNE_USAGE);
         return -1;
     }
 
-    sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock < 0)
+    if (send_batch_init(&batch, g_tune.write_chunk) < 0)
     {
-        perror("  ");
-        fclose(fp);
+        perror("޸ Ҵ ");
         return -1;
     }
 
-    memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(PORT);
-    inet_pton(AF_INET, "127.0.0.1", &server_addr.sin_addr);
-
-    if (connect(sock, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0)
+    file_path = argv[optind];
+    fp = fopen(file_path, "r");
+    if (!fp)
     {
-        perror("  ");
-        close(sock);
-        fclose(fp);
+        perror("  ");
         return -1;
     }
 
@@ -154,36 +135,90 @@ int main(int argc, char *argv[])
              "Sec-WebSocket-Version: 13\r\n\r\n",
              PORT);
 
-    if (send(sock, request, strlen(request), 0) < 0)
-    {
-        perror("ڵũ û  ");
-        close(sock);
-        fclose(fp);
-        return -1;
-    }
+    backoff_init(&retry, BACKOFF_BASE_MS, BACKOFF_MAX_MS, BACKOFF_MAX_ATTEMPTS);
+    client_report_start(&report, "client_ws2tcp", unix_path ? "unix" : "tcp", use_tls);
 
-    if (recv(sock, response, sizeof(response) - 1, 0) <= 0)
+    // ڵũ 503()̸      
+    while (1)
     {
-        perror("   ");
+        if (unix_path != NULL)
+            sock = transport_connect_unix(unix_path, sock_type);
+        else
+            sock = transport_connect_tcp("127.0.0.1", PORT);
+
+        if (sock < 0)
+        {
+            fclose(fp);
+            return -1;
+        }
+        conn_ns = latency_now_ns();
+
+        if (use_tls)
+        {
+            tls_ctx = tls_ctx ? tls_ctx : tls_client_ctx(use_ktls);
+            ssl = tls_ctx ? tls_connect(tls_ctx, sock) : NULL;
+            if (ssl == NULL)
+            {
+                //  Ͽ ڵũ ģ  TLS 503 Ƿ ⼭ õ 
+                fprintf(stderr, "TLS ڵũ \n");
+                close(sock);
+                SSL_CTX_free(tls_ctx);
+                fclose(fp);
+                return -1;
+            }
+            printf("TLS  (%s, kTLS TX: %s)\n", SSL_get_cipher(ssl), tls_ktls_tx(ssl) ? "on" : "off");
+        }
+
+        if (tls_send(ssl, sock, request, strlen(request)) < 0)
+        {
+            perror("ڵũ û  ");
+            received = -1;
+        }
+        else
+        {
+            received = tls_recv(ssl, sock, response, sizeof(response) - 1);
+            if (received <= 0)
+                perror("   ");
+        }
+
+        if (received > 0)
+        {
+            response[received] = '\0';
+            if (!backoff_parse_503(response, &retry_after_ms))
+                break;
+        }
+
+        tls_close(ssl);
+        ssl = NULL;
         close(sock);
-        fclose(fp);
-        return -1;
+
+        if (received <= 0 || backoff_wait(&retry, retry_after_ms) < 0)
+        {
+            SSL_CTX_free(tls_ctx);
+            fclose(fp);
+            return -1;
+        }
     }
 
+    PROBE2(handshake_done, sock, PROBE_HS_WS);
     printf(" : %s\n", response);
     printf(" . \n  ڵ  ...\n");
 
     while (fgets(line_buffer, sizeof(line_buffer), fp) != NULL)
     {
         line_len = strlen(line_buffer);
-        ws_frame = create_ws_frame_masked((unsigned char *)line_buffer, line_len, &frame_len);
+        if (use_timestamp)
+            line_len = latency_stamp(stamped, sizeof(stamped), line_buffer, line_len);
+        ws_frame = create_ws_frame_masked((unsigned char *)rec, line_len, &frame_len);
         if (!ws_frame)
         {
             fprintf(stderr, "WebSocket   \n");
             break;
         }
+        report.allocs++;
+        payload_bytes += line_len;
 
-        if (send(sock, ws_frame, frame_len, 0) < 0)
+        if (send_batch_put(&batch, ssl, sock, ws_frame, frame_len) < 0)
         {
             perror("  ");
             free(ws_frame);
@@ -192,10 +227,46 @@ int main(int argc, char *argv[])
         free(ws_frame);
     }
 
+    if (send_batch_flush(&batch, ssl, sock) < 0)
+        perror("  ");
+
     printf("ڵ  Ϸ.\n");
 
+    //  ̷ε Ʈ  ٲ  Ƿ     
+    if (use_ack)
+    {
+        ack.bytes = payload_bytes;
+        ack.records = batch.sent_records;
+        if (completion_send(ssl, sock, COMPLETION_WS, &ack) < 0 ||
+            completion_wait(ssl, sock, COMPLETION_WS, &reply) < 0)
+        {
+            fprintf(stderr, "[ACK]  Ϸ  \n");
+            ack_failed = 1;
+        }
+        else
+        {
+            report.acked = 1;
+            report.e2e_s = (latency_now_ns() - conn_ns) / 1e9;
+            report.server_s = reply.elapsed_us / 1e6;
+            report.ack_match = completion_report(&ack, &reply, report.e2e_s, stdout) == 0;
+            ack_failed = !report.ack_match;
+        }
+    }
+
+    // Ӹ ŷ 纻 Ҵ (report.allocs =  )
+    report.bytes = batch.sent_bytes;
+    report.records = batch.sent_records;
+    report.frames = batch.sent_records;
+    report.send_calls = batch.send_calls;
+    report.partial_writes = batch.partial_writes;
+    client_report_print(&report, json, stdout);
+
+    PROBE3(conn_close, sock, batch.sent_bytes, batch.sent_records);
+    send_batch_free(&batch);
+    tls_close(ssl);
+    SSL_CTX_free(tls_ctx);
     close(sock);
     fclose(fp);
 
-    return 0;
+    return ack_failed ? -1 : 0;
 }
@@ -0,0 +1,178 @@
+/*****************************************************************************
+* File       : completion.c
+* Description:  Ϸ Ȯ  ǥ/   Ŭ̾Ʈ ۼ
+*****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "completion.h"
+#include "tls_offload.h"
+
+/*****************************************************************************
+* Function   : completion_format
+* Description: "ACK <Ʈ> <ڵ>" (reply ڿ " < us>") 
+* Returns    :  
+*****************************************************************************/
+size_t completion_format(char *buf, size_t size, const struct completion *c, int reply)
+{
+    int n = 0;
+
+    if (reply)
+        n = snprintf(buf, size, "ACK %llu %llu %llu", (unsigned long long)c->bytes,
+                     (unsigned long long)c->records, (unsigned long long)c->elapsed_us);
+    else
+        n = snprintf(buf, size, "ACK %llu %llu", (unsigned long long)c->bytes, (unsigned long long)c->records);
+
+    return n < 0 ? 0 : ((size_t)n < size ? (size_t)n : size - 1);
+}
+
+/*****************************************************************************
+* Function   : completion_marker
+* Description:  ۿ  ǥ ڵ "\0ACK <Ʈ> <ڵ>\n" 
+*              ( ޸   ڵ带   )
+* Returns    :  
+*****************************************************************************/
+size_t completion_marker(char *buf, size_t size, const struct completion *c)
+{
+    size_t len = 0;
+
+    if (size < 3)
+        return 0;
+
+    buf[0] = COMPLETION_MARKER;
+    len = 1 + completion_format(buf + 1, size - 2, c, 0);
+    buf[len++] = '\n';
+    return len;
+}
+
+/*****************************************************************************
+* Function   : completion_parse
+* Description: completion_format  ؼ (buf NUL ᰡ ƴϾ )
+* Returns    : 0 (), -1 ( )
+*****************************************************************************/
+int completion_parse(const char *buf, size_t len, struct completion *c, int reply)
+{
+    char text[COMPLETION_MAX + 1];
+    unsigned long long bytes = 0, records = 0, elapsed = 0;
+
+    if (len > COMPLETION_MAX)
+        return -1;
+    memcpy(text, buf, len);
+    text[len] = '\0';
+
+    memset(c, 0, sizeof(*c));
+    if (reply ? sscanf(text, "ACK %llu %llu %llu", &bytes, &records, &elapsed) != 3
+              : sscanf(text, "ACK %llu %llu", &bytes, &records) != 2)
+        return -1;
+
+    c->bytes = bytes;
+    c->records = records;
+    c->elapsed_us = elapsed;
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : completion_send
+* Description: (Ŭ̾Ʈ)  ڵ ڿ  ǥ 
+*              WS ŷ close  ( ڵ 1000 +  ǥ ڿ)
+* Returns    : 0 (), -1 ( )
+*****************************************************************************/
+int completion_send(SSL *ssl, int fd, int type, const struct completion *c)
+{
+    static const unsigned char mask[4] = { 0x12, 0x34, 0x56, 0x78 };
+    unsigned char buf[COMPLETION_MAX + 16];
+    unsigned char payload[COMPLETION_MAX + 2];
+    size_t len = 0;
+    size_t i = 0;
+    int one = 1;
+
+    // ռ  ACK ٸ Nagle ̸   ð  ACK ŭ Ƿ
+    //  ǥô ٷ  (TCP ƴϸ ص )
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    if (type == COMPLETION_RAW)
+    {
+        len = completion_marker((char *)buf, sizeof(buf), c);
+    }
+    else
+    {
+        payload[0] = 0x03;              // 1000 ( )
+        payload[1] = 0xE8;
+        len = 2 + completion_format((char *)payload + 2, COMPLETION_MAX, c, 0);
+
+        buf[0] = 0x88;                  // FIN + close
+        buf[1] = 0x80 | (unsigned char)len;
+        memcpy(buf + 2, mask, 4);
+        for (i = 0; i < len; i++)
+            buf[6 + i] = payload[i] ^ mask[i % 4];
+        len += 6;
+    }
+
+    return tls_send(ssl, fd, buf, len) == (ssize_t)len ? 0 : -1;
+}
+
+/*****************************************************************************
+* Function   : completion_wait
+* Description: (Ŭ̾Ʈ)    ( ٲ Ǵ close ӱ, ŷ)
+* Returns    : 0 (), -1 (  Ǿų  )
+*****************************************************************************/
+int completion_wait(SSL *ssl, int fd, int type, struct completion *reply)
+{
+    unsigned char buf[COMPLETION_MAX + 16];
+    size_t len = 0;
+    size_t need = 0;
+    ssize_t n = 0;
+
+    while (len < sizeof(buf))
+    {
+        n = tls_recv(ssl, fd, buf + len, sizeof(buf) - len);
+        if (n <= 0)
+            return -1;
+        len += n;
+
+        if (type == COMPLETION_RAW)
+        {
+            if (memchr(buf, '\n', len) != NULL)
+                return completion_parse((char *)buf, (unsigned char *)memchr(buf, '\n', len) - buf, reply, 1);
+            continue;
+        }
+
+        //   ŷ ,   ̷ε 125 Ʈ 
+        if (len < 2)
+            continue;
+        if ((buf[0] & 0x0F) != 0x8 || (buf[1] & 0x7F) < 2)
+            return -1;
+        need = 2 + (buf[1] & 0x7F);
+        if (len >= need)
+            return completion_parse((char *)buf + 4, need - 4, reply, 1);
+    }
+
+    return -1;
+}
+
+/*****************************************************************************
+* Function   : completion_report
+* Description:      
+* Parameters : - double e2e_sec : Ŭ̾Ʈ  Ӻ  ű (  ̸ )
+* Returns    : 0 (ġ), 1 (ġ)
+*****************************************************************************/
+int completion_report(const struct completion *sent, const struct completion *got, double e2e_sec, FILE *out)
+{
+    int match = sent->bytes == got->bytes && sent->records == got->records;
+
+    fprintf(out, "[ACK]  %llu Ʈ / %llu ڵ,   %llu Ʈ / %llu ڵ ( %.6f )",
+            (unsigned long long)sent->bytes, (unsigned long long)sent->records,
+            (unsigned long long)got->bytes, (unsigned long long)got->records, got->elapsed_us / 1e6);
+    if (e2e_sec >= 0)
+        fprintf(out, ",   %.6f  (%.2f MB/s)", e2e_sec, e2e_sec > 0 ? got->bytes / 1048576.0 / e2e_sec : 0.0);
+    if (match)
+        fprintf(out, "  ġ\n");
+    else
+        fprintf(out, "  ġ (Ʈ %+lld, ڵ %+lld)\n",
+                (long long)(got->bytes - sent->bytes), (long long)(got->records - sent->records));
+
+    return match ? 0 : 1;
+}
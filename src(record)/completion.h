@@ -0,0 +1,43 @@
+/*****************************************************************************
+* File       : completion.h
+* Description:  Ϸ Ȯ (--ack)
+*              Ŭ̾Ʈ  ڵ ڿ  Ʈ/ڵ  ˸  ڱⰡ
+*                 ð   Ŭ̾Ʈ   ð ڵ ս θ Ȯ
+*              -   (TCP/Unix/SEQPACKET/ ޸): "\0ACK <Ʈ> <ڵ>\n" ڵ
+*                  "ACK <Ʈ> <ڵ> <  us>\n"
+*              - WebSocket: close (1000)  ڿ  
+*****************************************************************************/
+
+#ifndef COMPLETION_H
+#define COMPLETION_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <openssl/ssl.h>
+
+#define COMPLETION_MARKER   '\0'        //  ǥ ڵ ù Ʈ (ؽƮ ڵ忡  )
+#define COMPLETION_MAX      64          //  ǥ/ ִ  (WS   125 Ʈ ̳)
+
+#define COMPLETION_RAW      0           //  ǥ ڵ /   
+#define COMPLETION_WS       1           // close 
+
+/*****************************************************************************
+* Structure  : completion
+* Description:  ǥ(Ŭ̾Ʈ ۽ ) Ǵ (  )
+*****************************************************************************/
+struct completion
+{
+    uint64_t bytes;             // ڵ  Ʈ ( ǥ/  )
+    uint64_t records;
+    uint64_t elapsed_us;        // 丸:   (WS ׷̵)  ǥñ
+};
+
+size_t completion_marker(char *buf, size_t size, const struct completion *c);
+size_t completion_format(char *buf, size_t size, const struct completion *c, int reply);
+int completion_parse(const char *buf, size_t len, struct completion *c, int reply);
+int completion_send(SSL *ssl, int fd, int type, const struct completion *c);
+int completion_wait(SSL *ssl, int fd, int type, struct completion *reply);
+int completion_report(const struct completion *sent, const struct completion *got, double e2e_sec, FILE *out);
+
+#endif
@@ -0,0 +1,232 @@
+/*****************************************************************************
+* File       : flight.c
+* Description:  ϱ  , SIGUSR1 / ̻ ¡ 
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include "flight.h"
+
+static struct flight_ring *g_rings[FLIGHT_MAX_THREADS];
+static int g_ring_count = 0;
+static char g_prefix[256];                      //    պκ (.<pid>.<ȣ>)
+static unsigned g_dump_seq = 0;
+static uint64_t g_last_anomaly_ns = 0;
+
+__thread struct flight_ring *t_flight = NULL;
+
+/*****************************************************************************
+* Function   : now_ns
+* Description: clock_gettime async-signal-safe̹Ƿ ڵ鷯 
+*****************************************************************************/
+static uint64_t now_ns(clockid_t clock)
+{
+    struct timespec ts;
+
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*****************************************************************************
+* Function   : append_uint
+* Description: 10 ڿ ̱ (snprintf async-signal-safe ƴϹǷ  ȯ)
+*****************************************************************************/
+static size_t append_uint(char *buf, size_t len, size_t size, unsigned long v)
+{
+    char digits[24];
+    int n = 0;
+
+    do
+    {
+        digits[n++] = '0' + v % 10;
+        v /= 10;
+    } while (v > 0);
+
+    while (n > 0 && len + 1 < size)
+        buf[len++] = digits[--n];
+    buf[len] = '\0';
+
+    return len;
+}
+
+/*****************************************************************************
+* Function   : write_all
+* Description: ª  ó
+*****************************************************************************/
+static int write_all(int fd, const void *buf, size_t len)
+{
+    const char *p = buf;
+    ssize_t n = 0;
+
+    while (len > 0)
+    {
+        n = write(fd, p, len);
+        if (n <= 0)
+            return -1;
+        p += n;
+        len -= n;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : on_sigusr1
+* Description: SIGUSR1    (̺Ʈ   ־ )
+*****************************************************************************/
+static void on_sigusr1(int sig)
+{
+    static const char msg[] = "[FLIGHT] SIGUSR1  \n";
+    int saved = errno;
+
+    (void)sig;
+    if (flight_dump(FLIGHT_DUMP_SIGNAL) >= 0)
+        write_all(STDERR_FILENO, msg, sizeof(msg) - 1);
+    errno = saved;
+}
+
+/*****************************************************************************
+* Function   : flight_init
+* Description:  ϱ ѱ (  , SIGUSR1 ڵ鷯 )
+* Returns    : 0 (), -1 (ΰ ʹ  / ڵ鷯  )
+*****************************************************************************/
+int flight_init(const char *prefix)
+{
+    struct sigaction sa;
+
+    if (strlen(prefix) >= sizeof(g_prefix) - 32)
+        return -1;
+    strcpy(g_prefix, prefix);
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_sigusr1;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+
+    return sigaction(SIGUSR1, &sa, NULL);
+}
+
+/*****************************************************************************
+* Function   : flight_register_thread
+* Description: ȣ  ̺Ʈ  Ҵ (̺Ʈ     )
+* Returns    : 0 (), -1 (޸  /   ʰ)
+*****************************************************************************/
+int flight_register_thread(void)
+{
+    int idx = __atomic_fetch_add(&g_ring_count, 1, __ATOMIC_RELAXED);
+    struct flight_ring *r = NULL;
+
+    if (idx >= FLIGHT_MAX_THREADS)
+        return -1;
+
+    r = calloc(1, sizeof(*r));
+    if (r == NULL)
+        return -1;
+
+    __atomic_store_n(&g_rings[idx], r, __ATOMIC_RELEASE);
+    t_flight = r;
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : flight_dump
+* Description:     ϳ  (async-signal-safe Լ )
+*              ٸ 尡  ̸   ̺Ʈ    ̺Ʈ
+*                 (ڴ ð  )
+* Returns    :  ȣ, -1 ( / )
+*****************************************************************************/
+int flight_dump(int reason)
+{
+    char path[sizeof(g_prefix)];
+    struct flight_dump_hdr hdr;
+    struct flight_ring_hdr rh;
+    struct flight_ring *r = NULL;
+    unsigned seq = __atomic_fetch_add(&g_dump_seq, 1, __ATOMIC_RELAXED);
+    uint64_t head = 0;
+    uint64_t start = 0;
+    size_t first = 0;
+    size_t len = 0;
+    int rings = __atomic_load_n(&g_ring_count, __ATOMIC_RELAXED);
+    int fd = -1;
+    int i, rc = 0;
+
+    if (rings > FLIGHT_MAX_THREADS)
+        rings = FLIGHT_MAX_THREADS;
+
+    len = strlen(g_prefix);
+    memcpy(path, g_prefix, len);
+    path[len++] = '.';
+    len = append_uint(path, len, sizeof(path), (unsigned long)getpid());
+    path[len++] = '.';
+    append_uint(path, len, sizeof(path), seq);
+
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return -1;
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, FLIGHT_MAGIC, sizeof(hdr.magic));
+    hdr.version = FLIGHT_VERSION;
+    hdr.event_size = sizeof(struct flight_event);
+    hdr.rings = rings;
+    hdr.mono_ns = now_ns(CLOCK_MONOTONIC);
+    hdr.real_ns = now_ns(CLOCK_REALTIME);
+    hdr.reason = reason;
+    hdr.pid = getpid();
+    rc = write_all(fd, &hdr, sizeof(hdr));
+
+    for (i = 0; i < rings && rc == 0; i++)
+    {
+        r = __atomic_load_n(&g_rings[i], __ATOMIC_ACQUIRE);
+        head = r ? __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) : 0;
+        start = head > FLIGHT_EVENTS ? head - FLIGHT_EVENTS : 0;
+
+        rh.thread = i;
+        rh.count = (uint32_t)(head - start);
+        rc = write_all(fd, &rh, sizeof(rh));
+        if (rc < 0 || rh.count == 0)
+            continue;
+
+        //   δ      ( )
+        first = start & (FLIGHT_EVENTS - 1);
+        if (first + rh.count <= FLIGHT_EVENTS)
+        {
+            rc = write_all(fd, &r->ev[first], rh.count * sizeof(struct flight_event));
+        }
+        else
+        {
+            rc = write_all(fd, &r->ev[first], (FLIGHT_EVENTS - first) * sizeof(struct flight_event));
+            if (rc == 0)
+                rc = write_all(fd, &r->ev[0], (first + rh.count - FLIGHT_EVENTS) * sizeof(struct flight_event));
+        }
+    }
+
+    close(fd);
+    return rc == 0 ? (int)seq : -1;
+}
+
+/*****************************************************************************
+* Function   : flight_anomaly
+* Description: ̻ ¡  ( ߻  FLIGHT_ANOMALY_GAP_MS  )
+*****************************************************************************/
+void flight_anomaly(int reason)
+{
+    uint64_t now = now_ns(CLOCK_MONOTONIC);
+    int seq = 0;
+
+    if (t_flight == NULL ||
+        (g_last_anomaly_ns != 0 && now - g_last_anomaly_ns < FLIGHT_ANOMALY_GAP_MS * 1000000ULL))
+        return;
+
+    g_last_anomaly_ns = now;
+    seq = flight_dump(reason);
+    if (seq >= 0)
+        printf("[FLIGHT] ̻ ¡ : %s.%d.%d\n", g_prefix, (int)getpid(), seq);
+    else
+        perror("[FLIGHT]  ");
+}
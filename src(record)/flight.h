@@ -0,0 +1,127 @@
+/*****************************************************************************
+* File       : flight.h
+* Description:  ̺Ʈ  ϱ (flight recorder)
+*              帶  ũ  ̺Ʈ  ֱ ̺Ʈ( ũ, , ü,
+*               Ȯ,  )  ϰ, SIGUSR1 Ǵ ̻ ¡( )
+*              ߻  Ϸ .  flight_decode Ằ ŸӶ 
+*              - : ڱ   Ƿ / RMW  (head release )
+*              - : open/write ϹǷ ñ׳ ڵ鷯 ٷ ȣ 
+*****************************************************************************/
+
+#ifndef FLIGHT_H
+#define FLIGHT_H
+
+#include <stdint.h>
+#include <time.h>
+
+#define FLIGHT_EVENTS           8192    //  ̺Ʈ  (2 ŵ, 32 Ʈ 256 KB)
+#define FLIGHT_MAX_THREADS      16
+#define FLIGHT_STALL_MS         50      //   ̺  ü(STALL) ̺Ʈ 
+#define FLIGHT_ANOMALY_GAP_MS   10000   // ̻ ¡  ּ 
+
+#define FLIGHT_MAGIC            "FLR1"
+#define FLIGHT_VERSION          1
+
+// ̺Ʈ  (arg / arg2 ǹ)
+#define FLIGHT_ACCEPT           1       //   (TRANSPORT_*)
+#define FLIGHT_HANDSHAKE        2       // PROBE_HS_WS / PROBE_HS_TLS
+#define FLIGHT_READ             3       //  Ʈ
+#define FLIGHT_FRAME            4       // ̷ε , opcode
+#define FLIGHT_STALL            5       //     (ms)
+#define FLIGHT_GROW             6       //  뷮,  뷮
+#define FLIGHT_BACKPRESSURE     7       // PROBE_BP_*, ΰ 
+#define FLIGHT_SLOW             8       // ˻   Ʈ,   (ms)
+#define FLIGHT_CLOSE            9       // FLIGHT_CLOSE_*,   Ʈ
+
+//  
+#define FLIGHT_CLOSE_PEER       0       // 밡   ()
+#define FLIGHT_CLOSE_ERROR      1       // /TLS 
+#define FLIGHT_CLOSE_PROTOCOL   2       // ڵũ/ 
+#define FLIGHT_CLOSE_HANDSHAKE  3       // ڵũ  ð ʰ
+#define FLIGHT_CLOSE_IDLE       4       //   ð ʰ
+#define FLIGHT_CLOSE_SLOW       5       // ּ  ӵ ̴
+#define FLIGHT_CLOSE_LINGER     6       // close    ʰ
+#define FLIGHT_CLOSE_SHUTDOWN   7       //  
+
+//  
+#define FLIGHT_DUMP_SIGNAL      0       // SIGUSR1
+#define FLIGHT_DUMP_SLOW        1       // ˻   ӵ --flight-min-rate ̸ /  
+
+/*****************************************************************************
+* Structure  : flight_event
+* Description: ̺Ʈ 1 (32 Ʈ,  Ͽ ״ )
+*****************************************************************************/
+struct flight_event
+{
+    uint64_t ts_ns;                     // CLOCK_MONOTONIC
+    int32_t fd;
+    uint16_t type;                      // FLIGHT_*
+    uint16_t aux;                       //  ΰ  (FRAME: opcode)
+    uint64_t arg;
+    uint64_t arg2;
+};
+
+/*****************************************************************************
+* Structure  : flight_ring
+* Description:  1 ̺Ʈ  (  ϳ)
+*****************************************************************************/
+struct flight_ring
+{
+    uint64_t head;                      // ݱ  ̺Ʈ 
+    struct flight_event ev[FLIGHT_EVENTS];
+};
+
+/*****************************************************************************
+* Structure  : flight_dump_hdr / flight_ring_hdr
+* Description:    -  ,  ڷ    +   ̺Ʈ
+*****************************************************************************/
+struct flight_dump_hdr
+{
+    char magic[4];                      // FLIGHT_MAGIC
+    uint32_t version;
+    uint32_t event_size;                // sizeof(struct flight_event)
+    uint32_t rings;
+    uint64_t mono_ns;                   //  ð (CLOCK_MONOTONIC / CLOCK_REALTIME, ð ȯ)
+    uint64_t real_ns;
+    uint32_t reason;                    // FLIGHT_DUMP_*
+    uint32_t pid;
+};
+
+struct flight_ring_hdr
+{
+    uint32_t thread;
+    uint32_t count;
+};
+
+extern __thread struct flight_ring *t_flight;
+
+int flight_init(const char *prefix);
+int flight_register_thread(void);
+int flight_dump(int reason);
+void flight_anomaly(int reason);
+
+/*****************************************************************************
+* Function   : flight_record
+* Description: ڱ   ̺Ʈ 1  ( ϱ⸦  ʾ ƹ͵  )
+*****************************************************************************/
+static inline void flight_record(int type, int fd, uint64_t arg, uint64_t arg2, int aux)
+{
+    struct flight_ring *r = t_flight;
+    struct flight_event *e = NULL;
+    struct timespec ts;
+
+    if (r == NULL)
+        return;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    e = &r->ev[r->head & (FLIGHT_EVENTS - 1)];
+    e->ts_ns = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    e->fd = fd;
+    e->type = (uint16_t)type;
+    e->aux = (uint16_t)aux;
+    e->arg = arg;
+    e->arg2 = arg2;
+    __atomic_store_n(&r->head, r->head + 1, __ATOMIC_RELEASE);
+}
+
+#endif
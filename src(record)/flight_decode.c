@@ -0,0 +1,351 @@
+/*****************************************************************************
+* File       : flight_decode.c
+* Description:  ϱ (server_tcpws --flight) Ằ ŸӶ 
+*              ӵ / ̺Ʈ  ٷ  (-v  ),
+*              ü/ Ȯ///  ð Բ  
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include "flight.h"
+#include "probes.h"
+#include "transport.h"
+
+#define MAX_CONNS 4096
+
+/*****************************************************************************
+* Structure  : conn
+* Description:  1 ( 忡 fd ACCEPT ~ CLOSE ̿  )
+*****************************************************************************/
+struct conn
+{
+    int thread;
+    int fd;
+    int partial;                        // ACCEPT  з  κ 
+    int closed;
+    uint64_t first_ns;
+    uint64_t last_ns;
+    uint64_t bytes;
+    size_t events;
+};
+
+static struct flight_event *g_events = NULL;
+static int *g_event_conn = NULL;        // ̺Ʈ  ȣ (-1:  )
+static int *g_event_thread = NULL;
+static size_t g_event_count = 0;
+static struct conn g_conns[MAX_CONNS];
+static int g_conn_count = 0;
+static struct flight_dump_hdr g_hdr;
+
+static const char *g_close_reasons[] = { " ", "/TLS ", " ", "ڵũ  ð",
+                                         "  ð", "ּ ӵ ̴", "linger ʰ", " " };
+static const char *g_bp_names[] = { "  ʰ", " ⿭", "503 ", " ޸   ", "503 " };
+static const char *g_transport_names[] = { "tcp", "unix", "seqpacket", "shm" };
+static const char *g_dump_reasons[] = { "SIGUSR1", " " };
+
+/*****************************************************************************
+* Function   : load_dump
+* Description:   б ( ̺Ʈ ϳ 迭)
+* Returns    : 0 (), -1 ( )
+*****************************************************************************/
+static int load_dump(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    struct flight_ring_hdr rh;
+    size_t cap = 0;
+    uint32_t r;
+    uint32_t i;
+
+    if (fp == NULL)
+    {
+        perror("   ");
+        return -1;
+    }
+
+    if (fread(&g_hdr, sizeof(g_hdr), 1, fp) != 1 || memcmp(g_hdr.magic, FLIGHT_MAGIC, 4) != 0 ||
+        g_hdr.version != FLIGHT_VERSION || g_hdr.event_size != sizeof(struct flight_event))
+    {
+        fprintf(stderr, " ϱ   ƴ: %s\n", path);
+        fclose(fp);
+        return -1;
+    }
+
+    for (r = 0; r < g_hdr.rings; r++)
+    {
+        if (fread(&rh, sizeof(rh), 1, fp) != 1 || rh.count > FLIGHT_EVENTS)
+            break;
+
+        if (g_event_count + rh.count > cap)
+        {
+            cap = g_event_count + rh.count;
+            g_events = realloc(g_events, cap * sizeof(*g_events));
+            g_event_thread = realloc(g_event_thread, cap * sizeof(int));
+            if (g_events == NULL || g_event_thread == NULL)
+            {
+                perror("޸ Ҵ ");
+                fclose(fp);
+                return -1;
+            }
+        }
+
+        if (fread(g_events + g_event_count, sizeof(*g_events), rh.count, fp) != rh.count)
+        {
+            fprintf(stderr, " ߸ ( %u)\n", rh.thread);
+            break;
+        }
+        for (i = 0; i < rh.count; i++)
+            g_event_thread[g_event_count + i] = rh.thread;
+        g_event_count += rh.count;
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : find_open_conn / assign_conns
+* Description: ̺Ʈ  . ACCEPT    CLOSE 
+*              (fd ǹǷ fdδ   )
+*****************************************************************************/
+static int find_open_conn(int thread, int fd)
+{
+    int c;
+
+    for (c = g_conn_count - 1; c >= 0; c--)
+    {
+        if (g_conns[c].thread == thread && g_conns[c].fd == fd)
+            return g_conns[c].closed ? -1 : c;
+    }
+    return -1;
+}
+
+static void assign_conns(void)
+{
+    struct flight_event *e = NULL;
+    struct conn *cn = NULL;
+    size_t i;
+    int c;
+
+    g_event_conn = malloc((g_event_count + 1) * sizeof(int));
+    if (g_event_conn == NULL)
+        return;
+
+    for (i = 0; i < g_event_count; i++)
+    {
+        e = &g_events[i];
+        g_event_conn[i] = -1;
+        if (e->fd < 0)
+            continue;
+
+        c = e->type == FLIGHT_ACCEPT ? -1 : find_open_conn(g_event_thread[i], e->fd);
+        if (c < 0)
+        {
+            //  ⿭/503  ̺Ʈ    Ƿ   
+            if (e->type == FLIGHT_BACKPRESSURE && e->arg != PROBE_BP_RECV_FULL)
+                continue;
+            if (g_conn_count == MAX_CONNS)
+                continue;
+
+            c = g_conn_count++;
+            memset(&g_conns[c], 0, sizeof(g_conns[c]));
+            g_conns[c].thread = g_event_thread[i];
+            g_conns[c].fd = e->fd;
+            g_conns[c].partial = e->type != FLIGHT_ACCEPT;
+            g_conns[c].first_ns = e->ts_ns;
+        }
+
+        cn = &g_conns[c];
+        cn->last_ns = e->ts_ns;
+        cn->events++;
+        if (e->type == FLIGHT_READ)
+            cn->bytes += e->arg;
+        if (e->type == FLIGHT_CLOSE)
+            cn->closed = 1;
+        g_event_conn[i] = c;
+    }
+}
+
+/*****************************************************************************
+* Function   : print_wallclock
+* Description: CLOCK_MONOTONIC ð    ð ð 
+*****************************************************************************/
+static void print_wallclock(uint64_t mono_ns)
+{
+    uint64_t real = g_hdr.real_ns - (g_hdr.mono_ns - mono_ns);
+    time_t sec = (time_t)(real / 1000000000ULL);
+    struct tm tm;
+    char buf[32];
+
+    localtime_r(&sec, &tm);
+    strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+    printf("%s.%06llu", buf, (unsigned long long)(real % 1000000000ULL / 1000));
+}
+
+/*****************************************************************************
+* Function   : print_event
+* Description:  ̺Ʈ 1 (/  print_conn ó)
+*****************************************************************************/
+static void print_event(const struct flight_event *e, uint64_t base_ns)
+{
+    printf("  %+12.3f ms  ", (double)(int64_t)(e->ts_ns - base_ns) / 1e6);
+
+    switch (e->type)
+    {
+        case FLIGHT_ACCEPT:
+            printf("  (%s)\n", e->arg < 4 ? g_transport_names[e->arg] : "?");
+            break;
+        case FLIGHT_HANDSHAKE:
+            printf("ڵũ Ϸ (%s)\n", e->arg == PROBE_HS_TLS ? "TLS" : "WebSocket");
+            break;
+        case FLIGHT_READ:
+            printf(" %llu Ʈ\n", (unsigned long long)e->arg);
+            break;
+        case FLIGHT_FRAME:
+            printf(" opcode 0x%x, %llu Ʈ\n", e->aux, (unsigned long long)e->arg);
+            break;
+        case FLIGHT_STALL:
+            printf("ü %llu ms (  )\n", (unsigned long long)e->arg);
+            break;
+        case FLIGHT_GROW:
+            printf(" Ȯ %llu  %llu Ʈ\n", (unsigned long long)e->arg, (unsigned long long)e->arg2);
+            break;
+        case FLIGHT_BACKPRESSURE:
+            printf(": %s (%llu)\n", e->arg < 5 ? g_bp_names[e->arg] : "?", (unsigned long long)e->arg2);
+            break;
+        case FLIGHT_SLOW:
+            printf(" : %llu Ʈ / %llu ms (%.0f B/s)\n", (unsigned long long)e->arg,
+                   (unsigned long long)e->arg2, e->arg2 ? e->arg * 1000.0 / e->arg2 : 0.0);
+            break;
+        case FLIGHT_CLOSE:
+            printf(": %s ( %llu Ʈ)\n", e->arg < 8 ? g_close_reasons[e->arg] : "?",
+                   (unsigned long long)e->arg2);
+            break;
+        default:
+            printf("   ̺Ʈ %u\n", e->type);
+            break;
+    }
+}
+
+/*****************************************************************************
+* Function   : print_conn
+* Description:  1 ŸӶ
+*****************************************************************************/
+static void print_conn(int c, int verbose)
+{
+    struct conn *cn = &g_conns[c];
+    const struct flight_event *e = NULL;
+    uint64_t run_start = 0, run_end = 0;
+    uint64_t reads = 0, read_bytes = 0, frames = 0, frame_bytes = 0;
+    size_t i;
+    double secs = (cn->last_ns - cn->first_ns) / 1e9;
+
+    printf("===  fd %d ( %d) ", cn->fd, cn->thread);
+    print_wallclock(cn->first_ns);
+    printf(", %.3f ms,  %llu Ʈ (%.3f MB/s)%s%s\n", secs * 1000.0, (unsigned long long)cn->bytes,
+           secs > 0 ? cn->bytes / secs / 1e6 : 0.0,
+           cn->partial ? ",  κ  з" : "", cn->closed ? "" : ",    ");
+
+    for (i = 0; i <= g_event_count; i++)
+    {
+        e = i < g_event_count ? &g_events[i] : NULL;
+        if (e != NULL && g_event_conn[i] != c)
+            continue;
+
+        // ӵ /  ٷ 
+        if (!verbose && e != NULL && (e->type == FLIGHT_READ || e->type == FLIGHT_FRAME))
+        {
+            if (reads + frames == 0)
+                run_start = e->ts_ns;
+            run_end = e->ts_ns;
+            if (e->type == FLIGHT_READ)
+            {
+                reads++;
+                read_bytes += e->arg;
+            }
+            else
+            {
+                frames++;
+                frame_bytes += e->arg;
+            }
+            continue;
+        }
+
+        if (reads + frames > 0)
+        {
+            printf("  %+12.3f ms   %lluȸ %llu Ʈ", (double)(run_start - cn->first_ns) / 1e6,
+                   (unsigned long long)reads, (unsigned long long)read_bytes);
+            if (frames > 0)
+                printf(",  %llu %llu Ʈ", (unsigned long long)frames, (unsigned long long)frame_bytes);
+            if (reads + frames > 1)
+                printf(" (%.3f ms )", (run_end - run_start) / 1e6);
+            printf("\n");
+            reads = read_bytes = frames = frame_bytes = 0;
+        }
+
+        if (e != NULL)
+            print_event(e, cn->first_ns);
+    }
+    printf("\n");
+}
+
+/*****************************************************************************
+* Function   : main
+* Description:   ؼ  Ằ 
+*****************************************************************************/
+int main(int argc, char *argv[])
+{
+    int verbose = 0;
+    int fd_filter = -1;
+    int order[MAX_CONNS];
+    int i, j, t, c;
+    static struct option long_options[] = {
+        { "verbose", no_argument,       NULL, 'v' },
+        { "fd",      required_argument, NULL, 'f' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    while ((c = getopt_long(argc, argv, "vf:", long_options, NULL)) != -1)
+    {
+        switch (c)
+        {
+            case 'v': verbose = 1; break;
+            case 'f': fd_filter = atoi(optarg); break;
+            default: break;
+        }
+    }
+
+    if (optind != argc - 1)
+    {
+        fprintf(stderr, ": %s [-v | --verbose] [--fd ȣ] < >\n", argv[0]);
+        return -1;
+    }
+
+    if (load_dump(argv[optind]) < 0)
+        return -1;
+    assign_conns();
+    if (g_event_conn == NULL)
+        return -1;
+
+    printf(": pid %u,  %s, ", g_hdr.pid, g_hdr.reason < 2 ? g_dump_reasons[g_hdr.reason] : "?");
+    print_wallclock(g_hdr.mono_ns);
+    printf(",  %u, ̺Ʈ %zu,  %d\n\n", g_hdr.rings, g_event_count, g_conn_count);
+
+    // ù ̺Ʈ ð  ( ,   )
+    for (i = 0; i < g_conn_count; i++)
+    {
+        for (j = i; j > 0 && g_conns[order[j - 1]].first_ns > g_conns[i].first_ns; j--)
+            order[j] = order[j - 1];
+        order[j] = i;
+    }
+
+    for (t = 0; t < g_conn_count; t++)
+    {
+        if (fd_filter < 0 || g_conns[order[t]].fd == fd_filter)
+            print_conn(order[t], verbose);
+    }
+
+    return 0;
+}
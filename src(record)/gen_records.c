@@ -0,0 +1,308 @@
+/*****************************************************************************
+* File       : gen_records.c
+* Description:     \n  ڵ  
+*               õ ɼ̸ ׻  Ʈ (ü PRNG,  64 KB  Ʈ)
+*              - ڵ  : fixed / uniform / lognormal / huge ( ü ڵ 1)
+*              -  : ascii / utf8 (ѱ 3 Ʈ + ASCII,  ߰  ) /
+*                binary (0x00 \n   Ʈ, Ŭ̾Ʈ fgets/strlen ڵ  )
+*              - : --compress ۼƮŭ   ݺ,  
+*                stderr ڵ , ִ , Ŭ̾Ʈ fgets (1023 Ʈ) Ѵ ڵ  
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <getopt.h>
+
+#define OUT_BUF_SIZE    65536
+#define FGETS_LIMIT     1023            // Ŭ̾Ʈ BUF_SIZE 1024 - NUL,  ڵ尡   ۵
+
+#define DIST_FIXED      0
+#define DIST_UNIFORM    1
+#define DIST_LOGNORMAL  2
+#define DIST_HUGE       3
+
+#define CHARS_ASCII     0
+#define CHARS_UTF8      1
+#define CHARS_BINARY    2
+
+static const char g_phrase[] = "the quick brown fox jumps over the lazy dog 0123456789 ";
+
+/*****************************************************************************
+* Structure  : gen_state
+* Description:   (PRNG,  , )
+*****************************************************************************/
+struct gen_state
+{
+    uint64_t rng;
+    FILE *out;
+    unsigned char buf[OUT_BUF_SIZE];
+    size_t len;
+    int chars;
+    int compress;               // 0 ~ 100 (  )
+    size_t phrase_pos;
+    uint64_t bytes;
+    uint64_t records;
+    uint64_t max_len;
+    uint64_t over_fgets;
+};
+
+/*****************************************************************************
+* Function   : next_u64 / next_double
+* Description: splitmix64 (÷ ϰ  )
+*****************************************************************************/
+static uint64_t next_u64(struct gen_state *g)
+{
+    uint64_t z = (g->rng += 0x9E3779B97F4A7C15ULL);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static double next_double(struct gen_state *g)
+{
+    return (next_u64(g) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*****************************************************************************
+* Function   : put_byte
+* Description:  ۿ 1 Ʈ,   
+* Returns    : 0 (), -1 ( )
+*****************************************************************************/
+static int put_byte(struct gen_state *g, unsigned char c)
+{
+    g->buf[g->len++] = c;
+    if (g->len == OUT_BUF_SIZE)
+    {
+        if (fwrite(g->buf, 1, g->len, g->out) != g->len)
+            return -1;
+        g->len = 0;
+    }
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : put_char
+* Description:  1  (  ȿ,     Ǵ )
+* Returns    :  Ʈ ,    -1
+*****************************************************************************/
+static int put_char(struct gen_state *g, uint64_t room)
+{
+    unsigned int cp = 0;
+    unsigned char c = 0;
+    int r = 0;
+
+    if (g->compress > 0 && (int)(next_u64(g) % 100) < g->compress)
+    {
+        c = g_phrase[g->phrase_pos++ % (sizeof(g_phrase) - 1)];
+        return put_byte(g, c) < 0 ? -1 : 1;
+    }
+
+    if (g->chars == CHARS_BINARY)
+    {
+        // 0x00(strlen ) \n(ڵ ) 
+        do
+            c = (unsigned char)next_u64(g);
+        while (c == 0x00 || c == '\n');
+        return put_byte(g, c) < 0 ? -1 : 1;
+    }
+
+    if (g->chars == CHARS_UTF8 && room >= 3 && (next_u64(g) & 1))
+    {
+        // ѱ  U+AC00 ~ U+D7A3
+        cp = 0xAC00 + next_u64(g) % 11172;
+        r = put_byte(g, 0xE0 | (cp >> 12));
+        r |= put_byte(g, 0x80 | ((cp >> 6) & 0x3F));
+        r |= put_byte(g, 0x80 | (cp & 0x3F));
+        return r < 0 ? -1 : 3;
+    }
+
+    c = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 ,.-_:"[next_u64(g) % 68];
+    return put_byte(g, c) < 0 ? -1 : 1;
+}
+
+/*****************************************************************************
+* Function   : put_record
+* Description:  len Ʈ + \n ڵ 1 
+* Returns    : 0 (), -1 ( )
+*****************************************************************************/
+static int put_record(struct gen_state *g, uint64_t len)
+{
+    uint64_t done = 0;
+    int n = 0;
+
+    while (done < len)
+    {
+        if ((n = put_char(g, len - done)) < 0)
+            return -1;
+        done += n;
+    }
+    if (put_byte(g, '\n') < 0)
+        return -1;
+
+    g->bytes += len + 1;
+    g->records++;
+    if (len + 1 > g->max_len)
+        g->max_len = len + 1;
+    if (len + 1 > FGETS_LIMIT)
+        g->over_fgets++;
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : parse_size
+* Description: ũ ڿ ؼ (k / m / g ̻, 1024 )
+* Returns    : Ʈ ,   0
+*****************************************************************************/
+static uint64_t parse_size(const char *s)
+{
+    char *end = NULL;
+    double v = strtod(s, &end);
+
+    if (end == s || v < 0)
+        return 0;
+
+    switch (*end)
+    {
+        case 'k': case 'K': v *= 1024.0; break;
+        case 'm': case 'M': v *= 1024.0 * 1024.0; break;
+        case 'g': case 'G': v *= 1024.0 * 1024.0 * 1024.0; break;
+        case '\0': break;
+        default: return 0;
+    }
+
+    return (uint64_t)v;
+}
+
+/*****************************************************************************
+* Function   : main
+* Description: ɼǿ  ڵ    Ǵ ǥ  Ʈ
+* Returns    : 0 ( ), -1 ( ߻ )
+*****************************************************************************/
+int main(int argc, char *argv[])
+{
+    // ɼ
+    uint64_t total = 0;
+    uint64_t seed = 42;
+    int dist = DIST_UNIFORM;
+    uint64_t len = 110;             // fixed  / lognormal ߾Ӱ ( ٲ )
+    uint64_t min_len = 40;
+    uint64_t max_len = 180;
+    double sigma = 0.5;
+    const char *out_path = NULL;
+    int c;
+    static struct option long_options[] = {
+        { "size",     required_argument, NULL, 's' },
+        { "seed",     required_argument, NULL, 'r' },
+        { "dist",     required_argument, NULL, 'd' },
+        { "len",      required_argument, NULL, 'l' },
+        { "min",      required_argument, NULL, 'a' },
+        { "max",      required_argument, NULL, 'b' },
+        { "sigma",    required_argument, NULL, 'g' },
+        { "chars",    required_argument, NULL, 'c' },
+        { "compress", required_argument, NULL, 'z' },
+        { "output",   required_argument, NULL, 'o' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    //  
+    static struct gen_state g;
+    uint64_t rec_len = 0;
+
+    g.chars = CHARS_ASCII;
+
+    while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1)
+    {
+        switch (c)
+        {
+            case 's': total = parse_size(optarg); break;
+            case 'r': seed = strtoull(optarg, NULL, 0); break;
+            case 'l': len = parse_size(optarg); break;
+            case 'a': min_len = parse_size(optarg); break;
+            case 'b': max_len = parse_size(optarg); break;
+            case 'g': sigma = atof(optarg); break;
+            case 'z': g.compress = atoi(optarg); break;
+            case 'o': out_path = optarg; break;
+            case 'd':
+                if (strcmp(optarg, "fixed") == 0)           dist = DIST_FIXED;
+                else if (strcmp(optarg, "uniform") == 0)    dist = DIST_UNIFORM;
+                else if (strcmp(optarg, "lognormal") == 0)  dist = DIST_LOGNORMAL;
+                else if (strcmp(optarg, "huge") == 0)       dist = DIST_HUGE;
+                else dist = -1;
+                break;
+            case 'c':
+                if (strcmp(optarg, "ascii") == 0)           g.chars = CHARS_ASCII;
+                else if (strcmp(optarg, "utf8") == 0)       g.chars = CHARS_UTF8;
+                else if (strcmp(optarg, "binary") == 0)     g.chars = CHARS_BINARY;
+                else g.chars = -1;
+                break;
+            default: dist = -1; break;
+        }
+    }
+
+    if (total == 0 || dist < 0 || g.chars < 0 || g.compress < 0 || g.compress > 100 ||
+        min_len > max_len || optind != argc)
+    {
+        fprintf(stderr, ": %s --size ũ[k|m|g] [--seed N] [--output ]\n"
+                        "       [--dist fixed|uniform|lognormal|huge] [--len ] [--min ּ --max ִ] [--sigma 0.5]\n"
+                        "       [--chars ascii|utf8|binary] [--compress 0~100]\n", argv[0]);
+        return -1;
+    }
+
+    g.out = stdout;
+    if (out_path != NULL && (g.out = fopen(out_path, "wb")) == NULL)
+    {
+        perror("   ");
+        return -1;
+    }
+
+    g.rng = seed;
+
+    // ü ũ( ٲ ) ߰,  ڵ  ũ ڸ
+    while (g.bytes < total)
+    {
+        switch (dist)
+        {
+            case DIST_FIXED:
+                rec_len = len;
+                break;
+            case DIST_UNIFORM:
+                rec_len = min_len + next_u64(&g) % (max_len - min_len + 1);
+                break;
+            case DIST_LOGNORMAL:
+                // Box-Muller Ժ  exp (߾Ӱ len)
+                rec_len = (uint64_t)(len * exp(sigma * sqrt(-2.0 * log(1.0 - next_double(&g))) *
+                                               cos(2.0 * M_PI * next_double(&g))));
+                break;
+            default:
+                rec_len = total;
+                break;
+        }
+
+        if (rec_len + 1 > total - g.bytes)
+            rec_len = total - g.bytes - 1;
+
+        if (put_record(&g, rec_len) < 0)
+        {
+            perror(" ");
+            return -1;
+        }
+    }
+
+    if ((g.len > 0 && fwrite(g.buf, 1, g.len, g.out) != g.len) || fflush(g.out) != 0)
+    {
+        perror(" ");
+        return -1;
+    }
+    if (g.out != stdout)
+        fclose(g.out);
+
+    fprintf(stderr, "records=%llu bytes=%llu max_len=%llu over_fgets=%llu\n",
+            (unsigned long long)g.records, (unsigned long long)g.bytes,
+            (unsigned long long)g.max_len, (unsigned long long)g.over_fgets);
+
+    return 0;
+}
@@ -0,0 +1,177 @@
+/*****************************************************************************
+* File       : handoff.c
+* Description: ߴ ۿ   ΰ
+*               μ   ϸ  μ  
+*              SCM_RIGHTS ѱ  ̻ accept .   Ŀο
+*                Ƿ  ߿  źε ʰ backlog 
+*              ( μ    ģ  )
+*****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "handoff.h"
+#include "transport.h"
+
+/*****************************************************************************
+* Structure  : handoff_msg
+* Description: ΰ ޽  (fd   SCM_RIGHTS Ǹ)
+*****************************************************************************/
+struct handoff_msg
+{
+    char magic[4];                  // "LSN1"
+    int count;                      //  
+    int roles[HANDOFF_MAX_FDS];     //   (TRANSPORT_*)
+};
+
+/*****************************************************************************
+* Function   : handoff_request
+* Description: ( μ)  μ  Ͽ    
+* Parameters : - const char *path :   
+*              - int *fds         :   
+*              - int *roles       :    (TRANSPORT_*)
+* Returns    :   , 0 (   μ ), -1 ()
+*****************************************************************************/
+int handoff_request(const char *path, int *fds, int *roles, int max_fds)
+{
+    struct handoff_msg body;
+    char cbuf[CMSG_SPACE(sizeof(int) * HANDOFF_MAX_FDS)];
+    struct iovec iov = { &body, sizeof(body) };
+    struct msghdr msg;
+    struct cmsghdr *cmsg = NULL;
+    ssize_t n = 0;
+    int received = 0;
+    int sock = 0;
+    int i;
+
+    if (access(path, F_OK) < 0)
+        return 0;
+
+    sock = transport_connect_unix(path, SOCK_STREAM);
+    if (sock < 0)
+        return errno == ECONNREFUSED ? 0 : -1;   //  μ   
+
+    memset(&msg, 0, sizeof(msg));
+    memset(cbuf, 0, sizeof(cbuf));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+
+    n = recvmsg(sock, &msg, MSG_WAITALL);
+    close(sock);
+
+    if (n < 0)
+    {
+        perror("  ΰ  ");
+        return -1;
+    }
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg != NULL && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+        received = (int)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+
+    //  ޽ ߷(MSG_CTRUNC)  fd ݰ  ó
+    if ((msg.msg_flags & MSG_CTRUNC) || n != sizeof(body) || memcmp(body.magic, "LSN1", 4) != 0 ||
+        body.count != received || received > max_fds)
+    {
+        fprintf(stderr, "  ΰ ޽ ùٸ \n");
+        for (i = 0; i < received && i < HANDOFF_MAX_FDS; i++)
+            close(((int *)CMSG_DATA(cmsg))[i]);
+        return -1;
+    }
+
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(int) * received);
+    memcpy(roles, body.roles, sizeof(int) * received);
+    return received;
+}
+
+/*****************************************************************************
+* Function   : handoff_listen
+* Description:       (ŷ,  ִ  ü)
+* Returns    :  ,   -1
+*****************************************************************************/
+int handoff_listen(const char *path)
+{
+    int fd = transport_listen_unix(path, SOCK_STREAM, 1);
+
+    if (fd >= 0)
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+    return fd;
+}
+
+/*****************************************************************************
+* Function   : handoff_serve
+* Description: ( μ)    ޾   
+*              ȣڴ   ʸ ݰ(Ǵ handoff_retire) 巹  ȯ
+* Returns    : 1 (ΰ Ϸ), 0 (  û ), -1 ()
+*****************************************************************************/
+int handoff_serve(int ctrl_fd, const int *fds, const int *roles, int n)
+{
+    struct handoff_msg body;
+    char cbuf[CMSG_SPACE(sizeof(int) * HANDOFF_MAX_FDS)];
+    struct iovec iov = { &body, sizeof(body) };
+    struct msghdr msg;
+    struct cmsghdr *cmsg = NULL;
+    int sock = 0;
+
+    if (n <= 0 || n > HANDOFF_MAX_FDS)
+        return -1;
+
+    sock = accept(ctrl_fd, NULL, NULL);
+    if (sock < 0)
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+
+    memset(&body, 0, sizeof(body));
+    memcpy(body.magic, "LSN1", 4);
+    body.count = n;
+    memcpy(body.roles, roles, sizeof(int) * n);
+
+    memset(&msg, 0, sizeof(msg));
+    memset(cbuf, 0, sizeof(cbuf));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * n);
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * n);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * n);
+
+    if (sendmsg(sock, &msg, MSG_NOSIGNAL) != sizeof(body))
+    {
+        perror("  ΰ ");
+        close(sock);
+        return -1;
+    }
+
+    close(sock);
+    return 1;
+}
+
+/*****************************************************************************
+* Function   : handoff_retire
+* Description: ΰ ʸ ̺Ʈ      (libwebsockets) 
+*               fd ȣ  Ͱ  ʴ  ٲ  ̻ accept
+*              ʰ .   ü  μ  fd   
+*****************************************************************************/
+void handoff_retire(int fd)
+{
+    int p[2];
+
+    if (pipe(p) < 0)
+    {
+        perror("pipe ");
+        return;
+    }
+
+    dup2(p[0], fd);
+    close(p[0]);
+    //   μ  ñ   ( EOF б ̺Ʈ ߻)
+}
@@ -0,0 +1,16 @@
+/*****************************************************************************
+* File       : handoff.h
+* Description: ߴ ۿ   ΰ (AF_UNIX   + SCM_RIGHTS)
+*****************************************************************************/
+
+#ifndef HANDOFF_H
+#define HANDOFF_H
+
+#define HANDOFF_MAX_FDS 4           // ΰ  ִ   (TCP / Unix / SEQPACKET / SHM)
+
+int handoff_request(const char *path, int *fds, int *roles, int max_fds);
+int handoff_listen(const char *path);
+int handoff_serve(int ctrl_fd, const int *fds, const int *roles, int n);
+void handoff_retire(int fd);
+
+#endif
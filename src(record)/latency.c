@@ -0,0 +1,212 @@
+/*****************************************************************************
+* File       : latency.c
+* Description: ۽ ð ǥ/ؼ  HDR ׷
+*****************************************************************************/
+
+#include <string.h>
+#include <time.h>
+#include "latency.h"
+
+/*****************************************************************************
+* Function   : latency_now_ns
+* Description: CLOCK_MONOTONIC  ð (ns)
+*****************************************************************************/
+uint64_t latency_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*****************************************************************************
+* Function   : latency_stamp
+* Description: (Ŭ̾Ʈ) ڵ տ  ۽ ð ٿ out 
+* Returns    :  , out  0
+*****************************************************************************/
+size_t latency_stamp(char *out, size_t size, const char *rec, size_t len)
+{
+    return latency_stamp_at(out, size, rec, len, latency_now_ns());
+}
+
+/*****************************************************************************
+* Function   : latency_stamp_at
+* Description: (Ŭ̾Ʈ) ڵ տ  ð ٿ out 
+*                 ۽ ð   ۽ ð 
+*              (۽ и ð     coordinated omission )
+* Returns    :  , out  0
+*****************************************************************************/
+size_t latency_stamp_at(char *out, size_t size, const char *rec, size_t len, uint64_t now)
+{
+    static const char hex[] = "0123456789abcdef";
+    int i;
+
+    if (size < LATENCY_STAMP_LEN + len)
+        return 0;
+
+    out[0] = '@';
+    for (i = 16; i >= 1; i--)
+    {
+        out[i] = hex[now & 0xF];
+        now >>= 4;
+    }
+    out[LATENCY_STAMP_LEN - 1] = ' ';
+    memcpy(out + LATENCY_STAMP_LEN, rec, len);
+
+    return LATENCY_STAMP_LEN + len;
+}
+
+/*****************************************************************************
+* Function   : latency_parse
+* Description: () ڵ  ۽ ð ؼ
+* Returns    : 1 (ð ), 0 (ǥ  ڵ)
+*****************************************************************************/
+int latency_parse(const unsigned char *rec, size_t len, uint64_t *sent_ns)
+{
+    uint64_t v = 0;
+    int i, d;
+
+    if (len < LATENCY_STAMP_LEN || rec[0] != '@' || rec[LATENCY_STAMP_LEN - 1] != ' ')
+        return 0;
+
+    for (i = 1; i <= 16; i++)
+    {
+        if (rec[i] >= '0' && rec[i] <= '9')
+            d = rec[i] - '0';
+        else if (rec[i] >= 'a' && rec[i] <= 'f')
+            d = rec[i] - 'a' + 10;
+        else
+            return 0;
+        v = (v << 4) | d;
+    }
+
+    *sent_ns = v;
+    return 1;
+}
+
+/*****************************************************************************
+* Function   : hdr_index / hdr_value
+* Description:   ĭ ȣ ȯ
+*               < 128 ĭ ϳ  ϳ,   ֻ Ʈ Ʒ 6Ʈ ĭ 
+*****************************************************************************/
+static int hdr_index(uint64_t v)
+{
+    int shift = 0;
+
+    if (v >= (1ULL << HDR_MAX_BITS))
+        v = (1ULL << HDR_MAX_BITS) - 1;
+
+    if (v < HDR_SUB_COUNT)
+        return (int)v;
+
+    shift = (63 - __builtin_clzll(v)) - (HDR_SUB_BITS - 1);
+    return shift * HDR_HALF_COUNT + (int)(v >> shift);
+}
+
+static uint64_t hdr_value(int idx)
+{
+    int shift = 0;
+
+    if (idx < HDR_SUB_COUNT)
+        return (uint64_t)idx;
+
+    // ĭ   ִ  ū  (   ۰  ʵ)
+    shift = idx / HDR_HALF_COUNT - 1;
+    return (((uint64_t)(idx % HDR_HALF_COUNT + HDR_HALF_COUNT) + 1) << shift) - 1;
+}
+
+/*****************************************************************************
+* Function   : hdr_init
+* Description: ׷ ʱȭ
+*****************************************************************************/
+void hdr_init(struct hdr_hist *h)
+{
+    memset(h, 0, sizeof(*h));
+    h->min = UINT64_MAX;
+}
+
+/*****************************************************************************
+* Function   : hdr_record
+* Description:  1  (O(1), /Ž )
+*****************************************************************************/
+void hdr_record(struct hdr_hist *h, uint64_t value)
+{
+    h->buckets[hdr_index(value)]++;
+    h->count++;
+    if (value < h->min)
+        h->min = value;
+    if (value > h->max)
+        h->max = value;
+}
+
+/*****************************************************************************
+* Function   : hdr_percentile
+* Description:   (p: 0 ~ 100). ִ  ʵ 
+*****************************************************************************/
+uint64_t hdr_percentile(const struct hdr_hist *h, double p)
+{
+    uint64_t target = 0;
+    uint64_t seen = 0;
+    uint64_t v = 0;
+    int i;
+
+    if (h->count == 0)
+        return 0;
+
+    target = (uint64_t)(p / 100.0 * h->count + 0.5);
+    if (target < 1)
+        target = 1;
+    if (target > h->count)
+        target = h->count;
+
+    for (i = 0; i < HDR_BUCKETS; i++)
+    {
+        seen += h->buckets[i];
+        if (seen >= target)
+        {
+            v = hdr_value(i);
+            return v < h->max ? v : h->max;
+        }
+    }
+
+    return h->max;
+}
+
+/*****************************************************************************
+* Function   : hdr_print
+* Description: p50/p90/p99/p99.9/max    ( us)
+*****************************************************************************/
+void hdr_print(const struct hdr_hist *h, const char *label, FILE *out)
+{
+    if (h->count == 0)
+        return;
+
+    fprintf(out, "[LATENCY] %s p50 %.1f, p90 %.1f, p99 %.1f, p99.9 %.1f, max %.1f us (%llu)\n",
+            label,
+            hdr_percentile(h, 50.0) / 1000.0, hdr_percentile(h, 90.0) / 1000.0,
+            hdr_percentile(h, 99.0) / 1000.0, hdr_percentile(h, 99.9) / 1000.0,
+            h->max / 1000.0, (unsigned long long)h->count);
+}
+
+/*****************************************************************************
+* Function   : hdr_format_prometheus
+* Description: summary   ( )
+* Returns    :  
+*****************************************************************************/
+size_t hdr_format_prometheus(const struct hdr_hist *h, const char *name, char *buf, size_t size)
+{
+    static const double quantiles[] = { 50.0, 90.0, 99.0, 99.9, 100.0 };
+    size_t len = 0;
+    int i;
+
+    len += snprintf(buf + len, size - len, "# TYPE %s summary\n", name);
+    for (i = 0; i < 5 && len < size; i++)
+    {
+        len += snprintf(buf + len, size - len, "%s{quantile=\"%g\"} %.9f\n", name, quantiles[i] / 100.0,
+                        (quantiles[i] < 100.0 ? hdr_percentile(h, quantiles[i]) : h->max) / 1e9);
+    }
+    if (len < size)
+        len += snprintf(buf + len, size - len, "%s_count %llu\n", name, (unsigned long long)h->count);
+
+    return len < size ? len : size - 1;
+}
@@ -0,0 +1,48 @@
+/*****************************************************************************
+* File       : latency.h
+* Description: ڵ     
+*              - Ŭ̾Ʈ: ڵ տ CLOCK_MONOTONIC ۽ ð  ("@16ڸ hex ")
+*              - : ڵ/ ϼ ð ̸ HDR ׷ 
+*              (CLOCK_MONOTONIC ȣƮ ü  ð̹Ƿ  ȣƮ ࿡ ȿ)
+*****************************************************************************/
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#define LATENCY_STAMP_LEN   18          // '@' + 16ڸ hex + ' '
+
+#define HDR_SUB_BITS        7           //  128ĭ    1% ̸ (ȿ  2ڸ)
+#define HDR_SUB_COUNT       (1 << HDR_SUB_BITS)
+#define HDR_HALF_COUNT      (HDR_SUB_COUNT / 2)
+#define HDR_MAX_BITS        40          //   2^40 ns ( 18),   
+#define HDR_BUCKETS         ((HDR_MAX_BITS - HDR_SUB_BITS + 2) * HDR_HALF_COUNT)
+
+/*****************************************************************************
+* Structure  : hdr_hist
+* Description: α-  ׷ (  ns)
+*              2 ŵ    ĭ ξ  ü   
+*****************************************************************************/
+struct hdr_hist
+{
+    uint64_t count;
+    uint64_t min;
+    uint64_t max;
+    uint32_t buckets[HDR_BUCKETS];
+};
+
+uint64_t latency_now_ns(void);
+size_t latency_stamp(char *out, size_t size, const char *rec, size_t len);
+size_t latency_stamp_at(char *out, size_t size, const char *rec, size_t len, uint64_t now);
+int latency_parse(const unsigned char *rec, size_t len, uint64_t *sent_ns);
+
+void hdr_init(struct hdr_hist *h);
+void hdr_record(struct hdr_hist *h, uint64_t value);
+uint64_t hdr_percentile(const struct hdr_hist *h, double p);
+void hdr_print(const struct hdr_hist *h, const char *label, FILE *out);
+size_t hdr_format_prometheus(const struct hdr_hist *h, const char *name, char *buf, size_t size);
+
+#endif
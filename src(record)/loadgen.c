@@ -0,0 +1,587 @@
+/*****************************************************************************
+* File       : loadgen.c
+* Description:  (open-loop) ӵ   
+*              ٸ Ŭ̾Ʈ send() ϴ ŭ ִ  Ƿ ִ ó ̰,
+*               ʾ ۽ŵ   ׵ ¾  ڵ   
+*              (coordinated omission).   ǥ ӵ   ð   
+*               ڵ忡  ۽ ð ƴ  ۽ ð 
+*              - ӵ: --rate ڵ/ Ǵ --bytes-rate Ʈ/ (ū Ŷ,   
+*                ó и ڵ带 ٷ   и ð  ״ )
+*              - : raw (\n   TCP) / ws (  ŷ ) / lws (libwebsockets)
+*              -  --latency:  ۽ ð    (  )
+*              - Ŭ̾Ʈ:  ۽ ð  ۽ Ϸ (۽ ,    )
+*              libwebsockets  Ϸ -DNO_LWS (lws  )
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/socket.h>
+#include "tls_offload.h"
+#include "transport.h"
+#include "tune.h"
+#include "latency.h"
+#include "probes.h"
+#include "client_report.h"
+#include "ws_proto.h"
+#ifndef NO_LWS
+#include <libwebsockets.h>
+#endif
+
+#define MODE_RAW        0
+#define MODE_WS         1
+#define MODE_LWS        2
+
+#define REC_MAX         65536           // ڵ ִ  (ð ǥ,  ٲ )
+#define BATCH_MAX       256             // ó      ִ ڵ 
+#define BUF_SIZE        1024
+
+/*****************************************************************************
+* Structure  : pacer
+* Description:  ð ۽ 
+*              i° ڵ  ð =  ð + ռ   / ǥ ӵ
+*              (ۺ  ū =  ð  ӵ, ڵ 1 1 Ǵ ̸ŭ ū .
+*               ð  ϹǷ    )
+*****************************************************************************/
+struct pacer
+{
+    uint64_t start_ns;
+    uint64_t end_ns;
+    double ns_per_unit;         // 1e9 / ǥ ӵ
+    int by_bytes;               // 1̸ Ʈ/, 0̸ ڵ/
+    uint64_t units;             // ݱ    (ڵ  Ǵ Ʈ)
+};
+
+/*****************************************************************************
+* Structure  : loadgen
+* Description:   
+*****************************************************************************/
+struct loadgen
+{
+    int mode;
+    struct pacer pacer;
+    char body[REC_MAX];         // ð ǥ   ( ٲ )
+    size_t body_len;
+    size_t rec_len;             // ð ǥ + 
+    struct hdr_hist lag;        //  ۽ ð  ۽ Ϸ
+    uint64_t max_behind_ns;     // ۽      ó ð
+    uint64_t payload_bytes;     //    ڵ Ʈ
+    struct client_report report;
+};
+
+/*****************************************************************************
+* Function   : pacer_start / pacer_due / pacer_take
+* Description:  ,  ڵ  ð, ڵ 1  ݿ
+*****************************************************************************/
+static void pacer_start(struct pacer *p, double duration_s)
+{
+    p->start_ns = latency_now_ns();
+    p->end_ns = p->start_ns + (uint64_t)(duration_s * 1e9);
+    p->units = 0;
+}
+
+static uint64_t pacer_due(const struct pacer *p)
+{
+    return p->start_ns + (uint64_t)(p->units * p->ns_per_unit);
+}
+
+static void pacer_take(struct pacer *p, size_t rec_len)
+{
+    p->units += p->by_bytes ? rec_len : 1;
+}
+
+/*****************************************************************************
+* Function   : sleep_until
+* Description: CLOCK_MONOTONIC  ð  (ñ׳η  ٽ )
+*****************************************************************************/
+static void sleep_until(uint64_t ns)
+{
+    struct timespec ts;
+
+    ts.tv_sec = ns / 1000000000ULL;
+    ts.tv_nsec = ns % 1000000000ULL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
+/*****************************************************************************
+* Function   : parse_rate
+* Description: ӵ ڿ ؼ (k / m / g ̻, 1000 )
+* Returns    : ʴ ,   0
+*****************************************************************************/
+static double parse_rate(const char *s)
+{
+    char *end = NULL;
+    double v = strtod(s, &end);
+
+    if (end == s || v < 0)
+        return 0;
+
+    switch (*end)
+    {
+        case 'k': case 'K': v *= 1e3; break;
+        case 'm': case 'M': v *= 1e6; break;
+        case 'g': case 'G': v *= 1e9; break;
+        case '\0': break;
+        default: return 0;
+    }
+
+    return v;
+}
+
+/*****************************************************************************
+* Function   : ws_handshake
+* Description: WebSocket ڵũ û  101  Ȯ ()
+* Returns    : 0 (), -1 ()
+*****************************************************************************/
+static int ws_handshake(int sock)
+{
+    char buffer[BUF_SIZE];
+    char request[BUF_SIZE];
+    int received = 0;
+
+    snprintf(request, sizeof(request),
+             "GET / HTTP/1.1\r\n"
+             "Host: 127.0.0.1:8331\r\n"
+             "Upgrade: websocket\r\n"
+             "Connection: Upgrade\r\n"
+             "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+             "Sec-WebSocket-Version: 13\r\n\r\n");
+
+    if (tls_send(NULL, sock, request, strlen(request)) < 0)
+    {
+        perror("Handshake request  ");
+        return -1;
+    }
+
+    received = tls_recv(NULL, sock, buffer, sizeof(buffer) - 1);
+    if (received <= 0)
+    {
+        perror("Handshake   ");
+        return -1;
+    }
+    buffer[received] = '\0';
+
+    if (strstr(buffer, " 101") == NULL)
+    {
+        fprintf(stderr, "Handshake :\n%s\n", buffer);
+        return -1;
+    }
+
+    PROBE2(handshake_done, sock, PROBE_HS_WS);
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : run_socket
+* Description: raw / ws  ۽  (ŷ )
+*               ð ٰ,  ð и ڵ带     
+*                send()    ð  Ƿ и ŭ  Ŀ
+* Returns    : 0 (), -1 ( )
+*****************************************************************************/
+static int run_socket(struct loadgen *lg, int sock, double duration_s)
+{
+    struct send_batch batch;
+    struct pacer *p = &lg->pacer;
+    char rec[REC_MAX];
+    uint64_t dues[BATCH_MAX];
+    unsigned char *ws_frame = NULL;
+    size_t frame_len = 0;
+    size_t len = 0;
+    uint64_t due = 0;
+    uint64_t now = 0;
+    int n = 0;
+    int i = 0;
+    int result = 0;
+
+    if (send_batch_init(&batch, g_tune.write_chunk) < 0)
+    {
+        perror("޸ Ҵ ");
+        return -1;
+    }
+
+    pacer_start(p, duration_s);
+
+    while ((due = pacer_due(p)) < p->end_ns)
+    {
+        now = latency_now_ns();
+        if (due > now)
+        {
+            sleep_until(due);
+            now = latency_now_ns();
+        }
+        if (now - due > lg->max_behind_ns)
+            lg->max_behind_ns = now - due;
+
+        // ݱ  ڵ带    ( ũ⸦  send_batch_put  )
+        for (n = 0; n < BATCH_MAX && (due = pacer_due(p)) <= now && due < p->end_ns; n++)
+        {
+            len = latency_stamp_at(rec, sizeof(rec), lg->body, lg->body_len, due);
+            if (lg->mode == MODE_WS)
+            {
+                ws_frame = create_ws_frame_masked((unsigned char *)rec, len, &frame_len);
+                if (!ws_frame)
+                {
+                    fprintf(stderr, "WebSocket   \n");
+                    result = -1;
+                    break;
+                }
+                lg->report.allocs++;
+                result = send_batch_put(&batch, NULL, sock, ws_frame, frame_len) < 0 ? -1 : 0;
+                free(ws_frame);
+            }
+            else
+            {
+                result = send_batch_put(&batch, NULL, sock, rec, len) < 0 ? -1 : 0;
+            }
+            if (result < 0)
+                break;
+
+            dues[n] = due;
+            lg->payload_bytes += len;
+            pacer_take(p, len);
+        }
+
+        if (result < 0 || send_batch_flush(&batch, NULL, sock) < 0)
+        {
+            perror("ڵ  ");
+            result = -1;
+            break;
+        }
+
+        now = latency_now_ns();
+        for (i = 0; i < n; i++)
+            hdr_record(&lg->lag, now - dues[i]);
+    }
+
+    lg->report.bytes = batch.sent_bytes;
+    lg->report.records = batch.sent_records;
+    lg->report.frames = lg->mode == MODE_WS ? batch.sent_records : 0;
+    lg->report.send_calls = batch.send_calls;
+    lg->report.partial_writes = batch.partial_writes;
+    send_batch_free(&batch);
+
+    return result;
+}
+
+#ifndef NO_LWS
+static struct loadgen *g_lg = NULL;
+static double g_duration_s = 0.0;
+static int g_lws_done = 0;
+static int g_lws_failed = 0;
+static int g_is_tcp = 1;
+
+/*****************************************************************************
+* Function   : callback_loadgen
+* Description: lws  ݹ
+*              WRITEABLE  ð  ڵ 1 lws_write  ٽ ⸦ û,
+*               ̸  ð TIMER   û (lws_write ݹ 1ȸ )
+*****************************************************************************/
+static int callback_loadgen(struct lws *wsi, enum lws_callback_reasons reason,
+                            void *user, void *in, size_t len)
+{
+    static unsigned char buf[LWS_PRE + REC_MAX];
+    struct loadgen *lg = g_lg;
+    struct pacer *p = &lg->pacer;
+    uint64_t due = 0;
+    uint64_t now = 0;
+    size_t n = 0;
+    int m = 0;
+
+    switch (reason)
+    {
+        case LWS_CALLBACK_CLIENT_ESTABLISHED:
+            tune_apply_socket(&g_tune, lws_get_socket_fd(wsi), g_is_tcp);
+            PROBE2(handshake_done, lws_get_socket_fd(wsi), PROBE_HS_WS);
+            pacer_start(p, g_duration_s);
+            lws_callback_on_writable(wsi);
+            break;
+
+        case LWS_CALLBACK_TIMER:
+            lws_callback_on_writable(wsi);
+            break;
+
+        case LWS_CALLBACK_CLIENT_WRITEABLE:
+            due = pacer_due(p);
+            if (due >= p->end_ns)
+            {
+                lws_close_reason(wsi, LWS_CLOSE_STATUS_NORMAL, NULL, 0);
+                return -1;
+            }
+
+            now = latency_now_ns();
+            if (due > now)
+            {
+                lws_set_timer_usecs(wsi, (lws_usec_t)((due - now) / 1000 + 1));
+                break;
+            }
+            if (now - due > lg->max_behind_ns)
+                lg->max_behind_ns = now - due;
+
+            n = latency_stamp_at((char *)buf + LWS_PRE, REC_MAX, lg->body, lg->body_len, due);
+            m = lws_write(wsi, buf + LWS_PRE, n, LWS_WRITE_TEXT);
+            if (m < (int)n)
+            {
+                fprintf(stderr, "[ERROR] LOADGEN: lws_write  (%d / %zu)\n", m, n);
+                g_lws_failed = 1;
+                return -1;
+            }
+
+            hdr_record(&lg->lag, latency_now_ns() - due);
+            lg->report.bytes += m;
+            lg->report.records++;
+            lg->report.frames++;
+            lg->report.send_calls++;
+            lg->payload_bytes += n;
+            pacer_take(p, n);
+
+            lws_callback_on_writable(wsi);
+            break;
+
+        case LWS_CALLBACK_CLIENT_CONNECTION_ERROR:
+            fprintf(stderr, "[ERROR] LOADGEN:  : %s\n", in ? (char *)in : "(null)");
+            g_lws_failed = 1;
+            g_lws_done = 1;
+            break;
+
+        case LWS_CALLBACK_CLIENT_CLOSED:
+            g_lws_done = 1;
+            break;
+
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+static struct lws_protocols protocols[] = {
+    { "file-transfer", callback_loadgen, 0, 0 },
+    { NULL, NULL, 0, 0 }
+};
+
+/*****************************************************************************
+* Function   : run_lws
+* Description: lws  ۽ (libwebsockets ̺Ʈ )
+* Returns    : 0 (), -1 (/ )
+*****************************************************************************/
+static int run_lws(struct loadgen *lg, const char *unix_path, double duration_s)
+{
+    struct lws_context_creation_info info;
+    struct lws_client_connect_info ccinfo;
+    struct lws_context *ctx = NULL;
+    char unix_address[128];
+
+    g_lg = lg;
+    g_duration_s = duration_s;
+
+    memset(&info, 0, sizeof(info));
+    memset(&ccinfo, 0, sizeof(ccinfo));
+    info.port = CONTEXT_PORT_NO_LISTEN;
+    info.protocols = protocols;
+
+    ctx = lws_create_context(&info);
+    if (!ctx)
+    {
+        fprintf(stderr, "LOADGEN: context  \n");
+        return -1;
+    }
+
+    ccinfo.context = ctx;
+    ccinfo.address = "127.0.0.1";
+    ccinfo.port = 8331;
+    if (unix_path != NULL)
+    {
+        // libwebsockets '+' ϴ ּҸ Unix   η ؼ
+        snprintf(unix_address, sizeof(unix_address), "+%s", unix_path);
+        ccinfo.address = unix_address;
+        ccinfo.port = 0;
+        g_is_tcp = 0;
+    }
+    ccinfo.path = "/";
+    ccinfo.host = lws_canonical_hostname(ctx);
+    ccinfo.origin = "origin";
+    ccinfo.protocol = "file-transfer";
+
+    if (!lws_client_connect_via_info(&ccinfo))
+    {
+        fprintf(stderr, "LOADGEN:   \n");
+        lws_context_destroy(ctx);
+        return -1;
+    }
+
+    while (!g_lws_done)
+    {
+        if (lws_service(ctx, 100) < 0)
+            break;
+    }
+
+    lws_context_destroy(ctx);
+    return g_lws_failed ? -1 : 0;
+}
+#endif
+
+/*****************************************************************************
+* Function   : print_result
+* Description: ǥ/޼ ӵ ۽   (--json̸ ġũ ũƮ JSON  )
+*****************************************************************************/
+static void print_result(const struct loadgen *lg, double rate, double elapsed, int json, FILE *out)
+{
+    const char *mode_name[] = { "raw", "ws", "lws" };
+    const struct hdr_hist *h = &lg->lag;
+    double rps = elapsed > 0 ? lg->report.records / elapsed : 0.0;
+    double mbps = elapsed > 0 ? lg->payload_bytes / 1048576.0 / elapsed : 0.0;
+
+    if (json)
+    {
+        fprintf(out, "{\"loadgen\":\"%s\",\"target\":%.1f,\"unit\":\"%s\",\"rec_len\":%zu,"
+                "\"elapsed_s\":%.6f,\"records\":%llu,\"payload_bytes\":%llu,"
+                "\"achieved_rps\":%.1f,\"achieved_mb_per_s\":%.3f,\"max_behind_us\":%.1f,"
+                "\"lag_p50_us\":%.1f,\"lag_p90_us\":%.1f,\"lag_p99_us\":%.1f,"
+                "\"lag_p999_us\":%.1f,\"lag_max_us\":%.1f}\n",
+                mode_name[lg->mode], rate, lg->pacer.by_bytes ? "bytes" : "records", lg->rec_len,
+                elapsed, (unsigned long long)lg->report.records,
+                (unsigned long long)lg->payload_bytes, rps, mbps, lg->max_behind_ns / 1000.0,
+                hdr_percentile(h, 50.0) / 1000.0, hdr_percentile(h, 90.0) / 1000.0,
+                hdr_percentile(h, 99.0) / 1000.0, hdr_percentile(h, 99.9) / 1000.0,
+                h->max / 1000.0);
+        fflush(out);
+        return;
+    }
+
+    fprintf(out, "[LOADGEN] %s ǥ %.1f %s/, ޼ %.1f ڵ/ (%.2f MB/s), %.3f , "
+            "  ִ %.1f us ó\n",
+            mode_name[lg->mode], rate, lg->pacer.by_bytes ? "Ʈ" : "ڵ", rps, mbps,
+            elapsed, lg->max_behind_ns / 1000.0);
+    hdr_print(h, "۽( ð )", out);
+}
+
+/*****************************************************************************
+* Function   : main
+* Description: ǥ ӵ --duration  ռ ڵ带  /޼ ӵ 
+* Returns    : 0 ( ), -1 ( ߻ )
+*****************************************************************************/
+int main(int argc, char *argv[])
+{
+    static struct loadgen lg;
+    double rate = 0.0;
+    double duration_s = 10.0;
+    size_t rec_len = 110;
+    const char *unix_path = NULL;
+    int json = 0;
+    int sock = -1;
+    int result = 0;
+    uint64_t now = 0;
+    size_t i;
+    int c;
+    static struct option long_options[] = {
+        { "rate",       required_argument, NULL, 'r' },
+        { "bytes-rate", required_argument, NULL, 'b' },
+        { "duration",   required_argument, NULL, 'd' },
+        { "size",       required_argument, NULL, 's' },
+        { "mode",       required_argument, NULL, 'm' },
+        { "unix",       required_argument, NULL, 'u' },
+        { "json",       no_argument,       NULL, 'j' },
+        TUNE_LONG_OPTIONS,
+        { NULL, 0, NULL, 0 }
+    };
+
+    while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1)
+    {
+        int r = tune_option(c, optarg);
+        if (r < 0)
+            return -1;
+        if (r > 0)
+            continue;
+
+        switch (c)
+        {
+            case 'r': rate = parse_rate(optarg); lg.pacer.by_bytes = 0; break;
+            case 'b': rate = parse_rate(optarg); lg.pacer.by_bytes = 1; break;
+            case 'd': duration_s = atof(optarg); break;
+            case 's': rec_len = strtoul(optarg, NULL, 10); break;
+            case 'u': unix_path = optarg; break;
+            case 'j': json = 1; break;
+            case 'm':
+                if (strcmp(optarg, "raw") == 0)         lg.mode = MODE_RAW;
+                else if (strcmp(optarg, "ws") == 0)     lg.mode = MODE_WS;
+                else if (strcmp(optarg, "lws") == 0)    lg.mode = MODE_LWS;
+                else lg.mode = -1;
+                break;
+            default: lg.mode = -1; break;
+        }
+    }
+
+#ifdef NO_LWS
+    if (lg.mode == MODE_LWS)
+    {
+        fprintf(stderr, "lws  libwebsockets 忡  (-DNO_LWS )\n");
+        return -1;
+    }
+#endif
+
+    if (rate <= 0 || duration_s <= 0 || lg.mode < 0 || optind != argc ||
+        rec_len < LATENCY_STAMP_LEN + 1 || rec_len > REC_MAX)
+    {
+        fprintf(stderr, ": %s --rate ڵ/ | --bytes-rate Ʈ/ (k/m/g ̻) [--duration ] [--size ڵ Ʈ]\n"
+                        "       [--mode raw|ws|lws] [--unix ] [--json] %s\n"
+                        "       ڵ ũ ۽ ð ǥ(%d Ʈ)  ٲ , %d ~ %d\n",
+                argv[0], TUNE_USAGE, LATENCY_STAMP_LEN, LATENCY_STAMP_LEN + 1, REC_MAX);
+        return -1;
+    }
+
+    // : ð ǥ ڸ ä μ   +  ٲ
+    lg.rec_len = rec_len;
+    lg.body_len = rec_len - LATENCY_STAMP_LEN;
+    for (i = 0; i + 1 < lg.body_len; i++)
+        lg.body[i] = "abcdefghijklmnopqrstuvwxyz0123456789"[i % 36];
+    lg.body[lg.body_len - 1] = '\n';
+    lg.pacer.ns_per_unit = 1e9 / rate;
+    hdr_init(&lg.lag);
+
+    client_report_start(&lg.report, "loadgen", unix_path ? "unix" : "tcp", 0);
+
+    if (lg.mode == MODE_LWS)
+    {
+#ifndef NO_LWS
+        result = run_lws(&lg, unix_path, duration_s);
+#endif
+    }
+    else
+    {
+        if (unix_path != NULL)
+            sock = transport_connect_unix(unix_path, SOCK_STREAM);
+        else
+            sock = transport_connect_tcp("127.0.0.1", 8331);
+        if (sock < 0)
+            return -1;
+
+        if (lg.mode == MODE_WS && ws_handshake(sock) < 0)
+        {
+            close(sock);
+            return -1;
+        }
+
+        result = run_socket(&lg, sock, duration_s);
+        PROBE3(conn_close, sock, lg.report.bytes, lg.report.records);
+        close(sock);
+    }
+
+    // ޼ ӵ  ü   ( ڵ尡  ð    и)
+    //     ۵ 
+    if (lg.pacer.start_ns != 0)
+    {
+        now = latency_now_ns();
+        print_result(&lg, rate, ((now > lg.pacer.end_ns ? now : lg.pacer.end_ns) - lg.pacer.start_ns) / 1e9,
+                     json, stdout);
+    }
+    if (!json)
+        client_report_print(&lg.report, 0, stdout);
+
+    return result;
+}
@@ -0,0 +1,106 @@
+/*****************************************************************************
+* File       : metrics.c
+* Description: 庰 ī    Prometheus ؽƮ  
+*****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "metrics.h"
+
+static struct metrics_shard g_shards[METRICS_MAX_THREADS];
+static int g_shard_count = 0;
+
+//   尡 ص ϵ  带  
+__thread struct metrics_shard *t_metrics = &g_shards[METRICS_MAX_THREADS - 1];
+
+static const struct
+{
+    const char *name;
+    const char *help;
+} g_counter_info[METRIC_COUNTERS] =
+{
+    { "ingest_bytes_in_total",          "Bytes received including handshakes and frame headers" },
+    { "ingest_records_in_total",        "Records received" },
+    { "ingest_frames_in_total",         "WebSocket data frames received" },
+    { "ingest_ws_handshakes_total",     "Completed WebSocket upgrades" },
+    { "ingest_tls_handshakes_total",    "Completed TLS handshakes" },
+    { "ingest_decode_errors_total",     "WebSocket frame or handshake decode errors" },
+    { "ingest_overflow_aborts_total",   "Receives aborted because the frame buffer was full" },
+    { "ingest_reallocs_total",          "Per-connection data buffer reallocations" },
+    { "ingest_connections_total",       "Connections registered" },
+    { "ingest_scrapes_total",           "Metrics endpoint requests" },
+    { "ingest_tcp_retrans_total",       "TCP segments retransmitted (TCP_INFO samples)" },
+    { "ingest_tcp_rcv_ooo_packets_total", "TCP packets received out of order (TCP_INFO samples)" },
+    { "ingest_tcp_busy_microseconds_total", "Time TCP had data to send (TCP_INFO samples)" },
+    { "ingest_tcp_rwnd_limited_microseconds_total", "Send time limited by the peer receive window" },
+    { "ingest_tcp_sndbuf_limited_microseconds_total", "Send time limited by the send buffer" },
+};
+
+static const char *g_proto_names[METRIC_PROTOS] = { "unknown", "raw", "ws", "seqpacket", "shm" };
+
+/*****************************************************************************
+* Function   : metrics_register_thread
+* Description: ȣ 忡   Ҵ (̺Ʈ     )
+* Returns    :   (尡 ϸ  带 )
+*****************************************************************************/
+struct metrics_shard* metrics_register_thread(void)
+{
+    int idx = __atomic_fetch_add(&g_shard_count, 1, __ATOMIC_RELAXED);
+
+    if (idx < METRICS_MAX_THREADS - 1)
+        t_metrics = &g_shards[idx];
+
+    return t_metrics;
+}
+
+/*****************************************************************************
+* Function   : metrics_format
+* Description:  带 ջ Prometheus ؽƮ  
+* Returns    :   (۰ ϸ ߸)
+*****************************************************************************/
+size_t metrics_format(char *buf, size_t size)
+{
+    uint64_t counter[METRIC_COUNTERS];
+    int64_t active[METRIC_PROTOS];
+    int64_t tls_active = 0;
+    int64_t buffer_bytes = 0;
+    size_t len = 0;
+    int i, j;
+
+    memset(counter, 0, sizeof(counter));
+    memset(active, 0, sizeof(active));
+
+    for (i = 0; i < METRICS_MAX_THREADS; i++)
+    {
+        for (j = 0; j < METRIC_COUNTERS; j++)
+            counter[j] += __atomic_load_n(&g_shards[i].counter[j], __ATOMIC_RELAXED);
+        for (j = 0; j < METRIC_PROTOS; j++)
+            active[j] += __atomic_load_n(&g_shards[i].active[j], __ATOMIC_RELAXED);
+        tls_active += __atomic_load_n(&g_shards[i].tls_active, __ATOMIC_RELAXED);
+        buffer_bytes += __atomic_load_n(&g_shards[i].buffer_bytes, __ATOMIC_RELAXED);
+    }
+
+#define APPEND(...) \
+    do { if (len < size) len += snprintf(buf + len, size - len, __VA_ARGS__); } while (0)
+
+    for (j = 0; j < METRIC_COUNTERS; j++)
+    {
+        APPEND("# HELP %s %s\n# TYPE %s counter\n%s %llu\n",
+               g_counter_info[j].name, g_counter_info[j].help, g_counter_info[j].name,
+               g_counter_info[j].name, (unsigned long long)counter[j]);
+    }
+
+    APPEND("# HELP ingest_active_connections Open connections by protocol\n"
+           "# TYPE ingest_active_connections gauge\n");
+    for (j = 0; j < METRIC_PROTOS; j++)
+        APPEND("ingest_active_connections{proto=\"%s\"} %lld\n", g_proto_names[j], (long long)active[j]);
+
+    APPEND("# HELP ingest_tls_connections Open TLS connections\n"
+           "# TYPE ingest_tls_connections gauge\ningest_tls_connections %lld\n", (long long)tls_active);
+    APPEND("# HELP ingest_buffer_bytes Per-connection receive buffer memory\n"
+           "# TYPE ingest_buffer_bytes gauge\ningest_buffer_bytes %lld\n", (long long)buffer_bytes);
+
+#undef APPEND
+
+    return len < size ? len : size - 1;
+}
@@ -0,0 +1,75 @@
+/*****************************************************************************
+* File       : metrics.h
+* Description:   ǽð ī (Prometheus ؽƮ  )
+*              帶 ĳ  ĵ 忡 ϰ, ȸ(scrape) ÿ ջ
+*              ( δ ڱ 忡 /   ϱ⸸ )
+*****************************************************************************/
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define METRICS_MAX_THREADS 16
+#define METRICS_CACHE_LINE  64
+
+//  ī
+#define METRIC_BYTES_IN         0       //  Ʈ (ڵũ/  )
+#define METRIC_RECORDS_IN       1       //  ڵ
+#define METRIC_FRAMES_IN        2       //  WebSocket  
+#define METRIC_WS_HANDSHAKES    3       // WebSocket ׷̵ Ϸ
+#define METRIC_TLS_HANDSHAKES   4       // TLS ڵũ Ϸ
+#define METRIC_DECODE_ERRORS    5       //  ڵ/ڵũ Ű 
+#define METRIC_OVERFLOW_ABORTS  6       //   ʰ ߴ
+#define METRIC_REALLOCS         7       //    Ҵ
+#define METRIC_ACCEPTED         8       // ϵ 
+#define METRIC_SCRAPES          9       // /metrics û
+#define METRIC_TCP_RETRANS      10      // TCP_INFO ǥ   ׸Ʈ 
+#define METRIC_TCP_OOOPACK      11      // TCP_INFO ǥ   ߳  Ŷ 
+#define METRIC_TCP_BUSY_US      12      // TCP_INFO ۽  ð  (us)
+#define METRIC_TCP_RWND_US      13      //      ð (us)
+#define METRIC_TCP_SNDBUF_US    14      //  ۽   ð (us)
+#define METRIC_COUNTERS         15
+
+// ݺ   ()
+#define METRIC_PROTO_UNKNOWN    0       // ù   (TCP / WS )
+#define METRIC_PROTO_RAW        1       // \n   TCP (Unix SOCK_STREAM )
+#define METRIC_PROTO_WS         2       // WebSocket
+#define METRIC_PROTO_SEQPACKET  3       // AF_UNIX SOCK_SEQPACKET
+#define METRIC_PROTO_SHM        4       //  ޸ 
+#define METRIC_PROTOS           5
+
+/*****************************************************************************
+* Structure  : metrics_shard
+* Description:  1 ī. 峢 ĳ   ʵ 
+*****************************************************************************/
+struct metrics_shard
+{
+    uint64_t counter[METRIC_COUNTERS];
+    int64_t active[METRIC_PROTOS];      // ݺ   ()
+    int64_t tls_active;                 //  TLS  
+    int64_t buffer_bytes;               // Ằ   Ҵ緮 ()
+} __attribute__((aligned(METRICS_CACHE_LINE)));
+
+extern __thread struct metrics_shard *t_metrics;
+
+struct metrics_shard* metrics_register_thread(void);
+size_t metrics_format(char *buf, size_t size);
+
+/*****************************************************************************
+* Function   : metrics_add / metrics_gauge
+* Description: ڱ  忡 ϱ.   ϳ̹Ƿ lock λ 
+*              relaxed 常  (ȸ 尡    ʵ)
+*****************************************************************************/
+static inline void metrics_add(int id, uint64_t n)
+{
+    __atomic_store_n(&t_metrics->counter[id], t_metrics->counter[id] + n, __ATOMIC_RELAXED);
+}
+
+static inline void metrics_gauge(int64_t *g, int64_t delta)
+{
+    __atomic_store_n(g, *g + delta, __ATOMIC_RELAXED);
+}
+
+#endif
@@ -0,0 +1,434 @@
+/*****************************************************************************
+* File       : microbench.c
+* Description: /۽  ٽ Լ ũκġũ
+*              decode_ws_frame / create_ws_frame_masked / count_newlines (8 B ~ 16 MB)
+*              extract_websocket_key / compute_accept_key (ڵũ 1ȸ ũ)
+*              (0) / (1 Ʈ ߳) Է¸ ns/op, GB/s 
+*              --json ؼ , --baseline   
+*              (ؼ ȣƮ/Ŀ/    . ٸ ȯ ġ  )
+*              --threshold ָ ׺  ׸    ڵ 1.  VMó  ū
+*              ȣƮ   ڵ嵵  % 鸮Ƿ, CPU /ļ  ȣƮ 
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <getopt.h>
+#include <sys/utsname.h>
+#include "ws_proto.h"
+#include "latency.h"
+
+#define MB_MAX_SIZE     (16 * 1024 * 1024)
+#define MB_FRAME_HEADER 14                  // 2 + Ȯ  8 + ũ 4
+#define MB_REPS         7                   // ݺ       ( )
+#define MB_MIN_MS       100                 // ݺ 1ȸ ּ  ð
+#define MB_MAX_RESULTS  128
+
+static const size_t g_sizes[] = { 8, 64, 512, 4096, 32768, 262144, 2097152, MB_MAX_SIZE };
+
+/*****************************************************************************
+* Structure  : mb_ctx
+* Description:  1 Է/  ( δ  ġ ݿ)
+*****************************************************************************/
+struct mb_ctx
+{
+    const unsigned char *in;
+    size_t in_len;
+    unsigned char *out;
+    size_t len;                 // ó   Ʈ (̷ε Ǵ û )
+};
+
+/*****************************************************************************
+* Structure  : mb_result
+* Description:   1
+*****************************************************************************/
+struct mb_result
+{
+    char name[32];
+    size_t size;
+    int align;
+    uint64_t iters;
+    double ns_per_op;
+    double gb_per_s;
+};
+
+/*****************************************************************************
+* Structure  : mb_env
+* Description: ؼ  ȯ   (  )
+*****************************************************************************/
+struct mb_env
+{
+    char host[65];
+    char kernel[65];
+    char machine[65];
+    long min_ms;
+    int reps;
+};
+
+static volatile size_t g_sink;              //   ʵ (ȭ ȣ  ʰ)
+
+static void op_decode(const struct mb_ctx *c)
+{
+    size_t frame_len = 0;
+
+    g_sink += decode_ws_frame(c->in, c->in_len, c->out, &frame_len) + frame_len;
+}
+
+static void op_create(const struct mb_ctx *c)
+{
+    size_t frame_len = 0;
+    unsigned char *frame = create_ws_frame_masked(c->in, c->len, &frame_len);
+
+    g_sink += frame[frame_len - 1];
+    free(frame);
+}
+
+static void op_count(const struct mb_ctx *c)
+{
+    g_sink += count_newlines(c->in, c->len);
+}
+
+static void op_extract_key(const struct mb_ctx *c)
+{
+    char *key = extract_websocket_key((const char *)c->in);
+
+    g_sink += key[0];
+    free(key);
+}
+
+static void op_accept_key(const struct mb_ctx *c)
+{
+    char *key = compute_accept_key((const char *)c->in);
+
+    g_sink += key[0];
+    free(key);
+}
+
+/*****************************************************************************
+* Function   : measure
+* Description: 1ȸ  ð min_ns ̻ ǵ ݺ Ƚ ø  reps 
+*              (ٸ μ/ļ ȭ  ȸ      )
+* Returns    :   ȸ ns/op
+*****************************************************************************/
+static double measure(void (*op)(const struct mb_ctx *), const struct mb_ctx *c, uint64_t min_ns, int reps,
+                      uint64_t *iters_out)
+{
+    uint64_t iters = 1;
+    uint64_t i = 0;
+    uint64_t start = 0;
+    uint64_t elapsed = 0;
+    double best = 0.0;
+    double ns = 0.0;
+    int rep = 0;
+
+    // ݺ Ƚ  (ù ȣ  Ʈ/ĳ  )
+    op(c);
+    while (1)
+    {
+        start = latency_now_ns();
+        for (i = 0; i < iters; i++)
+            op(c);
+        elapsed = latency_now_ns() - start;
+        if (elapsed >= min_ns)
+            break;
+        iters = elapsed > 0 && min_ns / elapsed < 16 ? iters * (min_ns / elapsed + 1) : iters * 16;
+    }
+
+    best = (double)elapsed / iters;
+    for (rep = 1; rep < reps; rep++)
+    {
+        start = latency_now_ns();
+        for (i = 0; i < iters; i++)
+            op(c);
+        ns = (double)(latency_now_ns() - start) / iters;
+        if (ns < best)
+            best = ns;
+    }
+
+    *iters_out = iters;
+    return best;
+}
+
+/*****************************************************************************
+* Function   : load_baseline
+* Description: --json  ؼ б (ù  ȯ,  1  )
+* Returns    :   ,   -1
+*****************************************************************************/
+static int load_baseline(const char *path, struct mb_env *env, struct mb_result *base, int max)
+{
+    FILE *fp = fopen(path, "r");
+    char line[512];
+    int n = 0;
+
+    if (fp == NULL)
+        return -1;
+
+    memset(env, 0, sizeof(*env));
+    if (fgets(line, sizeof(line), fp) != NULL)
+        sscanf(line, "{\"host\":\"%64[^\"]\",\"kernel\":\"%64[^\"]\",\"machine\":\"%64[^\"]\",\"min_ms\":%ld,\"reps\":%d",
+               env->host, env->kernel, env->machine, &env->min_ms, &env->reps);
+
+    while (n < max && fgets(line, sizeof(line), fp) != NULL)
+    {
+        if (sscanf(line, " {\"name\":\"%31[^\"]\",\"size\":%zu,\"align\":%d,\"iters\":%lu,\"ns_per_op\":%lf",
+                   base[n].name, &base[n].size, &base[n].align, &base[n].iters, &base[n].ns_per_op) == 5)
+            n++;
+    }
+
+    fclose(fp);
+    return n;
+}
+
+/*****************************************************************************
+* Function   : find_baseline
+* Description:  Լ/ũ/ ؼ 
+*****************************************************************************/
+static const struct mb_result* find_baseline(const struct mb_result *base, int n, const struct mb_result *r)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+        if (strcmp(base[i].name, r->name) == 0 && base[i].size == r->size && base[i].align == r->align)
+            return &base[i];
+
+    return NULL;
+}
+
+/*****************************************************************************
+* Function   : save_json
+* Description:   (ؼ  ,  1  )
+*****************************************************************************/
+static int save_json(const char *path, const struct mb_env *env, const struct mb_result *res, int n)
+{
+    FILE *fp = fopen(path, "w");
+    int i;
+
+    if (fp == NULL)
+    {
+        perror("   ");
+        return -1;
+    }
+
+    fprintf(fp, "{\"host\":\"%s\",\"kernel\":\"%s\",\"machine\":\"%s\",\"min_ms\":%ld,\"reps\":%d,\"results\":[\n",
+            env->host, env->kernel, env->machine, env->min_ms, env->reps);
+    for (i = 0; i < n; i++)
+    {
+        fprintf(fp, "  {\"name\":\"%s\",\"size\":%zu,\"align\":%d,\"iters\":%lu,\"ns_per_op\":%.3f,\"gb_per_s\":%.3f}%s\n",
+                res[i].name, res[i].size, res[i].align, (unsigned long)res[i].iters,
+                res[i].ns_per_op, res[i].gb_per_s, i + 1 < n ? "," : "");
+    }
+    fprintf(fp, "]}\n");
+
+    fclose(fp);
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : main
+* Description: Լ  ũ      ǥ , ؼ /
+* Returns    : 0 (), 1 (ؼ  ׸ ), -1 ()
+*****************************************************************************/
+int main(int argc, char *argv[])
+{
+    // ɼ
+    long min_ms = MB_MIN_MS;
+    int reps = MB_REPS;
+    double threshold = 0.0;             // 0̸ 񱳸 ϰ  
+    const char *json_path = NULL;
+    const char *baseline_path = NULL;
+    const char *filter = NULL;
+    int c;
+    static struct option long_options[] = {
+        { "min-ms",    required_argument, NULL, 'm' },
+        { "repeat",    required_argument, NULL, 'r' },
+        { "json",      required_argument, NULL, 'j' },
+        { "baseline",  required_argument, NULL, 'b' },
+        { "threshold", required_argument, NULL, 't' },
+        { "filter",    required_argument, NULL, 'f' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    //  
+    static const struct
+    {
+        const char *name;
+        void (*op)(const struct mb_ctx *);
+        int sized;              // 1̸ g_sizes ü, 0̸ ڵũ 1ȸ ũ
+    } cases[] = {
+        { "decode_ws_frame",        op_decode,      1 },
+        { "create_ws_frame_masked", op_create,      1 },
+        { "count_newlines",         op_count,       1 },
+        { "extract_websocket_key",  op_extract_key, 0 },
+        { "compute_accept_key",     op_accept_key,  0 },
+    };
+    static const char request[] =
+        "GET /chat HTTP/1.1\r\n"
+        "Host: localhost:8331\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+        "Sec-WebSocket-Version: 13\r\n\r\n";
+    static const char client_key[] = "dGhlIHNhbXBsZSBub25jZQ==";
+
+    //  (64 Ʈ ,   +1)
+    unsigned char *payload = NULL;
+    unsigned char *frame = NULL;
+    unsigned char *out = NULL;
+    unsigned char *masked = NULL;
+    size_t frame_len = 0;
+
+    // 
+    struct mb_result res[MB_MAX_RESULTS];
+    struct mb_result base[MB_MAX_RESULTS];
+    struct mb_env env;
+    struct mb_env base_env;
+    struct utsname u;
+    const struct mb_result *b = NULL;
+    struct mb_ctx ctx;
+    int nres = 0;
+    int nbase = 0;
+    int regressions = 0;
+    size_t i, k;
+    int align;
+    int nsizes = 0;
+
+    while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1)
+    {
+        switch (c)
+        {
+            case 'm': min_ms = atol(optarg); break;
+            case 'r': reps = atoi(optarg); break;
+            case 'j': json_path = optarg; break;
+            case 'b': baseline_path = optarg; break;
+            case 't': threshold = atof(optarg); break;
+            case 'f': filter = optarg; break;
+            default:
+                fprintf(stderr, ": %s [--min-ms  ð] [--repeat ݺ Ƚ] [--json  ]\n"
+                                "       [--baseline ؼ ] [--threshold  %%] [--filter Լ ̸]\n", argv[0]);
+                return -1;
+        }
+    }
+
+    if (min_ms <= 0 || reps <= 0)
+    {
+        fprintf(stderr, "--min-ms / --repeat 1 ̻\n");
+        return -1;
+    }
+
+    uname(&u);
+    memset(&env, 0, sizeof(env));
+    snprintf(env.host, sizeof(env.host), "%s", u.nodename);
+    snprintf(env.kernel, sizeof(env.kernel), "%s", u.release);
+    snprintf(env.machine, sizeof(env.machine), "%s", u.machine);
+    env.min_ms = min_ms;
+    env.reps = reps;
+
+    if (posix_memalign((void **)&payload, 64, MB_MAX_SIZE + 64) != 0 ||
+        posix_memalign((void **)&frame, 64, MB_MAX_SIZE + MB_FRAME_HEADER + 64) != 0 ||
+        posix_memalign((void **)&out, 64, MB_MAX_SIZE + 64) != 0)
+    {
+        perror("޸ Ҵ ");
+        return -1;
+    }
+
+    //  110 Ʈ ڵ   ٲ е ؽƮ
+    for (i = 0; i < MB_MAX_SIZE + 64; i++)
+        payload[i] = (i % 111 == 110) ? '\n' : (unsigned char)('a' + i % 26);
+
+    if (baseline_path != NULL && (nbase = load_baseline(baseline_path, &base_env, base, MB_MAX_RESULTS)) < 0)
+    {
+        fprintf(stderr, "ؼ  (%s),  \n", baseline_path);
+        nbase = 0;
+    }
+    else if (nbase > 0 && (strcmp(base_env.host, env.host) != 0 || strcmp(base_env.kernel, env.kernel) != 0 ||
+                           strcmp(base_env.machine, env.machine) != 0 || base_env.min_ms != env.min_ms ||
+                           base_env.reps != env.reps))
+    {
+        // ٸ ȣƮ/Ŀ̳   ġ ϸ ڵ ȭ ƴ϶ ȯ ̸ ϰ 
+        fprintf(stderr, "ؼ ȯ ٸ (%s %s %s, %ld ms x %d),  .  ȣƮ ٽ  ʿ\n",
+                base_env.host, base_env.kernel, base_env.machine, base_env.min_ms, base_env.reps);
+        nbase = 0;
+    }
+
+    nsizes = sizeof(g_sizes) / sizeof(g_sizes[0]);
+    printf("%-24s %10s %5s %12s %12s %10s%s\n", "Լ", "ũ", "", "ݺ", "ns/op", "GB/s",
+           nbase > 0 ? "   ؼ " : "");
+
+    for (k = 0; k < sizeof(cases) / sizeof(cases[0]); k++)
+    {
+        if (filter != NULL && strstr(cases[k].name, filter) == NULL)
+            continue;
+
+        for (i = 0; i < (cases[k].sized ? (size_t)nsizes : 1); i++)
+        {
+            for (align = 0; align <= 1; align++)
+            {
+                struct mb_result *r = &res[nres];
+
+                memset(&ctx, 0, sizeof(ctx));
+                ctx.out = out + align;
+                if (cases[k].op == op_decode)
+                {
+                    //  ޴ Ͱ  ŷ  ̸  
+                    masked = create_ws_frame_masked(payload, g_sizes[i], &frame_len);
+                    memcpy(frame + align, masked, frame_len);
+                    free(masked);
+                    ctx.in = frame + align;
+                    ctx.in_len = frame_len;
+                    ctx.len = g_sizes[i];
+                }
+                else if (cases[k].op == op_extract_key)
+                {
+                    memcpy(frame + align, request, sizeof(request));
+                    ctx.in = frame + align;
+                    ctx.len = sizeof(request) - 1;
+                }
+                else if (cases[k].op == op_accept_key)
+                {
+                    memcpy(frame + align, client_key, sizeof(client_key));
+                    ctx.in = frame + align;
+                    ctx.len = sizeof(client_key) - 1;
+                }
+                else
+                {
+                    ctx.in = payload + align;
+                    ctx.len = g_sizes[i];
+                }
+
+                snprintf(r->name, sizeof(r->name), "%s", cases[k].name);
+                r->size = ctx.len;
+                r->align = align;
+                r->ns_per_op = measure(cases[k].op, &ctx, (uint64_t)min_ms * 1000000ULL, reps, &r->iters);
+                r->gb_per_s = r->ns_per_op > 0 ? ctx.len / r->ns_per_op : 0.0;
+
+                printf("%-24s %10zu %5d %12lu %12.1f %10.3f", r->name, r->size, r->align,
+                       (unsigned long)r->iters, r->ns_per_op, r->gb_per_s);
+                if ((b = find_baseline(base, nbase, r)) != NULL && b->ns_per_op > 0)
+                {
+                    double delta = (r->ns_per_op / b->ns_per_op - 1.0) * 100.0;
+
+                    printf("   %+7.1f%%%s", delta, threshold > 0 && delta > threshold ? "   " : "");
+                    if (threshold > 0 && delta > threshold)
+                        regressions++;
+                }
+                printf("\n");
+                fflush(stdout);
+
+                if (++nres == MB_MAX_RESULTS)
+                    break;
+            }
+        }
+    }
+
+    if (json_path != NULL && save_json(json_path, &env, res, nres) == 0)
+        printf(" : %s\n", json_path);
+    if (nbase > 0 && threshold > 0)
+        printf("ؼ  %.0f%% Ѱ  ׸: %d\n", threshold, regressions);
+
+    free(payload);
+    free(frame);
+    free(out);
+
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,211 @@
+/*****************************************************************************
+* File       : perfctr.c
+* Description: perf_event_open ī /б  ܰ躰 cycles/byte, IPC 
+*****************************************************************************/
+
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "perfctr.h"
+
+static __thread int t_mode = PERF_MODE_NONE;
+static __thread int t_fd_cycles = -1;      // ׷ 
+static __thread int t_fd_instr = -1;
+static __thread struct perf_event_mmap_page *t_pc_cycles = NULL;
+static __thread struct perf_event_mmap_page *t_pc_instr = NULL;
+
+static const char *g_stage_names[PERF_STAGES] = { "recv", "handshake", "decode", "copy", "count" };
+static const char *g_mode_names[] = { "", "PMU (read)", "PMU (rdpmc)", "TSC" };
+
+/*****************************************************************************
+* Function   : read_tsc
+* Description: Ÿӽ ī (x86 ܿ CLOCK_MONOTONIC ns)
+*****************************************************************************/
+static inline uint64_t read_tsc(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+/*****************************************************************************
+* Function   : open_counter
+* Description:  ( CPU)   ϵ ī 
+*****************************************************************************/
+static int open_counter(uint64_t config, int group_fd)
+{
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.exclude_kernel = 1;        // perf_event_paranoid 2    ֵ  
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+/*****************************************************************************
+* Function   : map_counter
+* Description: rdpmc ī    (   NULL)
+*****************************************************************************/
+static struct perf_event_mmap_page* map_counter(int fd)
+{
+    void *p = mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, fd, 0);
+
+    if (p == MAP_FAILED)
+        return NULL;
+
+    if (!((struct perf_event_mmap_page*)p)->cap_user_rdpmc)
+    {
+        munmap(p, sysconf(_SC_PAGESIZE));
+        return NULL;
+    }
+
+    return p;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/*****************************************************************************
+* Function   : read_mapped
+* Description:   + rdpmc ī  б (Ŀ  seqlock )
+* Returns    : 1 (), 0 (īͰ  PMU ö  )
+*****************************************************************************/
+static int read_mapped(struct perf_event_mmap_page *pc, uint64_t *value)
+{
+    uint32_t seq, idx;
+    int64_t pmc;
+    uint64_t count;
+
+    do
+    {
+        seq = pc->lock;
+        __asm__ __volatile__("" ::: "memory");
+        idx = pc->index;
+        count = pc->offset;
+        if (idx == 0)
+            return 0;
+        pmc = (int64_t)__builtin_ia32_rdpmc(idx - 1);
+        pmc <<= 64 - pc->pmc_width;
+        pmc >>= 64 - pc->pmc_width;
+        count += pmc;
+        __asm__ __volatile__("" ::: "memory");
+    } while (pc->lock != seq);
+
+    *value = count;
+    return 1;
+}
+#endif
+
+/*****************************************************************************
+* Function   : perfctr_init_thread
+* Description: ȣ  ī غ (̺Ʈ     )
+* Returns    : PERF_MODE_*
+*****************************************************************************/
+int perfctr_init_thread(void)
+{
+    t_fd_cycles = open_counter(PERF_COUNT_HW_CPU_CYCLES, -1);
+    if (t_fd_cycles >= 0)
+        t_fd_instr = open_counter(PERF_COUNT_HW_INSTRUCTIONS, t_fd_cycles);
+
+    if (t_fd_cycles < 0 || t_fd_instr < 0)
+    {
+        if (t_fd_cycles >= 0)
+            close(t_fd_cycles);
+        t_fd_cycles = -1;
+        t_mode = PERF_MODE_TSC;
+        return t_mode;
+    }
+
+    ioctl(t_fd_cycles, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(t_fd_cycles, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    t_mode = PERF_MODE_PMU;
+
+#if defined(__x86_64__) || defined(__i386__)
+    t_pc_cycles = map_counter(t_fd_cycles);
+    t_pc_instr = map_counter(t_fd_instr);
+    if (t_pc_cycles != NULL && t_pc_instr != NULL)
+        t_mode = PERF_MODE_RDPMC;
+#endif
+
+    return t_mode;
+}
+
+/*****************************************************************************
+* Function   : perfctr_read
+* Description:  ī  (TSC 忡 instructions 0)
+*****************************************************************************/
+void perfctr_read(struct perf_sample *s)
+{
+    uint64_t group[3];      // nr, cycles, instructions
+
+#if defined(__x86_64__) || defined(__i386__)
+    if (t_mode == PERF_MODE_RDPMC &&
+        read_mapped(t_pc_cycles, &s->cycles) && read_mapped(t_pc_instr, &s->instructions))
+        return;
+#endif
+
+    if (t_mode == PERF_MODE_PMU || t_mode == PERF_MODE_RDPMC)
+    {
+        if (read(t_fd_cycles, group, sizeof(group)) == sizeof(group))
+        {
+            s->cycles = group[1];
+            s->instructions = group[2];
+            return;
+        }
+    }
+
+    s->cycles = read_tsc();
+    s->instructions = 0;
+}
+
+/*****************************************************************************
+* Function   : perfctr_reset
+* Description: Ằ  ʱȭ
+*****************************************************************************/
+void perfctr_reset(struct perf_stats *st)
+{
+    memset(st, 0, sizeof(*st));
+}
+
+/*****************************************************************************
+* Function   : perfctr_print
+* Description: ܰ躰 ȣ , Ʈ, Ŭ, cycles/byte, IPC 
+*****************************************************************************/
+void perfctr_print(const struct perf_stats *st, FILE *out)
+{
+    uint64_t total = 0;
+    int i;
+
+    for (i = 0; i < PERF_STAGES; i++)
+        total += st->cycles[i];
+    if (total == 0)
+        return;
+
+    fprintf(out, "[PERF] ī: %s%s\n", g_mode_names[t_mode],
+            t_mode == PERF_MODE_TSC ? " -  Ŭ Ŭ, IPC " : "");
+    for (i = 0; i < PERF_STAGES; i++)
+    {
+        if (st->calls[i] == 0)
+            continue;
+
+        fprintf(out, "[PERF] %-9s ȣ %8llu, Ʈ %12llu, Ŭ %14llu (%5.1f%%), cycles/byte %8.3f",
+                g_stage_names[i], (unsigned long long)st->calls[i], (unsigned long long)st->bytes[i],
+                (unsigned long long)st->cycles[i], 100.0 * st->cycles[i] / total,
+                st->bytes[i] ? (double)st->cycles[i] / st->bytes[i] : 0.0);
+        if (t_mode != PERF_MODE_TSC && st->cycles[i] > 0)
+            fprintf(out, ", IPC %.2f", (double)st->instructions[i] / st->cycles[i]);
+        fprintf(out, "\n");
+    }
+}
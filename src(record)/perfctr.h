@@ -0,0 +1,66 @@
+/*****************************************************************************
+* File       : perfctr.h
+* Description:   ܰ躰 Ŭ/ɾ  (--perfctr)
+*              帶 perf_event_open ϵ ī(cycles + instructions ׷) 
+*              ϸ rdpmc ý   . PMU ( ӽ ) rdtsc ü
+*****************************************************************************/
+
+#ifndef PERFCTR_H
+#define PERFCTR_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+//  ܰ
+#define PERF_STAGE_RECV       0       // recv / SSL_read
+#define PERF_STAGE_HANDSHAKE  1       // WS ׷̵ (Ű , SHA-1, base64,  )
+#define PERF_STAGE_DECODE     2       // decode_ws_frame ( ؼ + ŷ )
+#define PERF_STAGE_COPY       3       // all_data / recv_buf 
+#define PERF_STAGE_COUNT      4       //  ٲ 
+#define PERF_STAGES           5
+
+#define PERF_MODE_NONE        0       //   
+#define PERF_MODE_PMU         1       // ϵ ī (read ý )
+#define PERF_MODE_RDPMC       2       // ϵ ī (  rdpmc)
+#define PERF_MODE_TSC         3       // rdtsc (ɾ  ,  Ŭ Ŭ)
+
+/*****************************************************************************
+* Structure  : perf_sample / perf_stats
+* Description: ī   1ȸ / Ằ ܰ 
+*****************************************************************************/
+struct perf_sample
+{
+    uint64_t cycles;
+    uint64_t instructions;
+};
+
+struct perf_stats
+{
+    uint64_t cycles[PERF_STAGES];
+    uint64_t instructions[PERF_STAGES];
+    uint64_t bytes[PERF_STAGES];
+    uint64_t calls[PERF_STAGES];
+};
+
+int perfctr_init_thread(void);
+void perfctr_read(struct perf_sample *s);
+void perfctr_reset(struct perf_stats *st);
+void perfctr_print(const struct perf_stats *st, FILE *out);
+
+/*****************************************************************************
+* Function   : perfctr_add
+* Description: start   ܰ stage  (bytes:   ó Ʈ)
+*****************************************************************************/
+static inline void perfctr_add(struct perf_stats *st, int stage, const struct perf_sample *start, size_t bytes)
+{
+    struct perf_sample end;
+
+    perfctr_read(&end);
+    st->cycles[stage] += end.cycles - start->cycles;
+    st->instructions[stage] += end.instructions - start->instructions;
+    st->bytes[stage] += bytes;
+    st->calls[stage]++;
+}
+
+#endif
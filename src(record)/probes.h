@@ -0,0 +1,50 @@
+/*****************************************************************************
+* File       : probes.h
+* Description: USDT   (provider: ingest)
+*              <sys/sdt.h>(systemtap-sdt-dev)   NOP 1 ELF Ʈ 
+*              bpftrace / perf probe ٿ  ڸ .  ų NO_PROBES
+*              ϸ ƹ ڵ嵵  
+*
+*              bpftrace -e 'usdt:./server_tcpws:ingest:frame_decoded { @len = hist(arg2); }'
+*              perf probe -x ./server_tcpws sdt_ingest:buffer_grow && perf record -e sdt_ingest:buffer_grow
+*
+*                                
+*              conn_accept         (fd, transport)                   
+*              conn_connect        (fd, transport)                 Ŭ̾Ʈ  Ϸ
+*              handshake_done      (fd, kind)                      kind: PROBE_HS_WS / PROBE_HS_TLS
+*              frame_decoded       (fd, opcode, payload_len)
+*              records_counted     (fd, records, bytes)            /۽  1  ڵ 
+*              buffer_grow         (fd, old_capacity, new_capacity)
+*              backpressure        (fd, reason, arg)               reason: PROBE_BP_*
+*              conn_close          (fd, total_bytes, records)
+*****************************************************************************/
+
+#ifndef PROBES_H
+#define PROBES_H
+
+#define PROBE_HS_WS             0       // WebSocket ׷̵
+#define PROBE_HS_TLS            1       // TLS ڵũ
+
+#define PROBE_BP_RECV_FULL      0       //    ʰ (arg: ۿ  Ʈ)
+#define PROBE_BP_PENDING        1       //   ⿭  (arg: ⿭ )
+#define PROBE_BP_SHED           2       //  503  (arg: Retry-After )
+#define PROBE_BP_RING_FULL      3       // Ŭ̾Ʈ  ޸    (arg:  Ʈ)
+#define PROBE_BP_BACKOFF        4       // Ŭ̾Ʈ 503  (arg:  ms)
+
+#if !defined(NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define HAVE_USDT_PROBES 1
+#endif
+#endif
+
+#ifdef HAVE_USDT_PROBES
+#define PROBE2(name, a, b)      DTRACE_PROBE2(ingest, name, a, b)
+#define PROBE3(name, a, b, c)   DTRACE_PROBE3(ingest, name, a, b, c)
+#else
+// ڴ  ʵ   ̰  (   unused  )
+#define PROBE2(name, a, b)      do { if (0) { (void)(a); (void)(b); } } while (0)
+#define PROBE3(name, a, b, c)   do { if (0) { (void)(a); (void)(b); (void)(c); } } while (0)
+#endif
+
+#endif
@@ -0,0 +1,634 @@
+/*****************************************************************************
+* File       : replay.c
+* Description: Ŭ̾Ʈ ۽ Ʈ ĸó /   ( ܵ   )
+*              README ġ Ŭ̾Ʈ  б,  /ŷ   Ƿ
+*              Ŭ̾Ʈ  Ʈ(ڵũ + )   Ϸ  ΰ,
+*                sendfile   ״ Ͽ ־ Ŭ̾Ʈ CPU   
+*              - ĸó: --capture  --listen   Unix Ͽ  1 ޾  ߰ϸ
+*                Ŭ̾Ʈ   ⸸ Ͽ  ( Ŭ̾Ʈ --unix ϹǷ ״ )
+*              - : ĸó  --conns  ÿ , --rate Ḷ Ʈ/  
+*                WS ĸó  Ŭ̾Ʈó ڵũ û   101    
+*                    ݰ    ( ó)  о 
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "transport.h"
+#include "tune.h"
+#include "latency.h"
+#include "probes.h"
+
+#define PORT            8331
+#define RELAY_BUF_SIZE  65536
+#define CHUNK_DEFAULT   (1024 * 1024)   // sendfile 1ȸ ִ Ʈ
+#define MAX_EVENTS      256
+#define TICK_MS         10
+
+/*****************************************************************************
+* Structure  : replay_conn
+* Description:   1 
+*****************************************************************************/
+struct replay_conn
+{
+    int fd;                     // -1̸ 
+    int transport;              // TRANSPORT_TCP / TRANSPORT_UNIX ()
+    int connected;
+    int upgraded;               // WS ĸó: 101  
+    int paced;                  //  ռ EPOLLOUT  
+    off_t offset;               // ĸó Ͽ   ġ
+    uint64_t start_ns;          // connect 
+    uint64_t sent_ns;           //  Ʈ 
+    uint64_t end_ns;            //   
+    uint64_t send_calls;
+};
+
+/*****************************************************************************
+* Structure  : replay_plan
+* Description:  ĸó ϰ   (  )
+*****************************************************************************/
+struct replay_plan
+{
+    int fd;
+    off_t len;
+    off_t header_len;           // WS ڵũ û  (  ĸó 0)
+    size_t chunk;               // sendfile 1ȸ ִ Ʈ
+    double rate;                //  Ʈ/ (0̸  )
+    off_t quantum;              // --rate ּ   (ƽ Ʈ,  sendfile ݺ )
+};
+
+/*****************************************************************************
+* Function   : parse_rate
+* Description: ӵ ڿ ؼ (k / m / g ̻, 1000 )
+* Returns    : ʴ Ʈ,   0
+*****************************************************************************/
+static double parse_rate(const char *s)
+{
+    char *end = NULL;
+    double v = strtod(s, &end);
+
+    if (end == s || v < 0)
+        return 0;
+
+    switch (*end)
+    {
+        case 'k': case 'K': v *= 1e3; break;
+        case 'm': case 'M': v *= 1e6; break;
+        case 'g': case 'G': v *= 1e9; break;
+        case '\0': break;
+        default: return 0;
+    }
+
+    return v;
+}
+
+/*****************************************************************************
+* Function   : write_all
+* Description: ŷ /Ͽ len Ʈ  
+*               MSG_NOSIGNAL  (밡 ݾƵ SIGPIPE  ʰ EPIPE ȯ)
+* Returns    : 0 (), -1 ()
+*****************************************************************************/
+static int write_all(int fd, const char *buf, size_t len, int is_socket)
+{
+    ssize_t n = 0;
+
+    while (len > 0)
+    {
+        n = is_socket ? send(fd, buf, len, MSG_NOSIGNAL) : write(fd, buf, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return -1;
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : run_capture
+* Description: Unix Ͽ Ŭ̾Ʈ  1 ޾  ߰ϸ ۽ Ʈ Ͽ 
+*               (101, 503, Ϸ Ȯ) ״ Ŭ̾Ʈ ֹǷ Ŭ̾Ʈ ó 
+* Returns    : 0 (), -1 ()
+*****************************************************************************/
+static int run_capture(const char *capture_path, const char *listen_path, const char *server_unix)
+{
+    char buf[RELAY_BUF_SIZE];
+    struct pollfd fds[2];
+    uint64_t captured = 0;
+    int listen_fd = -1;
+    int client_fd = -1;
+    int server_fd = -1;
+    int out_fd = -1;
+    int client_open = 1;
+    int server_open = 1;
+    ssize_t n = 0;
+
+    listen_fd = transport_listen_unix(listen_path, SOCK_STREAM, 1);
+    if (listen_fd < 0)
+        return -1;
+
+    out_fd = open(capture_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0)
+    {
+        perror("ĸó   ");
+        close(listen_fd);
+        return -1;
+    }
+
+    printf("CAPTURE: %s  Ŭ̾Ʈ   (Ŭ̾Ʈ --unix %s)\n", listen_path, listen_path);
+    client_fd = accept(listen_fd, NULL, NULL);
+    close(listen_fd);
+    unlink(listen_path);
+    if (client_fd < 0)
+    {
+        perror("accept ");
+        close(out_fd);
+        return -1;
+    }
+
+    server_fd = server_unix ? transport_connect_unix(server_unix, SOCK_STREAM)
+                            : transport_connect_tcp("127.0.0.1", PORT);
+    if (server_fd < 0)
+    {
+        close(client_fd);
+        close(out_fd);
+        return -1;
+    }
+
+    //  ⸦  ݴʿ ϰ,    
+    while (client_open || server_open)
+    {
+        fds[0].fd = client_open ? client_fd : -1;
+        fds[0].events = POLLIN;
+        fds[1].fd = server_open ? server_fd : -1;
+        fds[1].events = POLLIN;
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("poll ");
+            break;
+        }
+
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR))
+        {
+            n = read(client_fd, buf, sizeof(buf));
+            if (n <= 0)
+            {
+                client_open = 0;
+                shutdown(server_fd, SHUT_WR);
+            }
+            else if (write_all(server_fd, buf, n, 1) < 0)
+            {
+                //    (503   )     ϰ,
+                //    Ŭ̾Ʈ   
+                printf("CAPTURE:    (%s),  Ŭ̾Ʈ ʹ  \n",
+                       strerror(errno));
+                client_open = 0;
+            }
+            else if (write_all(out_fd, buf, n, 0) < 0)
+            {
+                perror("ĸó   ");
+                break;
+            }
+            else
+            {
+                captured += n;
+            }
+        }
+
+        if (fds[1].revents & (POLLIN | POLLHUP | POLLERR))
+        {
+            n = read(server_fd, buf, sizeof(buf));
+            if (n <= 0)
+            {
+                server_open = 0;
+                shutdown(client_fd, SHUT_WR);
+            }
+            else if (write_all(client_fd, buf, n, 1) < 0)
+            {
+                // Ŭ̾Ʈ ̹      
+                server_open = 0;
+            }
+        }
+    }
+
+    close(client_fd);
+    close(server_fd);
+    if (close(out_fd) < 0)
+    {
+        perror("ĸó   ");
+        return -1;
+    }
+
+    printf("CAPTURE: %llu Ʈ   %s\n", (unsigned long long)captured, capture_path);
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : replay_open
+* Description: ŷ  , epoll 
+* Returns    : 0 (), -1 ()
+*****************************************************************************/
+static int replay_open(int epfd, struct replay_conn *c, int slot, const char *server_unix)
+{
+    struct sockaddr_in in_addr;
+    struct sockaddr_un un_addr;
+    struct epoll_event ev;
+    int r = 0;
+
+    memset(c, 0, sizeof(*c));
+    c->transport = server_unix ? TRANSPORT_UNIX : TRANSPORT_TCP;
+    c->start_ns = latency_now_ns();
+    c->fd = socket(server_unix ? AF_UNIX : AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (c->fd < 0)
+    {
+        perror("  ");
+        return -1;
+    }
+
+    tune_apply_socket(&g_tune, c->fd, server_unix == NULL);
+    if (server_unix != NULL)
+    {
+        memset(&un_addr, 0, sizeof(un_addr));
+        un_addr.sun_family = AF_UNIX;
+        strncpy(un_addr.sun_path, server_unix, sizeof(un_addr.sun_path) - 1);
+        r = connect(c->fd, (struct sockaddr *)&un_addr, sizeof(un_addr));
+    }
+    else
+    {
+        memset(&in_addr, 0, sizeof(in_addr));
+        in_addr.sin_family = AF_INET;
+        in_addr.sin_port = htons(PORT);
+        inet_pton(AF_INET, "127.0.0.1", &in_addr.sin_addr);
+        r = connect(c->fd, (struct sockaddr *)&in_addr, sizeof(in_addr));
+    }
+
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.u32 = (uint32_t)slot;
+    if ((r < 0 && errno != EINPROGRESS) || epoll_ctl(epfd, EPOLL_CTL_ADD, c->fd, &ev) < 0)
+    {
+        perror("  ");
+        close(c->fd);
+        c->fd = -1;
+        return -1;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : replay_watch
+* Description:  epoll  ̺Ʈ  (  on/off)
+*****************************************************************************/
+static void replay_watch(int epfd, struct replay_conn *c, int slot, int want_write)
+{
+    struct epoll_event ev;
+
+    ev.events = want_write ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    ev.data.u32 = (uint32_t)slot;
+    epoll_ctl(epfd, EPOLL_CTL_MOD, c->fd, &ev);
+}
+
+/*****************************************************************************
+* Function   : replay_event
+* Description:   1 epoll ̺Ʈ ó
+*               ϸ sendfile 1ȸ (--rate   ŭ, ռ EPOLLOUT ),
+*              WS ĸó ڵũ û  101  ٸ (û   
+*                Ŭ̾Ʈ ٸ  ),     ݰ
+*                  о 
+* Returns    : 0 (), 1 ( ), -1 ()
+*****************************************************************************/
+static int replay_event(int epfd, struct replay_conn *c, int slot, uint32_t events,
+                        const struct replay_plan *plan)
+{
+    char drain[RELAY_BUF_SIZE];
+    socklen_t err_len = sizeof(int);
+    uint64_t now = 0;
+    off_t allowed = plan->len;
+    off_t want = 0;
+    size_t len = 0;
+    ssize_t n = 0;
+    int err = 0;
+
+    if (!c->connected)
+    {
+        if (getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &err, &err_len) < 0 || err != 0)
+        {
+            fprintf(stderr, "  : %s\n", strerror(err));
+            return -1;
+        }
+        c->connected = 1;
+        PROBE2(conn_connect, c->fd, c->transport);
+    }
+
+    if (events & EPOLLIN)
+    {
+        n = read(c->fd, drain, sizeof(drain) - 1);
+        if (n == 0)
+        {
+            c->end_ns = latency_now_ns();
+            return c->offset == plan->len ? 1 : -1;
+        }
+        if (n < 0 && errno != EAGAIN)
+            return -1;
+
+        if (n > 0 && plan->header_len > 0 && !c->upgraded && c->offset == plan->header_len)
+        {
+            drain[n] = '\0';
+            if (strstr(drain, " 101") == NULL)
+            {
+                fprintf(stderr, "WS ڵũ : %.*s\n", (int)strcspn(drain, "\r\n"), drain);
+                return -1;
+            }
+            c->upgraded = 1;
+            replay_watch(epfd, c, slot, 1);
+        }
+    }
+
+    if ((events & EPOLLOUT) && c->offset < plan->len)
+    {
+        if (plan->header_len > 0 && !c->upgraded)
+            allowed = plan->header_len;
+
+        if (plan->rate > 0)
+        {
+            now = latency_now_ns();
+            if ((off_t)((now - c->start_ns) / 1e9 * plan->rate) < allowed)
+                allowed = (off_t)((now - c->start_ns) / 1e9 * plan->rate);
+
+            //  ռ (ƽ ۷  )     ƽ ٽ 
+            want = plan->len - c->offset < plan->quantum ? plan->len - c->offset : plan->quantum;
+            if (allowed - c->offset < want && (plan->header_len == 0 || c->upgraded))
+            {
+                c->paced = 1;
+                replay_watch(epfd, c, slot, 0);
+                return 0;
+            }
+        }
+
+        if (allowed > c->offset)
+        {
+            len = (size_t)(allowed - c->offset) < plan->chunk ? (size_t)(allowed - c->offset) : plan->chunk;
+            n = sendfile(c->fd, plan->fd, &c->offset, len);
+            if (n < 0 && errno != EAGAIN)
+            {
+                perror("sendfile ");
+                return -1;
+            }
+            if (n > 0)
+                c->send_calls++;
+        }
+
+        if (c->offset == plan->len)
+        {
+            c->sent_ns = latency_now_ns();
+            shutdown(c->fd, SHUT_WR);
+            replay_watch(epfd, c, slot, 0);
+        }
+        else if (plan->header_len > 0 && !c->upgraded && c->offset == plan->header_len)
+        {
+            // ڵũ û  Ϸ  101   
+            replay_watch(epfd, c, slot, 0);
+        }
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : run_replay
+* Description: ĸó  conns  ÿ ϰ  
+* Returns    : 0 (  Ϸ), -1 ()
+*****************************************************************************/
+static int run_replay(const char *capture_path, const char *server_unix, int conns,
+                      size_t chunk, double rate, int json)
+{
+    struct epoll_event events[MAX_EVENTS];
+    struct replay_conn *cs = NULL;
+    struct replay_plan plan;
+    struct stat st;
+    char head[4096];
+    struct rusage ru;
+    struct hdr_hist conn_time;
+    uint64_t start_ns = 0;
+    uint64_t next_tick = 0;
+    uint64_t now = 0;
+    uint64_t send_calls = 0;
+    double wall = 0.0;
+    double sent_s = 0.0;
+    int epfd = -1;
+    int active = 0;
+    int failed = 0;
+    int n = 0;
+    int i = 0;
+    int r = 0;
+
+    memset(&plan, 0, sizeof(plan));
+    plan.fd = open(capture_path, O_RDONLY);
+    if (plan.fd < 0 || fstat(plan.fd, &st) < 0 || st.st_size == 0)
+    {
+        perror("ĸó   ");
+        return -1;
+    }
+    plan.len = st.st_size;
+    plan.chunk = chunk;
+    plan.rate = rate;
+    plan.quantum = rate * TICK_MS / 1000 > 1 ? (off_t)(rate * TICK_MS / 1000) : 1;
+
+    // WS ĸó ڵũ û  ( )  
+    n = pread(plan.fd, head, sizeof(head) - 1, 0);
+    if (n > 4 && strncmp(head, "GET ", 4) == 0)
+    {
+        head[n] = '\0';
+        if (strstr(head, "\r\n\r\n") != NULL)
+            plan.header_len = strstr(head, "\r\n\r\n") + 4 - head;
+    }
+
+    cs = calloc(conns, sizeof(struct replay_conn));
+    epfd = epoll_create1(0);
+    if (cs == NULL || epfd < 0)
+    {
+        perror("ʱȭ ");
+        return -1;
+    }
+    hdr_init(&conn_time);
+
+    // ĸó  ̸  ĳÿ ÷ ù  ũ б⸦ ٸ ʰ 
+    posix_fadvise(plan.fd, 0, st.st_size, POSIX_FADV_WILLNEED);
+
+    start_ns = latency_now_ns();
+    for (i = 0; i < conns; i++)
+    {
+        if (replay_open(epfd, &cs[i], i, server_unix) < 0)
+        {
+            failed++;
+            continue;
+        }
+        active++;
+    }
+
+    next_tick = start_ns + TICK_MS * 1000000ULL;
+    while (active > 0)
+    {
+        now = latency_now_ns();
+        n = epoll_wait(epfd, events, MAX_EVENTS,
+                       rate <= 0 ? -1 : now >= next_tick ? 0 : (int)((next_tick - now + 999999) / 1000000));
+        if (n < 0 && errno != EINTR)
+        {
+            perror("epoll_wait ");
+            break;
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            struct replay_conn *c = &cs[events[i].data.u32];
+            if (c->fd < 0)
+                continue;
+            r = replay_event(epfd, c, (int)events[i].data.u32, events[i].events, &plan);
+            if (r != 0)
+            {
+                if (r > 0)
+                    hdr_record(&conn_time, c->end_ns - c->start_ns);
+                else
+                    failed++;
+                PROBE3(conn_close, c->fd, (uint64_t)c->offset, 0);
+                close(c->fd);
+                c->fd = -1;
+                active--;
+            }
+        }
+
+        // --rate: ƽ  ռ   ٽ  
+        if (rate <= 0 || latency_now_ns() < next_tick)
+            continue;
+        next_tick += TICK_MS * 1000000ULL;
+        for (i = 0; i < conns; i++)
+        {
+            if (cs[i].fd >= 0 && cs[i].paced)
+            {
+                cs[i].paced = 0;
+                replay_watch(epfd, &cs[i], i, 1);
+            }
+        }
+    }
+
+    wall = (latency_now_ns() - start_ns) / 1e9;
+    for (i = 0; i < conns; i++)
+    {
+        send_calls += cs[i].send_calls;
+        if (cs[i].sent_ns > start_ns && (cs[i].sent_ns - start_ns) / 1e9 > sent_s)
+            sent_s = (cs[i].sent_ns - start_ns) / 1e9;
+    }
+    getrusage(RUSAGE_SELF, &ru);
+
+    if (json)
+    {
+        printf("{\"client\":\"replay\",\"capture_bytes\":%lld,\"conns\":%d,\"failed\":%d,\"rate\":%.0f,"
+               "\"wall_s\":%.6f,\"sent_s\":%.6f,\"mb_per_s\":%.3f,\"send_calls\":%llu,"
+               "\"cpu_user_s\":%.6f,\"cpu_sys_s\":%.6f,\"conn_p50_ms\":%.3f,\"conn_max_ms\":%.3f}\n",
+               (long long)st.st_size, conns, failed, rate, wall, sent_s,
+               wall > 0 ? (double)st.st_size * (conns - failed) / 1048576.0 / wall : 0.0,
+               (unsigned long long)send_calls,
+               ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6, ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6,
+               hdr_percentile(&conn_time, 50.0) / 1e6, conn_time.max / 1e6);
+    }
+    else
+    {
+        printf("[REPLAY] %s %lld Ʈ   %d ( %d), ۽ Ϸ %.6f ,   %.6f , %.2f MB/s\n",
+               capture_path, (long long)st.st_size, conns, failed, sent_s, wall,
+               wall > 0 ? (double)st.st_size * (conns - failed) / 1048576.0 / wall : 0.0);
+        printf("[REPLAY] sendfile %lluȸ, CPU user %.3f / sys %.3f \n", (unsigned long long)send_calls,
+               ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6, ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6);
+        hdr_print(&conn_time, "(    )", stdout);
+    }
+
+    close(epfd);
+    close(plan.fd);
+    free(cs);
+    return failed ? -1 : 0;
+}
+
+/*****************************************************************************
+* Function   : main
+* Description: --capture ĸó ߰, ƴϸ ĸó  
+* Returns    : 0 ( ), -1 ( ߻ )
+*****************************************************************************/
+int main(int argc, char *argv[])
+{
+    const char *capture_path = NULL;
+    const char *listen_path = NULL;
+    const char *server_unix = NULL;
+    int conns = 1;
+    size_t chunk = CHUNK_DEFAULT;
+    double rate = 0.0;
+    int json = 0;
+    int bad = 0;
+    int c;
+    static struct option long_options[] = {
+        { "capture", required_argument, NULL, 'C' },
+        { "listen",  required_argument, NULL, 'l' },
+        { "unix",    required_argument, NULL, 'u' },
+        { "conns",   required_argument, NULL, 'c' },
+        { "chunk",   required_argument, NULL, 'k' },
+        { "rate",    required_argument, NULL, 'r' },
+        { "json",    no_argument,       NULL, 'j' },
+        TUNE_LONG_OPTIONS,
+        { NULL, 0, NULL, 0 }
+    };
+
+    while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1)
+    {
+        int r = tune_option(c, optarg);
+        if (r < 0)
+            return -1;
+        if (r > 0)
+            continue;
+
+        switch (c)
+        {
+            case 'C': capture_path = optarg; break;
+            case 'l': listen_path = optarg; break;
+            case 'u': server_unix = optarg; break;
+            case 'c': conns = atoi(optarg); break;
+            case 'k': chunk = (size_t)parse_rate(optarg); break;
+            case 'r': rate = parse_rate(optarg); break;
+            case 'j': json = 1; break;
+            default: bad = 1; break;
+        }
+    }
+
+    if (capture_path != NULL)
+    {
+        if (bad || listen_path == NULL || optind != argc)
+            bad = 1;
+        else
+            return run_capture(capture_path, listen_path, server_unix);
+    }
+
+    if (bad || optind != argc - 1 || conns <= 0 || chunk == 0)
+    {
+        fprintf(stderr, ": %s --capture ĸó --listen  [--unix ]\n"
+                        "       (Ŭ̾Ʈ --unix η ϸ ۽ Ʈ ĸóϿ )\n"
+                        "       %s [--conns N] [--rate Ʈ/] [--chunk Ʈ] [--unix ] [--json] %s ĸó\n",
+                argv[0], argv[0], TUNE_USAGE);
+        return -1;
+    }
+
+    return run_replay(argv[optind], server_unix, conns, chunk, rate, json);
+}
@@ -0,0 +1,81 @@
+/*****************************************************************************
+* File       : sched.c
+* Description: Deficit Round Robin  ť
+*              ť  ȣ ϰ, ߺ   ÷׿ deficit īʹ
+*              ȣ  ü 
+*****************************************************************************/
+
+#include <stdlib.h>
+#include <time.h>
+#include "sched.h"
+
+/*****************************************************************************
+* Function   : sched_init
+* Description:  ť 
+* Parameters : - int cap          : ִ  
+*              - size_t quantum   :  Ằ Ʈ quantum
+*              - long budget_us   :  1ȸ ð 
+* Returns    : 0 (), -1 (޸ )
+*****************************************************************************/
+int sched_init(struct sched *s, int cap, size_t quantum, long budget_us)
+{
+    s->ring = malloc(sizeof(int) * cap);
+    s->cap = cap;
+    s->head = 0;
+    s->count = 0;
+    s->quantum = quantum;
+    s->budget_us = budget_us;
+
+    return s->ring != NULL ? 0 : -1;
+}
+
+/*****************************************************************************
+* Function   : sched_free
+* Description:  ť 
+*****************************************************************************/
+void sched_free(struct sched *s)
+{
+    free(s->ring);
+    s->ring = NULL;
+    s->count = 0;
+}
+
+/*****************************************************************************
+* Function   : sched_push
+* Description: ť ڿ  ߰ (Ը ִ 1 Ƿ ġ )
+*****************************************************************************/
+void sched_push(struct sched *s, int slot)
+{
+    s->ring[(s->head + s->count) % s->cap] = slot;
+    s->count++;
+}
+
+/*****************************************************************************
+* Function   : sched_pop
+* Description: ť տ  
+* Returns    :  ȣ,   -1
+*****************************************************************************/
+int sched_pop(struct sched *s)
+{
+    int slot = 0;
+
+    if (s->count == 0)
+        return -1;
+
+    slot = s->ring[s->head];
+    s->head = (s->head + 1) % s->cap;
+    s->count--;
+    return slot;
+}
+
+/*****************************************************************************
+* Function   : sched_now_us
+* Description:  ð (ũ)
+*****************************************************************************/
+uint64_t sched_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
@@ -0,0 +1,37 @@
+/*****************************************************************************
+* File       : sched.h
+* Description: Ằ  ٷ (Deficit Round Robin  ť)
+*              select() б   ť ְ, 帶 Ằ
+*              quantum Ʈ / budget_us ð     ٽ ť ڿ 
+*****************************************************************************/
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SCHED_QUANTUM_DEFAULT    (64 * 1024)    //  Ằ Ʈ quantum
+#define SCHED_BUDGET_US_DEFAULT  2000           //  1   ϴ ִ ð
+
+/*****************************************************************************
+* Structure  : sched
+* Description:  ť (  ȣ  迭)
+*****************************************************************************/
+struct sched
+{
+    int *ring;              //  ȣ  ť
+    int cap;                // ť ũ ( )
+    int head;               //   ġ
+    int count;              // ť ִ  
+    size_t quantum;         //  Ʈ quantum (0 = select 1ȸ recv 1ȸ,  )
+    long budget_us;         //  1ȸ ð  (ũ)
+};
+
+int sched_init(struct sched *s, int cap, size_t quantum, long budget_us);
+void sched_free(struct sched *s);
+void sched_push(struct sched *s, int slot);
+int sched_pop(struct sched *s);
+uint64_t sched_now_us(void);
+
+#endif
@@ -0,0 +1,531 @@
+/*****************************************************************************
+* File       : server_bench.c
+* Description: μ    ġũ (Ʈ )
+*              server_tcpws  ó ڵ(server_conn API) socketpair() ῡ ̰
+*              Ḷ  尡 ڵ带 .     poll  
+*              -  /8331 Ʈ Ƿ  ġ ÿ ص   
+*              -  Է(--data  Ǵ  ռ ڵ)̸  Ʈ    
+*              - : raw (\n  Ʈ) / ws (ڵũ + ŷ ) / seq (SOCK_SEQPACKET,
+*                ޽ 1 = ڵ 1)
+*              - --latency: ڵ帶 ۽ ð ٿ  ڵ ϼ ð  
+*              - Ḷ   ڵ    ٸ  ڵ 1
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include "transport.h"
+#include "tune.h"
+#include "latency.h"
+#include "ws_proto.h"
+#include "server_conn.h"
+
+#define MODE_RAW        0
+#define MODE_WS         1
+#define MODE_SEQ        2
+
+#define BUF_SIZE        1024
+#define POLL_IDLE_MS    1000
+
+/*****************************************************************************
+* Structure  : producer
+* Description:  1 ۽  ( )
+*****************************************************************************/
+struct producer
+{
+    pthread_t thread;
+    int fd;                         // socketpair Ŭ̾Ʈ 
+    int mode;
+    int latency;
+    const unsigned char *data;      //  ڵ (  , б )
+    size_t data_len;
+    size_t chunk;                   // write 1ȸ / WS  1 ִ ̷ε
+    size_t bytes;                   //  ڵ Ʈ (ð ǥ ,   )
+    size_t records;
+    uint64_t start_ns;
+    int error;
+};
+
+/*****************************************************************************
+* Function   : write_all
+* Description: ŷ Ͽ len Ʈ  
+*                 ( ʰ ) SIGPIPE  EPIPE    з 
+* Returns    : 0 (), -1 ()
+*****************************************************************************/
+static int write_all(int fd, const unsigned char *buf, size_t len)
+{
+    ssize_t n = 0;
+
+    while (len > 0)
+    {
+        n = send(fd, buf, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return -1;
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : ws_handshake
+* Description: WebSocket ڵũ û  101  Ȯ
+*              ( ڵũ  recv پ   ó Ƿ
+*               Ŭ̾Ʈó   ڿ  )
+* Returns    : 0 (), -1 ()
+*****************************************************************************/
+static int ws_handshake(int fd)
+{
+    static const char request[] =
+        "GET / HTTP/1.1\r\n"
+        "Host: localhost\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+        "Sec-WebSocket-Version: 13\r\n\r\n";
+    char buffer[BUF_SIZE];
+    size_t received = 0;
+    ssize_t n = 0;
+
+    if (write_all(fd, (const unsigned char *)request, sizeof(request) - 1) < 0)
+    {
+        perror("Handshake request  ");
+        return -1;
+    }
+
+    while (received < sizeof(buffer) - 1)
+    {
+        n = read(fd, buffer + received, sizeof(buffer) - 1 - received);
+        if (n <= 0)
+        {
+            perror("Handshake   ");
+            return -1;
+        }
+        received += n;
+        buffer[received] = '\0';
+        if (strstr(buffer, "\r\n\r\n") != NULL)
+            break;
+    }
+
+    if (strstr(buffer, " 101") == NULL)
+    {
+        fprintf(stderr, "Handshake :\n%s\n", buffer);
+        return -1;
+    }
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : producer_flush
+* Description:  ڵ   (ws ŷ  1, raw ״)
+* Returns    : 0 (), -1 ()
+*****************************************************************************/
+static int producer_flush(struct producer *p, const unsigned char *buf, size_t len)
+{
+    unsigned char *frame = NULL;
+    size_t frame_len = 0;
+    int result = 0;
+
+    if (len == 0)
+        return 0;
+
+    if (p->mode != MODE_WS)
+        return write_all(p->fd, buf, len);
+
+    frame = create_ws_frame_masked(buf, len, &frame_len);
+    if (frame == NULL)
+        return -1;
+    result = write_all(p->fd, frame, frame_len);
+    free(frame);
+    return result;
+}
+
+/*****************************************************************************
+* Function   : producer_main
+* Description:   - Է ڵ  chunk ũ     
+*              --latency  ð 1 о ڵ帶 
+*              seq  ڵ帶 ޽ 1
+*****************************************************************************/
+static void* producer_main(void *arg)
+{
+    struct producer *p = (struct producer *)arg;
+    const unsigned char *rec = p->data;
+    const unsigned char *end = p->data + p->data_len;
+    const unsigned char *nl = NULL;
+    unsigned char *buf = NULL;
+    size_t buf_size = p->chunk + LATENCY_STAMP_LEN;
+    size_t used = 0;
+    size_t rec_len = 0;
+    size_t n = 0;
+    uint64_t now = 0;
+
+    p->start_ns = latency_now_ns();
+    if (p->mode == MODE_WS && ws_handshake(p->fd) < 0)
+    {
+        p->error = 1;
+        close(p->fd);
+        return NULL;
+    }
+
+    buf = malloc(buf_size);
+    if (buf == NULL)
+    {
+        perror("޸ Ҵ ");
+        p->error = 1;
+        close(p->fd);
+        return NULL;
+    }
+
+    while (rec < end)
+    {
+        nl = memchr(rec, '\n', end - rec);
+        rec_len = nl != NULL ? (size_t)(nl + 1 - rec) : (size_t)(end - rec);
+
+        //      (chunk ū ڵ ȥ  )
+        if (used > 0 && (p->mode == MODE_SEQ || used + LATENCY_STAMP_LEN + rec_len > p->chunk))
+        {
+            if (producer_flush(p, buf, used) < 0)
+                break;
+            used = 0;
+        }
+
+        if (used + LATENCY_STAMP_LEN + rec_len > buf_size)
+        {
+            // ۺ ū ڵ ð  ״
+            if (producer_flush(p, rec, rec_len) < 0)
+                break;
+            n = rec_len;
+        }
+        else if (p->latency)
+        {
+            if (used == 0)
+                now = latency_now_ns();
+            n = latency_stamp_at((char *)buf + used, buf_size - used, (const char *)rec, rec_len, now);
+            used += n;
+        }
+        else
+        {
+            memcpy(buf + used, rec, rec_len);
+            n = rec_len;
+            used += n;
+        }
+
+        p->bytes += n;
+        p->records++;
+        rec += rec_len;
+    }
+
+    if (rec < end || producer_flush(p, buf, used) < 0)
+    {
+        perror("۽ ");
+        p->error = 1;
+    }
+
+    free(buf);
+    close(p->fd);
+    return NULL;
+}
+
+/*****************************************************************************
+* Function   : make_records
+* Description: ռ ڵ count (size Ʈ,  ٲ ) . ׻  
+* Returns    : ڵ ,   NULL
+*****************************************************************************/
+static unsigned char* make_records(size_t count, size_t size)
+{
+    unsigned char *data = malloc(count * size);
+    unsigned char *rec = NULL;
+    size_t i, j;
+    int len = 0;
+
+    if (data == NULL)
+    {
+        perror("޸ Ҵ ");
+        return NULL;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        rec = data + i * size;
+        len = snprintf((char *)rec, size, "%zu ", i);
+        for (j = len < (int)size ? len : size - 1; j + 1 < size; j++)
+            rec[j] = "abcdefghijklmnopqrstuvwxyz0123456789"[j % 36];
+        rec[size - 1] = '\n';
+    }
+    return data;
+}
+
+/*****************************************************************************
+* Function   : main
+* Description: --conns socketpair   ڵ忡 ̰   ,
+*                 ó/  CPU/ 
+* Returns    : 0 ( ), 1 (ڵ  ġ Ǵ ۽ ), -1 ( ߻ )
+*****************************************************************************/
+int main(int argc, char *argv[])
+{
+    static struct producer producers[SERVER_CONN_MAX];
+    static struct client_data *conns[SERVER_CONN_MAX];
+    struct pollfd pfds[SERVER_CONN_MAX];
+    int more[SERVER_CONN_MAX];
+    const char *mode_name[] = { "raw", "ws", "seq" };
+    const char *data_path = NULL;
+    unsigned char *data = NULL;
+    size_t data_len = 0;
+    size_t records = 400000;
+    size_t rec_size = 110;
+    size_t chunk = 0;
+    size_t bytes = 0;
+    size_t got_bytes = 0;
+    size_t got_records = 0;
+    size_t sent_bytes = 0;
+    size_t sent_records = 0;
+    struct timespec cpu_start, cpu_end;
+    struct stat st;
+    uint64_t start_ns = 0;
+    uint64_t end_ns = 0;
+    double wall = 0.0;
+    double cpu = 0.0;
+    int mode = MODE_RAW;
+    int nconns = 1;
+    int flags = 0;
+    int json = 0;
+    int active = 0;
+    int pending = 0;
+    int mismatch = 0;
+    int failed = 0;
+    int sv[2];
+    int fd = -1;
+    int i, n, c;
+    FILE *out = stdout;
+    static struct option long_options[] = {
+        { "conns",   required_argument, NULL, 'c' },
+        { "mode",    required_argument, NULL, 'm' },
+        { "data",    required_argument, NULL, 'd' },
+        { "records", required_argument, NULL, 'n' },
+        { "size",    required_argument, NULL, 's' },
+        { "chunk",   required_argument, NULL, 'k' },
+        { "latency", no_argument,       NULL, 'l' },
+        { "perfctr", no_argument,       NULL, 'p' },
+        { "json",    no_argument,       NULL, 'j' },
+        TUNE_LONG_OPTIONS,
+        { NULL, 0, NULL, 0 }
+    };
+
+    while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1)
+    {
+        int r = tune_option(c, optarg);
+        if (r < 0)
+            return -1;
+        if (r > 0)
+            continue;
+
+        switch (c)
+        {
+            case 'c': nconns = atoi(optarg); break;
+            case 'd': data_path = optarg; break;
+            case 'n': records = strtoul(optarg, NULL, 10); break;
+            case 's': rec_size = strtoul(optarg, NULL, 10); break;
+            case 'k': chunk = strtoul(optarg, NULL, 10); break;
+            case 'l': flags |= SERVER_CONN_LATENCY; break;
+            case 'p': flags |= SERVER_CONN_PERFCTR; break;
+            case 'j': json = 1; break;
+            case 'm':
+                if (strcmp(optarg, "raw") == 0)         mode = MODE_RAW;
+                else if (strcmp(optarg, "ws") == 0)     mode = MODE_WS;
+                else if (strcmp(optarg, "seq") == 0)    mode = MODE_SEQ;
+                else mode = -1;
+                break;
+            default: mode = -1; break;
+        }
+    }
+
+    if (mode < 0 || optind != argc || nconns <= 0 || nconns > SERVER_CONN_MAX ||
+        (data_path == NULL && (records == 0 || rec_size < 2)))
+    {
+        fprintf(stderr, ": %s [--conns 1~%d] [--mode raw|ws|seq] [--data  | --records N --size Ʈ]\n"
+                        "       [--chunk Ʈ] [--latency] [--perfctr] [--json] %s\n",
+                argv[0], SERVER_CONN_MAX, TUNE_USAGE);
+        return -1;
+    }
+
+    // ۽ :   Ʃ  write_chunk (ڵ帶 send 0̸ 64 KB)
+    if (chunk == 0)
+        chunk = g_tune.write_chunk > 0 ? (size_t)g_tune.write_chunk : 65536;
+
+    if (data_path != NULL)
+    {
+        fd = open(data_path, O_RDONLY);
+        if (fd < 0 || fstat(fd, &st) < 0 || st.st_size == 0)
+        {
+            perror("Է   ");
+            return -1;
+        }
+        data_len = st.st_size;
+        data = mmap(NULL, data_len, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED)
+        {
+            perror("mmap ");
+            return -1;
+        }
+    }
+    else
+    {
+        data_len = records * rec_size;
+        data = make_records(records, rec_size);
+        if (data == NULL)
+            return -1;
+    }
+
+    // --json:   α(ڵũ, Ằ )   JSON 
+    if (json)
+    {
+        fd = dup(STDOUT_FILENO);
+        out = fd >= 0 ? fdopen(fd, "w") : NULL;
+        if (out == NULL || freopen("/dev/null", "w", stdout) == NULL)
+        {
+            perror("  ");
+            return -1;
+        }
+    }
+
+    if (server_conn_init(flags) < 0)
+        return -1;
+
+    for (i = 0; i < nconns; i++)
+    {
+        if (socketpair(AF_UNIX, mode == MODE_SEQ ? SOCK_SEQPACKET : SOCK_STREAM, 0, sv) < 0)
+        {
+            perror("socketpair ");
+            return -1;
+        }
+        tune_apply_socket(&g_tune, sv[0], 0);
+        tune_apply_socket(&g_tune, sv[1], 0);
+
+        conns[i] = server_conn_open(sv[0], mode == MODE_SEQ ? TRANSPORT_SEQPACKET : TRANSPORT_UNIX);
+        if (conns[i] == NULL)
+            return -1;
+        pfds[i].fd = sv[0];
+        pfds[i].events = POLLIN;
+        more[i] = 0;
+
+        producers[i].fd = sv[1];
+        producers[i].mode = mode;
+        producers[i].latency = (flags & SERVER_CONN_LATENCY) != 0;
+        producers[i].data = data;
+        producers[i].data_len = data_len;
+        producers[i].chunk = chunk;
+    }
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_start);
+    start_ns = latency_now_ns();
+    for (i = 0; i < nconns; i++)
+    {
+        if (pthread_create(&producers[i].thread, NULL, producer_main, &producers[i]) != 0)
+        {
+            fprintf(stderr, "   \n");
+            return -1;
+        }
+    }
+    active = nconns;
+
+    //  : б ϰų Ͱ   ִ    
+    while (active > 0)
+    {
+        n = poll(pfds, nconns, pending > 0 ? 0 : POLL_IDLE_MS);
+        if (n < 0 && errno != EINTR)
+        {
+            perror("poll ");
+            break;
+        }
+
+        pending = 0;
+        for (i = 0; i < nconns; i++)
+        {
+            if (pfds[i].fd < 0 || (pfds[i].revents == 0 && !more[i]))
+                continue;
+
+            more[i] = server_conn_serve(conns[i]);
+            if (more[i] < 0)
+            {
+                more[i] = 0;
+                pfds[i].fd = -1;
+                active--;
+            }
+            pending += more[i];
+        }
+    }
+    end_ns = latency_now_ns();
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu_end);
+
+    for (i = 0; i < nconns; i++)
+    {
+        pthread_join(producers[i].thread, NULL);
+        server_conn_counts(conns[i], &got_bytes, &got_records);
+        bytes += got_bytes;
+        sent_bytes += producers[i].bytes;
+        sent_records += producers[i].records;
+        failed += producers[i].error;
+        if (producers[i].error)
+            fprintf(stderr, " %d: ۽  (  ), ڵ %zu \n",
+                    i, producers[i].records);
+        if (got_records != producers[i].records)
+        {
+            fprintf(stderr, " %d:  ڵ %zu, ۽ %zu\n", i, got_records, producers[i].records);
+            mismatch++;
+        }
+    }
+    server_conn_cleanup();
+
+    wall = (end_ns - start_ns) / 1e9;
+    cpu = (cpu_end.tv_sec - cpu_start.tv_sec) + (cpu_end.tv_nsec - cpu_start.tv_nsec) / 1e9;
+
+    if (json)
+    {
+        const struct hdr_hist *h = server_conn_latency();
+
+        fprintf(out, "{\"server_bench\":\"%s\",\"conns\":%d,\"chunk\":%zu,\"bytes\":%zu,\"records\":%zu,"
+                "\"elapsed_s\":%.6f,\"mb_per_s\":%.3f,\"rec_per_s\":%.1f,\"server_cpu_s\":%.6f,"
+                "\"mismatch\":%d,\"failed\":%d",
+                mode_name[mode], nconns, chunk, bytes, sent_records, wall,
+                wall > 0 ? bytes / 1048576.0 / wall : 0.0, wall > 0 ? sent_records / wall : 0.0,
+                cpu, mismatch, failed);
+        if (flags & SERVER_CONN_LATENCY)
+            fprintf(out, ",\"lat_p50_us\":%.1f,\"lat_p90_us\":%.1f,\"lat_p99_us\":%.1f,"
+                    "\"lat_p999_us\":%.1f,\"lat_max_us\":%.1f",
+                    hdr_percentile(h, 50.0) / 1000.0, hdr_percentile(h, 90.0) / 1000.0,
+                    hdr_percentile(h, 99.0) / 1000.0, hdr_percentile(h, 99.9) / 1000.0,
+                    h->max / 1000.0);
+        fprintf(out, "}\n");
+        fclose(out);
+    }
+    else
+    {
+        printf("[BENCH] %s  %d,  %zu Ʈ, ۽ %zu Ʈ / ڵ %zu (ġ %d,  %d)\n",
+               mode_name[mode], nconns, chunk, sent_bytes, sent_records, mismatch, failed);
+        printf("[BENCH]   %zu Ʈ, %.6f , %.2f MB/s, %.1f ڵ/,   CPU %.6f  (%.0f%%)\n",
+               bytes, wall, wall > 0 ? bytes / 1048576.0 / wall : 0.0, wall > 0 ? sent_records / wall : 0.0,
+               cpu, wall > 0 ? cpu * 100.0 / wall : 0.0);
+        if (flags & SERVER_CONN_LATENCY)
+            hdr_print(server_conn_latency(), "ڵ(۽   )", stdout);
+    }
+
+    if (data_path != NULL)
+        munmap(data, data_len);
+    else
+        free(data);
+    return mismatch > 0 || failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,31 @@
+/*****************************************************************************
+* File       : server_conn.h
+* Description: server_tcpws  ó ̺귯 API
+*              ̹  fd ޾   ڵ(ڵũ Ǻ, WS  ڵ,
+*              ڵ , /ܰ躰 Ŭ ) ó.  /Ʈ/select  
+*              server_tcpws.c -DSERVER_CONN_LIB ϸ main   API Ե
+*                ¸ Ƿ  μ  常 ȣ (  μ )
+*****************************************************************************/
+
+#ifndef SERVER_CONN_H
+#define SERVER_CONN_H
+
+#include <stddef.h>
+#include "latency.h"
+
+#define SERVER_CONN_MAX         30          //    (server_tcpws   )
+
+#define SERVER_CONN_LATENCY     0x1         // ڵ  ۽ ð     (--latency)
+#define SERVER_CONN_PERFCTR     0x2         //   ܰ躰 Ŭ  (--perfctr)
+
+struct client_data;
+
+int server_conn_init(int flags);
+struct client_data* server_conn_open(int fd, int transport);
+int server_conn_serve(struct client_data *client);
+void server_conn_counts(const struct client_data *client, size_t *bytes, size_t *records);
+const struct hdr_hist* server_conn_latency(void);
+void server_conn_close(struct client_data *client);
+void server_conn_cleanup(void);
+
+#endif
@@ -8,18 +8,114 @@
 #include <string.h>
 #include <unistd.h>
 #include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
 #include <arpa/inet.h>
 #include <sys/time.h>
 #include <sys/select.h>
-#include <openssl/sha.h>
-#include <openssl/bio.h>
-#include <openssl/evp.h>
-#include <openssl/buffer.h>
+#include <getopt.h>
+#include "tls_offload.h"
+#include "transport.h"
+#include "shm_ring.h"
+#include "tune.h"
+#include "sched.h"
+#include "timer_wheel.h"
+#include "admission.h"
+#include "handoff.h"
+#include "metrics.h"
+#include "latency.h"
+#include "perfctr.h"
+#include "probes.h"
+#include "flight.h"
+#include "statseg.h"
+#include "tcpinfo.h"
+#include "completion.h"
+#include "ws_proto.h"
+#include "server_conn.h"
 
 #define PORT 8331
-#define BUF_SIZE 2048
 #define MAX_RECV_BUF 102400
-#define MAX_CLIENTS 30
+#define MAX_CLIENTS SERVER_CONN_MAX
+#define TIMER_TICK_MS 10
+#define INITIAL_CAPACITY 102400             // Ằ    ʱ ũ
+#define PENDING_LIMIT 256                   //  ⿭ ִ  (--pending )
+#define SHED_DRAIN_MAX 64                   //   ù û /巹   ִ  (ġ RST)
+#define SHED_DRAIN_MS 1000                  // 503   Ŭ̾Ʈ ⸦ ٸ ð
+#define SEQ_MAX_RECORD (16 * 1024 * 1024)  // SEQPACKET ڵ(޽ 1) ִ ũ
+#define REPLY_SEND_MS 1000                  //  (101, /metrics ) ۽ ۰ á  ִ 
+
+#define CONN_HANDSHAKE  0                   // ù (WS ׷̵,  ޸𸮴  ) 
+#define CONN_ACTIVE     1                   //   (/ ˻)
+#define CONN_CLOSING    2                   // WS close       (linger)
+
+#define SHED_WAIT_REQUEST   0               // ù û(TLS ڵũ Ϸ) , ׶   ٽ Ǵ
+#define SHED_WAIT_READ      1               //  Ȯ, ù ͸   503 
+#define SHED_DRAINING       2               // 503   Ŭ̾Ʈ   о 
+
+static SSL_CTX *g_tls_ctx = NULL;       // --cert/--key   TLS  Ȱȭ
+static char *g_recv_buf = NULL;         // recv()  (Ʃ  read_chunk + 1 Ʈ)
+static char *g_seq_buf = NULL;          // read_chunk ū SEQPACKET ڵ  (ʿ  Ȯ)
+static size_t g_seq_cap = 0;
+static struct sched g_sched;            // Ằ   ť (Deficit Round Robin)
+static struct timer_wheel g_timers;     // Ằ ŸӾƿ Ÿ̸
+static fd_set *g_master_set = NULL;     // Ÿ̸ ݹ鿡    
+static int *g_max_fd = NULL;
+static struct admission g_adm;          //   (޸/ /CPU)
+static long g_adm_queue_timeout_ms = 10000;   //  ⿭ ִ  ð
+static int g_latency = 0;               // --latency: ڵ  ۽ ð    
+static struct hdr_hist g_lat_records;   // ü ڵ 
+static struct hdr_hist g_lat_frames;    // ü WS  
+static int g_perfctr = 0;               // --perfctr:   ܰ躰 Ŭ 
+static long g_flight_min_rate = 0;      // --flight-min-rate: ˻  ӵ ̺    
+static int g_tcpinfo = 1;               // TCP_INFO 1 ֱ ǥ (--no-tcpinfo )
+static struct hdr_hist g_tcp_rtt;       // ü TCP  Ȱ RTT ǥ
+static struct hdr_hist g_tcp_rcv_rtt;   // ü TCP    RTT ǥ
+
+/*****************************************************************************
+* Structure  : pending_conn
+* Description:  ⿭ ׸ (accept ϰ    Ŀ ۰  Ŭ̾Ʈ ۽ )
+*****************************************************************************/
+struct pending_conn
+{
+    int fd;                             // -1̸  ĭ ( ð ʰ )
+    int transport;
+    uint64_t queued_ms;
+    struct timer_node timer;            //   ð
+};
+
+/*****************************************************************************
+* Structure  : shed_conn
+* Description:     (   ִ ù û   503)
+*****************************************************************************/
+struct shed_conn
+{
+    int fd;
+    int transport;
+    int state;                          // SHED_WAIT_REQUEST / SHED_WAIT_READ / SHED_DRAINING
+    int tls_checked;                    // TLS ClientHello  Ȯ Ϸ
+    SSL *ssl;                           // TLS ̸ ڵũ  503 TLS 
+    struct timer_node timer;            // ù û  / 巹  ð
+};
+
+static struct pending_conn g_pending[PENDING_LIMIT];    //  FIFO
+static int g_pending_head = 0;
+static int g_pending_count = 0;                         //  ĭ  ׸ 
+static struct shed_conn g_shed[SHED_DRAIN_MAX];
+
+/*****************************************************************************
+* Structure  : timeout_conf
+* Description:  ŸӾƿ  (и, 0 =   )
+*****************************************************************************/
+static struct
+{
+    long handshake_ms;                  //   ڵũ/ù ͱ  ð
+    long idle_ms;                       //      ð
+    long min_rate;                      // ּ  ӵ (Ʈ/), ˻  Ȯ
+                                        // ⺻ 0: 幰 ڵ带   ڸ  ʵ --min-rate 
+    long rate_window_ms;                // ּ  ӵ ˻ 
+    long linger_ms;                     // close    밡   
+} g_timeouts = { 5000, 30000, 0, 10000, 2000 };
 
 /*****************************************************************************
 * Structure  : client_data
@@ -37,245 +133,750 @@ struct client_data
     size_t record_count;                //  ڵ  ( ٲ )
     struct timeval start_time;          //   ð
     int handshake_completed;            // WebSocket ڵũ Ϸ 
+    int transport;                      //   (TRANSPORT_TCP/UNIX/SEQPACKET)
+    struct shm_ring *ring;              //  ޸  (TRANSPORT_SHM Ḹ )
+    SSL *ssl;                           // TLS  ( ̸ NULL)
+    int tls_checked;                    // TLS ClientHello  Ȯ Ϸ
+    int queued;                         //  ť  
+    long deficit;                       // DRR deficit ī (̹ 忡    ִ Ʈ)
+    uint64_t queued_at;                 //  ť  ð (ũ)
+    uint64_t max_wait_us;               // ť  ִ ð (ٸ )
+    size_t services;                    //  Ƚ
+    struct timer_node timer;            // ڵũ///linger Ÿ̸ (º )
+    int phase;                          // CONN_HANDSHAKE / CONN_ACTIVE / CONN_CLOSING
+    uint64_t last_active_ms;            //   ð
+    size_t window_bytes;                //  ӵ ˻   Ʈ
+    int metric_proto;                   //    з (METRIC_PROTO_*)
+    size_t records_reported;            // īͿ ݿ ڵ 
+    struct hdr_hist *lat_records;       // ڵ  (--latency  Ҵ)
+    struct hdr_hist *lat_frames;        // WS  
+    size_t record_start;                // all_data    ڵ  ġ
+    struct perf_stats *perf;            // ܰ躰 Ŭ (--perfctr  Ҵ)
+    int close_reason;                   //     (FLIGHT_CLOSE_*)
+    int slot;                           //   ȣ (  ġ)
+    struct tcpinfo_stats *tcpi;         // TCP_INFO ǥ (--no-tcpinfo NULL, TCP Ḹ )
 };
 
 /*****************************************************************************
-* Function   : base64_encode
-* Description: ̳ʸ ͸ base64 ڵ
+* Function   : set_nonblocking
+* Description:  ŷ ȯ (ٷ EAGAIN   ֵ)
 *****************************************************************************/
-char* base64_encode(const unsigned char *input, int length)
+static void set_nonblocking(int fd)
 {
-    BIO *bmem = NULL;
-    BIO *b64 = NULL;
-    BUF_MEM *bptr = NULL;
-    char *buff = NULL;
-
-    b64 = BIO_new(BIO_f_base64());
-    bmem = BIO_new(BIO_s_mem());
-    b64 = BIO_push(b64, bmem);
-
-    BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
-    BIO_write(b64, input, length);
-    BIO_flush(b64);
-    BIO_get_mem_ptr(b64, &bptr);
+    int flags = fcntl(fd, F_GETFL, 0);
 
-    buff = (char *)malloc(bptr->length + 1);
-    memcpy(buff, bptr->data, bptr->length);
-    buff[bptr->length] = '\0';
-
-    BIO_free_all(b64);
-
-    return buff;
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+        perror("fcntl(O_NONBLOCK) ");
 }
 
 /*****************************************************************************
-* Function   : compute_accept_key
-* Description: WebSocket ڵũ Accept Ű 
+* Function   : set_metric_proto
+* Description:   з  ݺ    ̵
 *****************************************************************************/
-char* compute_accept_key(const char *client_key)
+static void set_metric_proto(struct client_data *client, int proto)
 {
-    const char *GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
-    char concatenated[256];
-    unsigned char hash[SHA_DIGEST_LENGTH];
+    metrics_gauge(&t_metrics->active[client->metric_proto], -1);
+    metrics_gauge(&t_metrics->active[proto], 1);
+    client->metric_proto = proto;
+}
 
-    snprintf(concatenated, sizeof(concatenated), "%s%s", client_key, GUID);
-    SHA1((unsigned char*)concatenated, strlen(concatenated), hash);
+/*****************************************************************************
+* Function   : shed_close
+* Description:    (巹 Ͽ   close)
+*****************************************************************************/
+void shed_close(struct shed_conn *sc)
+{
+    timer_del(&g_timers, &sc->timer);
+    FD_CLR(sc->fd, g_master_set);
+    tls_close(sc->ssl);
+    sc->ssl = NULL;
+    close(sc->fd);
+    sc->fd = -1;
+}
 
-    return base64_encode(hash, SHA_DIGEST_LENGTH);
+/*****************************************************************************
+* Function   : shed_timer_expired
+* Description: ù û  /    巹 ð   
+*****************************************************************************/
+void shed_timer_expired(struct timer_node *t, void *arg)
+{
+    (void)t;
+    shed_close((struct shed_conn *)arg);
 }
 
 /*****************************************************************************
-* Function   : extract_websocket_key
-* Description: û  Sec-WebSocket-Key 
+* Function   : shed_count
+* Description:  / 
 *****************************************************************************/
-char* extract_websocket_key(const char *request)
+void shed_count(int fd)
 {
-    const char *key_header = "Sec-WebSocket-Key: ";
-    char *key_start = NULL;
-    char *key_end = NULL;
-    char *key = NULL;
-    size_t key_len = 0;
+    g_adm.shed++;
+    PROBE3(backpressure, fd, PROBE_BP_SHED, g_adm.retry_after);
+    flight_record(FLIGHT_BACKPRESSURE, fd, PROBE_BP_SHED, g_adm.retry_after, 0);
+}
 
-    key_start = strstr(request, key_header);
-    if (key_start == 0)
-        return NULL;
+/*****************************************************************************
+* Function   : shed_connection
+* Description:     ٷ  ʰ ù û 
+*              accept Ŀ  𸣹Ƿ,   ˾Ƶ    
+*              (WS ׷̵ û 503, TLS ڵũ  TLS 503,
+*               Ʈ ù ͸   503).     RST 
+*****************************************************************************/
+void shed_connection(int fd, int transport, int *max_fd)
+{
+    struct linger rst = { 1, 0 };
+    long wait_ms = g_timeouts.handshake_ms > 0 ? g_timeouts.handshake_ms : SHED_DRAIN_MS;
+    int i;
+    
+    for (i = 0; i < SHED_DRAIN_MAX; i++)
+    {
+        if (g_shed[i].fd == -1)
+        {
+            g_shed[i].fd = fd;
+            g_shed[i].transport = transport;
+            g_shed[i].state = SHED_WAIT_REQUEST;
+            g_shed[i].tls_checked = (g_tls_ctx == NULL || transport == TRANSPORT_SEQPACKET ||
+                                     transport == TRANSPORT_SHM);
+            g_shed[i].ssl = NULL;
+            //  ޸   ϸ ŷ Ƿ ״ ΰ MSG_DONTWAIT 
+            if (transport != TRANSPORT_SHM)
+                set_nonblocking(fd);
+            timer_add(&g_timers, &g_shed[i].timer, timer_now_ms() + wait_ms);
+            FD_SET(fd, g_master_set);
+            if (fd > *max_fd)
+                *max_fd = fd;
+            return;
+        }
+    }
+    
+    //  ϵ    RST ( ݿ   )
+    shed_count(fd);
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &rst, sizeof(rst));
+    close(fd);
+}
 
-    key_start += strlen(key_header);
-    key_end = strstr(key_start, "\r\n");
-    if (key_end == 0) 
-        return NULL;
+/*****************************************************************************
+* Function   : pending_timer_expired
+* Description:  ⿭ ʹ  ٸ  
+*****************************************************************************/
+void pending_timer_expired(struct timer_node *t, void *arg)
+{
+    struct pending_conn *pc = (struct pending_conn *)arg;
+    int fd = pc->fd;
+    
+    (void)t;
+    pc->fd = -1;            // ⿭  ׸  ĭ ǥ (  ǳʶ)
+    g_adm.pending--;
+    printf("[ADMISSION] ⿭  ð ʰ, \n");
+    shed_connection(fd, pc->transport, g_max_fd);
+}
 
-    key_len = key_end - key_start;
-    key = malloc(key_len + 1);
-    strncpy(key, key_start, key_len);
-    key[key_len] = '\0';
+/*****************************************************************************
+* Function   : init_client_slot
+* Description:    Կ 
+*****************************************************************************/
+int init_client_slot(struct client_data *client, int client_fd, int transport, fd_set *master_set, int *max_fd)
+{
+    client->fd = client_fd;
+    client->is_websocket = 0;
+    client->recv_buf_len = 0;
+    client->handshake_completed = 0;
+    client->total_len = 0;
+    client->record_count = 0;
+    client->capacity = INITIAL_CAPACITY;
+    client->transport = transport;
+    client->ring = NULL;
+    client->ssl = NULL;
+    client->tls_checked = (g_tls_ctx == NULL || transport == TRANSPORT_SEQPACKET ||
+                           transport == TRANSPORT_SHM);
+    // queued :    ť  ׸ ״  (ߺ  )
+    client->deficit = 0;
+    client->max_wait_us = 0;
+    client->services = 0;
+    client->all_data = malloc(client->capacity);
+    
+    if (client->all_data == NULL)
+    {
+        perror("޸ Ҵ ");
+        close(client_fd);
+        client->fd = -1;
+        return -1;
+    }
+    
+    g_adm.mem_used += client->capacity;
+    g_adm.active++;
+    
+    if (transport == TRANSPORT_SEQPACKET)
+        client->metric_proto = METRIC_PROTO_SEQPACKET;
+    else if (transport == TRANSPORT_SHM)
+        client->metric_proto = METRIC_PROTO_SHM;
+    else
+        client->metric_proto = METRIC_PROTO_UNKNOWN;
+    client->records_reported = 0;
+    client->record_start = 0;
+    if (client->lat_records != NULL)
+    {
+        hdr_init(client->lat_records);
+        hdr_init(client->lat_frames);
+    }
+    if (client->perf != NULL)
+        perfctr_reset(client->perf);
+    if (client->tcpi != NULL)
+        tcpinfo_reset(client->tcpi);
+    metrics_gauge(&t_metrics->active[client->metric_proto], 1);
+    metrics_gauge(&t_metrics->buffer_bytes, client->capacity);
+    metrics_add(METRIC_ACCEPTED, 1);
+    
+    gettimeofday(&client->start_time, NULL);
+    
+    client->phase = CONN_HANDSHAKE;
+    client->last_active_ms = timer_now_ms();
+    client->window_bytes = 0;
+    if (g_timeouts.handshake_ms > 0)
+        timer_add(&g_timers, &client->timer, client->last_active_ms + g_timeouts.handshake_ms);
+    
+    // TLS ڵũ ŷ  (handle_tls_handshake)
+    if (transport != TRANSPORT_SHM)
+        set_nonblocking(client_fd);
+    
+    FD_SET(client_fd, master_set);
+    if (client_fd > *max_fd)
+    {
+        *max_fd = client_fd;
+    }
+    
+    PROBE2(conn_accept, client_fd, transport);
+    flight_record(FLIGHT_ACCEPT, client_fd, transport, 0, 0);
+    statseg_conn_open(client->slot, client_fd, client->metric_proto);
+    client->close_reason = FLIGHT_CLOSE_PEER;
+    return 0;
+}
 
-    return key;
+/*****************************************************************************
+* Function   : find_free_slot
+* Description:    ã
+* Returns    :  ȣ,  -1
+*****************************************************************************/
+int find_free_slot(struct client_data *clients)
+{
+    int i;
+    
+    for (i = 0; i < MAX_CLIENTS; i++)
+    {
+        if (clients[i].fd == -1)
+            return i;
+    }
+    
+    return -1;
 }
 
 /*****************************************************************************
-* Function   : decode_ws_frame
-* Description: WebSocket  ڵϰ ŷ  (ҿ   ó )
+* Function   : admit_pending
+* Description: ⿭ տ   ŭ   ( ȯ/   ȣ)
 *****************************************************************************/
-int decode_ws_frame(const unsigned char *frame, size_t length, unsigned char *output, size_t *frame_len_out)
+void admit_pending(fd_set *master_set, int *max_fd, struct client_data *clients)
 {
-    size_t payload_len = 0;
-    size_t offset = 0;
-    size_t i = 0;
-    const unsigned char *mask_key = NULL;
-    const unsigned char *payload = NULL;
+    struct pending_conn *pc = NULL;
+    int slot = 0;
+    
+    while (g_pending_count > 0)
+    {
+        pc = &g_pending[g_pending_head];
+        if (pc->fd != -1)
+        {
+            slot = find_free_slot(clients);
+            if (admission_decide(&g_adm, slot >= 0, INITIAL_CAPACITY) != ADMIT_ACCEPT)
+                return;
+            
+            timer_del(&g_timers, &pc->timer);
+            g_adm.pending--;
+            g_adm.queued++;
+            printf("[ADMISSION] ⿭  ( %llu ms)\n",
+                   (unsigned long long)(timer_now_ms() - pc->queued_ms));
+            init_client_slot(&clients[slot], pc->fd, pc->transport, master_set, max_fd);
+            pc->fd = -1;
+        }
+        
+        g_pending_head = (g_pending_head + 1) % PENDING_LIMIT;
+        g_pending_count--;
+    }
+}
 
-    if (length < 6)
-        return 0; //     
+/*****************************************************************************
+* Function   : handle_new_connection
+* Description:  Ŭ̾Ʈ  ó (TCP / Unix  )
+*                  ٷ  / ⿭  / 503 
+*****************************************************************************/
+int handle_new_connection(int server_fd, int transport, fd_set *master_set, int *max_fd, struct client_data *clients)
+{
+    struct sockaddr_storage client_addr;
+    socklen_t client_len = sizeof(client_addr);
+    int client_fd = accept(server_fd, (struct sockaddr*)&client_addr, &client_len);
+    struct pending_conn *pc = NULL;
+    int slot = 0;
+    int decision = 0;
+    
+    if (client_fd < 0)
+    {
+        perror("accept ");
+        return -1;
+    }
+    
+    //  ũ ʿ ӵ TCP_NODELAY/QUICKACK/BUSY_POLL Ḷ 
+    tune_apply_socket(&g_tune, client_fd, transport == TRANSPORT_TCP);
+    
+    if (transport == TRANSPORT_TCP)
+        printf("Ŭ̾Ʈ \n");
+    else
+        printf("Ŭ̾Ʈ  (%s)\n", transport_name(transport));
+    
+    // ⿭        ڷ (FIFO)
+    slot = find_free_slot(clients);
+    decision = admission_decide(&g_adm, slot >= 0 && g_adm.pending == 0, INITIAL_CAPACITY);
+    
+    if (decision == ADMIT_ACCEPT)
+    {
+        g_adm.admitted++;
+        return init_client_slot(&clients[slot], client_fd, transport, master_set, max_fd);
+    }
+    
+    if (decision == ADMIT_QUEUE && g_pending_count < PENDING_LIMIT)
+    {
+        pc = &g_pending[(g_pending_head + g_pending_count) % PENDING_LIMIT];
+        pc->fd = client_fd;
+        pc->transport = transport;
+        pc->queued_ms = timer_now_ms();
+        if (g_adm_queue_timeout_ms > 0)
+            timer_add(&g_timers, &pc->timer, pc->queued_ms + g_adm_queue_timeout_ms);
+        g_pending_count++;
+        g_adm.pending++;
+        PROBE3(backpressure, client_fd, PROBE_BP_PENDING, g_adm.pending);
+        flight_record(FLIGHT_BACKPRESSURE, client_fd, PROBE_BP_PENDING, g_adm.pending, 0);
+        return 0;
+    }
+    
+    shed_connection(client_fd, transport, max_fd);
+    return -1;
+}
 
-    payload_len = frame[1] & 0x7F;
-    offset = 2;
+/*****************************************************************************
+* Function   : tls_handshake_done
+* Description: TLS ڵũ Ϸ  (//α)
+*****************************************************************************/
+void tls_handshake_done(struct client_data *client)
+{
+    metrics_add(METRIC_TLS_HANDSHAKES, 1);
+    PROBE2(handshake_done, client->fd, PROBE_HS_TLS);
+    flight_record(FLIGHT_HANDSHAKE, client->fd, PROBE_HS_TLS, 0, 0);
+    metrics_gauge(&t_metrics->tls_active, 1);
+    printf("[TLS] handshake Ϸ (%s, kTLS RX: %s, TX: %s)\n",
+           SSL_get_cipher(client->ssl),
+           tls_ktls_rx(client->ssl) ? "on" : "off",
+           tls_ktls_tx(client->ssl) ? "on" : "off");
+    gettimeofday(&client->start_time, NULL);
+}
 
-    if (payload_len == 126)
+/*****************************************************************************
+* Function   : shed_wait_request
+* Description:    ù û Ȯ (TLS ClientHello̸ ڵũ )
+*               ⸸ ϹǷ(MSG_PEEK) ϰ Ǹ Ͱ Ŀ ۿ ״ 
+* Returns    : 1 ( ù   Ǵ TLS ڵũ Ϸ), 0 (), -1 ( )
+*****************************************************************************/
+int shed_wait_request(struct shed_conn *sc)
+{
+    unsigned char first = 0;
+    ssize_t n = 0;
+    int r = 0;
+    
+    if (sc->ssl == NULL)
     {
-        if (length < 4)
+        n = recv(sc->fd, &first, 1, MSG_PEEK | MSG_DONTWAIT);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
             return 0;
+        
+        if (n <= 0)
+            return -1;
+        
+        if (sc->tls_checked || first != TLS_RECORD_HANDSHAKE)
+            return 1;
+    }
+    
+    r = tls_accept(g_tls_ctx, &sc->ssl, sc->fd);
+    if (r < 0)
+        fprintf(stderr, "[TLS] handshake \n");
+    
+    return r;
+}
 
-        payload_len = (frame[2] << 8) | frame[3];
-        offset += 2;
+/*****************************************************************************
+* Function   : shed_admit
+* Description: ù û     ٽ Ǵ (׻ /ڿ   )
+* Returns    : 0 (  ű), -1 ( )
+*****************************************************************************/
+int shed_admit(struct shed_conn *sc, struct client_data *clients, fd_set *master_set, int *max_fd)
+{
+    struct client_data *client = NULL;
+    int slot = find_free_slot(clients);
+    
+    // ⿭      
+    if (admission_decide(&g_adm, slot >= 0 && g_adm.pending == 0, INITIAL_CAPACITY) != ADMIT_ACCEPT)
+        return -1;
+    
+    timer_del(&g_timers, &sc->timer);
+    g_adm.admitted++;
+    printf("[ADMISSION] ù û    \n");
+    
+    client = &clients[slot];
+    if (init_client_slot(client, sc->fd, sc->transport, master_set, max_fd) < 0)
+    {
+        // fd init_client_slot 
+        FD_CLR(sc->fd, master_set);
+        SSL_free(sc->ssl);
     }
-    else if (payload_len == 127)
+    else if (sc->ssl != NULL)
     {
-        if (length < 10)
-            return 0;
+        client->ssl = sc->ssl;
+        client->tls_checked = 1;
+        tls_handshake_done(client);
+    }
+    
+    sc->ssl = NULL;
+    sc->fd = -1;
+    return 0;
+}
 
-        payload_len = 0;
-        for (i = 0; i < 8; i++)
+/*****************************************************************************
+* Function   : shed_reply
+* Description: 503 + Retry-After    ⸸ ݰ 巹 
+*              (ٷ closeϸ     RST  Ŭ̾Ʈ   )
+*****************************************************************************/
+void shed_reply(struct shed_conn *sc)
+{
+    char response[256];
+    int len = admission_format_503(&g_adm, response, sizeof(response));
+    
+    if (sc->ssl != NULL)
+    {
+        tls_send_all(sc->ssl, sc->fd, response, len, REPLY_SEND_MS);
+        SSL_shutdown(sc->ssl);
+    }
+    else
+    {
+        send(sc->fd, response, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+    }
+    shutdown(sc->fd, SHUT_WR);
+    
+    sc->state = SHED_DRAINING;
+    timer_add(&g_timers, &sc->timer, timer_now_ms() + SHED_DRAIN_MS);
+}
+
+/*****************************************************************************
+* Function   : handle_shed_data
+* Description:    ó
+*              ù û   ׷ ѵ ʰ ù (WS ׷̵ û ) а 503
+*               밡    ͸ о 
+*****************************************************************************/
+void handle_shed_data(struct shed_conn *sc, struct client_data *clients, fd_set *master_set, int *max_fd)
+{
+    ssize_t n = 0;
+    int r = 0;
+    
+    if (sc->state == SHED_WAIT_REQUEST)
+    {
+        r = shed_wait_request(sc);
+        if (r < 0)
+            shed_close(sc);
+        if (r <= 0)
+            return;
+        
+        if (shed_admit(sc, clients, master_set, max_fd) == 0)
+            return;
+        
+        shed_count(sc->fd);
+        sc->state = SHED_WAIT_READ;
+    }
+    
+    if (sc->state == SHED_WAIT_READ)
+    {
+        // TLS ڵũ Ķ  Ͱ    ( б ̺Ʈ ̾)
+        if (sc->ssl != NULL)
+            n = tls_recv(sc->ssl, sc->fd, g_recv_buf, g_tune.read_chunk);
+        else
+            n = recv(sc->fd, g_recv_buf, g_tune.read_chunk, MSG_DONTWAIT);
+        
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+        
+        if (n <= 0)
         {
-            payload_len |= ((size_t)frame[offset + i]) << (8 * (7 - i));
+            shed_close(sc);
+            return;
         }
-        offset += 8;
+        
+        shed_reply(sc);
     }
+    
+    while ((n = recv(sc->fd, g_recv_buf, g_tune.read_chunk, MSG_DONTWAIT)) > 0)
+        ;
+    
+    if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+        shed_close(sc);
+}
 
-    if (length < offset + 4 + payload_len)
-        return 0; // Ͱ   ŵ   
-
-    mask_key = frame + offset;
-    payload = frame + offset + 4;
-
-    for (i = 0; i < payload_len; i++)
+/*****************************************************************************
+* Function   : reserve_data
+* Description:   ۿ need Ʈ  Ȯ (2辿 Ȯ,   ޸ 뷮 ݿ)
+* Returns    : 0 (), -1 (޸ )
+*****************************************************************************/
+int reserve_data(struct client_data *client, size_t need)
+{
+    size_t old_capacity = client->capacity;
+    
+    while (client->total_len + need > client->capacity)
+        client->capacity *= 2;
+    
+    if (client->capacity == old_capacity)
+        return 0;
+    
+    PROBE3(buffer_grow, client->fd, old_capacity, client->capacity);
+    flight_record(FLIGHT_GROW, client->fd, old_capacity, client->capacity, 0);
+    client->all_data = realloc(client->all_data, client->capacity);
+    g_adm.mem_used += client->capacity - old_capacity;
+    metrics_gauge(&t_metrics->buffer_bytes, client->capacity - old_capacity);
+    metrics_add(METRIC_REALLOCS, 1);
+    if (client->all_data == NULL)
     {
-        output[i] = payload[i] ^ mask_key[i % 4];
+        fprintf(stderr, "޸ Ҵ \n");
+        return -1;
     }
+    
+    return 0;
+}
 
-    if (frame_len_out)
+/*****************************************************************************
+* Function   : record_latency
+* Description: all_data[from, total_len)  ϼ ڵ帶 ۽ ð о  
+*              ڵ尡 recv 迡 ĵ all_data ̾ Ƿ  ġ 
+*****************************************************************************/
+void record_latency(struct client_data *client, size_t from, uint64_t now)
+{
+    unsigned char *end = client->all_data + client->total_len;
+    unsigned char *p = client->all_data + from;
+    uint64_t sent = 0;
+    
+    while ((p = memchr(p, '\n', end - p)) != NULL)
     {
-        *frame_len_out = offset + 4 + payload_len;
+        p++;
+        if (latency_parse(client->all_data + client->record_start,
+                          p - client->all_data - client->record_start, &sent) && now >= sent)
+        {
+            hdr_record(client->lat_records, now - sent);
+            hdr_record(&g_lat_records, now - sent);
+        }
+        client->record_start = p - client->all_data;
     }
+}
 
-    return (int)payload_len;
+/*****************************************************************************
+* Function   : flight_read
+* Description:  ϱ⿡  .    FLIGHT_STALL_MS ̻ 
+*              ü(STALL)  
+*****************************************************************************/
+void flight_read(struct client_data *client, size_t bytes)
+{
+    uint64_t now = timer_now_ms();
+    
+    if (client->phase == CONN_ACTIVE && now - client->last_active_ms >= FLIGHT_STALL_MS)
+        flight_record(FLIGHT_STALL, client->fd, now - client->last_active_ms, 0, 0);
+    flight_record(FLIGHT_READ, client->fd, bytes, 0, 0);
 }
 
 /*****************************************************************************
-* Function   : handle_new_connection
-* Description:  Ŭ̾Ʈ  ó
+* Function   : completion_reply
+* Description: Ŭ̾Ʈ  ǥ(--ack) Ȯ     ۺ  ð
+*               ڿ ۼ
+* Parameters : - const unsigned char *text :  ǥ ("ACK <Ʈ> <ڵ>")
+*              - size_t stored              :  ǥð ڵ Ǿ   
+*                                             (迡  , ڵ 1 )
+* Returns    :  ,  ǥð ƴϸ 0 ( ״)
 *****************************************************************************/
-int handle_new_connection(int server_fd, fd_set *master_set, int *max_fd, struct client_data *clients)
+size_t completion_reply(struct client_data *client, const unsigned char *text, size_t len, size_t stored,
+                        char *out, size_t size)
 {
-    struct sockaddr_in client_addr;
-    socklen_t client_len = sizeof(client_addr);
-    int client_fd = accept(server_fd, (struct sockaddr*)&client_addr, &client_len);
-    int i;
+    struct completion sent;
+    struct completion got;
+    struct timeval now;
     
-    if (client_fd < 0)
+    if (completion_parse((const char *)text, len, &sent, 0) < 0)
+        return 0;
+    
+    if (stored > 0)
     {
-        perror("accept ");
-        return -1;
+        client->total_len -= stored;
+        client->record_count--;
+        if (client->record_start > client->total_len)
+            client->record_start = client->total_len;
     }
     
-    printf("Ŭ̾Ʈ \n");
+    gettimeofday(&now, NULL);
+    got.bytes = client->total_len;
+    got.records = client->record_count;
+    got.elapsed_us = (now.tv_sec - client->start_time.tv_sec) * 1000000LL +
+                     (now.tv_usec - client->start_time.tv_usec);
+    completion_report(&sent, &got, -1, stdout);
     
-    //   ã
-    for (i = 0; i < MAX_CLIENTS; i++)
+    return completion_format(out, size, &got, 1);
+}
+
+/*****************************************************************************
+* Function   : check_tcp_completion
+* Description:  ٲ   TCP  ڵ尡  ǥ̸  ("...\n")
+*               ǥô  ڵθ Ƿ  COMPLETION_MAX Ʈ Ȯ
+*****************************************************************************/
+void check_tcp_completion(struct client_data *client)
+{
+    unsigned char *end = client->all_data + client->total_len;
+    unsigned char *p = end - 1;
+    char reply[COMPLETION_MAX + 1];
+    size_t len = 0;
+    
+    while (p > client->all_data && end - p <= COMPLETION_MAX && *p != COMPLETION_MARKER)
+        p--;
+    if (*p != COMPLETION_MARKER || (p > client->all_data && p[-1] != '\n'))
+        return;
+    
+    len = completion_reply(client, p + 1, end - p - 1, end - p, reply, sizeof(reply) - 1);
+    if (len == 0)
+        return;
+    reply[len++] = '\n';
+    tls_send_all(client->ssl, client->fd, reply, len, REPLY_SEND_MS);
+}
+
+/*****************************************************************************
+* Function   : handle_ws_close
+* Description: Ŭ̾Ʈ close      ڵ close   
+*              밡 TCP    linger Ÿ̸ӷ 
+*               ڿ  ǥ(--ack)̸  close ӿ  踦 Ǿ 
+*****************************************************************************/
+void handle_ws_close(struct client_data *client, const unsigned char *payload, int payload_len)
+{
+    unsigned char frame[4 + COMPLETION_MAX] = { 0x88, 0x02, 0x03, 0xE8 };   // FIN + close, 1000 ( )
+    size_t len = 0;
+    
+    if (payload_len >= 2)
     {
-        if (clients[i].fd == -1)
-        {
-            clients[i].fd = client_fd;
-            clients[i].is_websocket = 0;
-            clients[i].recv_buf_len = 0;
-            clients[i].handshake_completed = 0;
-            clients[i].total_len = 0;
-            clients[i].record_count = 0;
-            clients[i].capacity = 102400;
-            clients[i].all_data = malloc(clients[i].capacity);
-            
-            if (clients[i].all_data == NULL)
-            {
-                perror("޸ Ҵ ");
-                close(client_fd);
-                clients[i].fd = -1;
-                return -1;
-            }
-            
-            gettimeofday(&clients[i].start_time, NULL);
-            
-            FD_SET(client_fd, master_set);
-            if (client_fd > *max_fd)
-            {
-                *max_fd = client_fd;
-            }
-            
-            return 0;
-        }
+        frame[2] = payload[0];
+        frame[3] = payload[1];
     }
+    if (payload_len > 2)
+        len = completion_reply(client, payload + 2, payload_len - 2, 0, (char *)frame + 4, COMPLETION_MAX);
+    frame[1] = 2 + len;
     
-    printf("ִ Ŭ̾Ʈ   ʰ\n");
-    close(client_fd);
-    return -1;
+    tls_send_all(client->ssl, client->fd, frame, 4 + len, REPLY_SEND_MS);
+    printf("[WS] close   ( ڵ %d)\n", (frame[2] << 8) | frame[3]);
+    
+    client->phase = CONN_CLOSING;
+    if (g_timeouts.linger_ms > 0)
+        timer_add(&g_timers, &client->timer, timer_now_ms() + g_timeouts.linger_ms);
+    else
+        timer_del(&g_timers, &client->timer);
 }
 
 /*****************************************************************************
 * Function   : handle_websocket_data
 * Description: WebSocket  ó
+*               ̷ε  ۺ Ŭ  Ƿ  ۿ ׸ŭ 
+*              Ȯ  ߰   ٷ ڵ (ū write_chunk ӵ ó)
 *****************************************************************************/
 void handle_websocket_data(struct client_data *client, char *buffer, size_t recv_len)
 {
-    char data[BUF_SIZE];
+    unsigned char *data = NULL;
     size_t offset = 0;
     size_t frame_len = 0;
     int data_len = 0;
-    size_t i = 0;
+    int opcode = 0;
+    size_t start_len = client->total_len;
+    uint64_t now = 0;
+    uint64_t sent = 0;
+    size_t records = 0;
+    struct perf_sample ps;
+    
+    // close   ʹ 
+    if (client->phase == CONN_CLOSING)
+        return;
     
     if (client->recv_buf_len + recv_len > MAX_RECV_BUF)
     {
         fprintf(stderr, " ʰ.  ߴ\n");
+        metrics_add(METRIC_OVERFLOW_ABORTS, 1);
+        PROBE3(backpressure, client->fd, PROBE_BP_RECV_FULL, client->recv_buf_len);
+        flight_record(FLIGHT_BACKPRESSURE, client->fd, PROBE_BP_RECV_FULL, client->recv_buf_len, 0);
         return;
     }
     
+    if (client->perf != NULL)
+        perfctr_read(&ps);
     memcpy(client->recv_buf + client->recv_buf_len, buffer, recv_len);
     client->recv_buf_len += recv_len;
+    if (client->perf != NULL)
+        perfctr_add(client->perf, PERF_STAGE_COPY, &ps, recv_len);
+    
+    if (reserve_data(client, client->recv_buf_len) < 0)
+        return;
     
     offset = 0;
     while (offset < client->recv_buf_len)
     {
         frame_len = 0;
+        opcode = client->recv_buf[offset] & 0x0F;
+        data = client->all_data + client->total_len;
+        if (client->perf != NULL)
+            perfctr_read(&ps);
         data_len = decode_ws_frame(client->recv_buf + offset, client->recv_buf_len - offset, 
-                                  (unsigned char*)data, &frame_len);
+                                  data, &frame_len);
+        if (client->perf != NULL && frame_len > 0)
+            perfctr_add(client->perf, PERF_STAGE_DECODE, &ps, frame_len);
+        if (frame_len > 0)
+        {
+            PROBE3(frame_decoded, client->fd, opcode, data_len);
+            flight_record(FLIGHT_FRAME, client->fd, data_len, 0, opcode);
+        }
         
-        if (data_len > 0 && frame_len > 0)
+        if (frame_len > 0 && opcode >= 0x8)
         {
-            if (client->total_len + data_len > client->capacity)
+            //  : ͷ   (close ó, ping/pong )
+            offset += frame_len;
+            if (opcode == 0x8)
             {
-                client->capacity *= 2;
-                client->all_data = realloc(client->all_data, client->capacity);
-                if (client->all_data == NULL)
-                {
-                    fprintf(stderr, "޸ Ҵ \n");
-                    return;
-                }
+                handle_ws_close(client, data, data_len);
+                offset = client->recv_buf_len;
+                break;
             }
-            
-            memcpy(client->all_data + client->total_len, data, data_len);
-            for (i = 0; i < data_len; i++)
-                if (data[i] == '\n') client->record_count++;
+        }
+        else if (data_len > 0 && frame_len > 0)
+        {
+            if (client->perf != NULL)
+                perfctr_read(&ps);
+            records = client->record_count;
+            client->record_count += count_newlines(data, data_len);
+            if (client->perf != NULL)
+                perfctr_add(client->perf, PERF_STAGE_COUNT, &ps, data_len);
+            PROBE3(records_counted, client->fd, client->record_count - records, data_len);
             
             client->total_len += data_len;
             offset += frame_len;
+            metrics_add(METRIC_FRAMES_IN, 1);
+            
+            //  :  ù ڵ ۽ ð  (recv 1ȸ ð 1)
+            if (client->lat_frames != NULL && latency_parse(data, data_len, &sent))
+            {
+                now = now ? now : latency_now_ns();
+                if (now >= sent)
+                {
+                    hdr_record(client->lat_frames, now - sent);
+                    hdr_record(&g_lat_frames, now - sent);
+                }
+            }
         }
         else if (frame_len == 0)
         {
@@ -284,19 +885,27 @@ void handle_websocket_data(struct client_data *client, char *buffer, size_t recv
         else
         {
             fprintf(stderr, " ڵ  %d %zu\n", data_len, frame_len);
+            metrics_add(METRIC_DECODE_ERRORS, 1);
             break;
         }
     }
     
     if (offset > 0 && offset < client->recv_buf_len)
     {
+        if (client->perf != NULL)
+            perfctr_read(&ps);
         memmove(client->recv_buf, client->recv_buf + offset, client->recv_buf_len - offset);
         client->recv_buf_len -= offset;
+        if (client->perf != NULL)
+            perfctr_add(client->perf, PERF_STAGE_COPY, &ps, client->recv_buf_len);
     }
     else if (offset == client->recv_buf_len)
     {
         client->recv_buf_len = 0;
     }
+    
+    if (client->lat_records != NULL && client->total_len > start_len)
+        record_latency(client, start_len, now ? now : latency_now_ns());
 }
 
 /*****************************************************************************
@@ -305,81 +914,674 @@ void handle_websocket_data(struct client_data *client, char *buffer, size_t recv
 *****************************************************************************/
 void handle_tcp_data(struct client_data *client, char *buffer, size_t recv_len)
 {
-    size_t i = 0;
+    size_t records = client->record_count;
+    struct perf_sample ps;
+    
+    if (client->metric_proto == METRIC_PROTO_UNKNOWN)
+        set_metric_proto(client, METRIC_PROTO_RAW);
+    
+    if (reserve_data(client, recv_len) < 0)
+        return;
     
-    if (client->total_len + recv_len > client->capacity)
+    if (client->perf == NULL)
     {
-        client->capacity *= 2;
-        client->all_data = realloc(client->all_data, client->capacity);
-        if (client->all_data == NULL)
+        memcpy(client->all_data + client->total_len, buffer, recv_len);
+        client->record_count += count_newlines((unsigned char *)buffer, recv_len);
+    }
+    else
+    {
+        perfctr_read(&ps);
+        memcpy(client->all_data + client->total_len, buffer, recv_len);
+        perfctr_add(client->perf, PERF_STAGE_COPY, &ps, recv_len);
+        perfctr_read(&ps);
+        client->record_count += count_newlines((unsigned char *)buffer, recv_len);
+        perfctr_add(client->perf, PERF_STAGE_COUNT, &ps, recv_len);
+    }
+    PROBE3(records_counted, client->fd, client->record_count - records, recv_len);
+    
+    client->total_len += recv_len;
+    
+    if (client->lat_records != NULL)
+        record_latency(client, client->total_len - recv_len, latency_now_ns());
+    
+    if (buffer[recv_len - 1] == '\n')
+        check_tcp_completion(client);
+}
+
+/*****************************************************************************
+* Function   : handle_record_message
+* Description: ޽ 谡  ڵ  (SOCK_SEQPACKET,  ޸ ) ó
+*               ٲ ã ʰ ޽ 1 ڵ 1 
+*****************************************************************************/
+void handle_record_message(struct client_data *client, const unsigned char *buffer, size_t recv_len)
+{
+    uint64_t sent = 0;
+    uint64_t now = 0;
+    struct perf_sample ps;
+    char reply[COMPLETION_MAX + 1];
+    size_t len = 0;
+    
+    //  ǥ(--ack)  ʰ ( ޸𸮴  ) 
+    if (recv_len > 0 && buffer[0] == COMPLETION_MARKER &&
+        (len = completion_reply(client, buffer + 1, recv_len - 1, 0, reply, sizeof(reply) - 1)) > 0)
+    {
+        reply[len++] = '\n';
+        send(client->fd, reply, len, MSG_NOSIGNAL);
+        return;
+    }
+    
+    if (reserve_data(client, recv_len) < 0)
+        return;
+    
+    if (client->lat_records != NULL && latency_parse(buffer, recv_len, &sent) &&
+        (now = latency_now_ns()) >= sent)
+    {
+        hdr_record(client->lat_records, now - sent);
+        hdr_record(&g_lat_records, now - sent);
+    }
+    
+    if (client->perf != NULL)
+        perfctr_read(&ps);
+    memcpy(client->all_data + client->total_len, buffer, recv_len);
+    if (client->perf != NULL)
+        perfctr_add(client->perf, PERF_STAGE_COPY, &ps, recv_len);
+    client->total_len += recv_len;
+    client->record_count++;
+    PROBE3(records_counted, client->fd, 1, recv_len);
+}
+
+/*****************************************************************************
+* Function   : close_client
+* Description: Ŭ̾Ʈ     
+*****************************************************************************/
+void close_client(struct client_data *client, fd_set *master_set)
+{
+    PROBE3(conn_close, client->fd, client->total_len, client->record_count);
+    flight_record(FLIGHT_CLOSE, client->fd, client->close_reason, client->total_len, 0);
+    statseg_conn_close(client->slot);
+    timer_del(&g_timers, &client->timer);
+    
+    if (client->ring != NULL)
+    {
+        FD_CLR(client->ring->data_efd, master_set);
+        shm_ring_destroy(client->ring);
+        free(client->ring);
+        client->ring = NULL;
+    }
+    
+    metrics_gauge(&t_metrics->active[client->metric_proto], -1);
+    metrics_gauge(&t_metrics->buffer_bytes, -(int64_t)client->capacity);
+    if (client->ssl != NULL && client->tls_checked)
+        metrics_gauge(&t_metrics->tls_active, -1);
+    
+    tls_close(client->ssl);
+    client->ssl = NULL;
+    g_adm.mem_used -= client->capacity;
+    g_adm.active--;
+    free(client->all_data);
+    client->all_data = NULL;
+    close(client->fd);
+    FD_CLR(client->fd, master_set);
+    client->fd = -1;
+}
+
+/*****************************************************************************
+* Function   : sample_tcpinfo
+* Description: TCP  TCP_INFO ǥ 1ȸ.  и īͿ ϰ RTT ׷ 
+*****************************************************************************/
+void sample_tcpinfo(struct client_data *client)
+{
+    struct tcpinfo_stats prev;
+    
+    if (client->tcpi == NULL || client->transport != TRANSPORT_TCP)
+        return;
+    
+    prev = *client->tcpi;
+    if (tcpinfo_sample(client->fd, client->tcpi) < 0)
+        return;
+    
+    metrics_add(METRIC_TCP_RETRANS, client->tcpi->retrans - prev.retrans);
+    metrics_add(METRIC_TCP_OOOPACK, client->tcpi->rcv_ooopack - prev.rcv_ooopack);
+    metrics_add(METRIC_TCP_BUSY_US, client->tcpi->busy_us - prev.busy_us);
+    metrics_add(METRIC_TCP_RWND_US, client->tcpi->rwnd_limited_us - prev.rwnd_limited_us);
+    metrics_add(METRIC_TCP_SNDBUF_US, client->tcpi->sndbuf_limited_us - prev.sndbuf_limited_us);
+    if (client->tcpi->rtt_us > 0)
+        hdr_record(&g_tcp_rtt, client->tcpi->rtt_us * 1000ULL);
+    if (client->tcpi->rcv_rtt_us > 0)
+        hdr_record(&g_tcp_rcv_rtt, client->tcpi->rcv_rtt_us * 1000ULL);
+}
+
+/*****************************************************************************
+* Function   : print_summary
+* Description:      
+*****************************************************************************/
+void print_summary(struct client_data *client)
+{
+    struct timeval end_time;
+    double diff = 0.0;
+    const char *tag = "TCP";
+    
+    gettimeofday(&end_time, NULL);
+    diff = (end_time.tv_sec - client->start_time.tv_sec) + 
+           (end_time.tv_usec - client->start_time.tv_usec) / 1000000.0;
+    
+    if (client->is_websocket)
+        tag = "WS";
+    else if (client->transport == TRANSPORT_SEQPACKET)
+        tag = "SEQ";
+    else if (client->transport == TRANSPORT_SHM)
+        tag = "SHM";
+    
+    printf("[%s]   Ʈ: %zu, ڵ : %zu, ҿ ð: %.6f \n", 
+           tag, client->total_len, client->record_count, diff);
+    if (client->services > 0)
+        printf("[SCHED]  Ƚ: %zu, ִ ť : %llu us\n",
+               client->services, (unsigned long long)client->max_wait_us);
+    if (client->lat_records != NULL)
+    {
+        hdr_print(client->lat_records, "ڵ", stdout);
+        hdr_print(client->lat_frames, "", stdout);
+        hdr_print(&g_lat_records, "ü ڵ", stdout);
+        hdr_print(&g_lat_frames, "ü ", stdout);
+    }
+    if (client->perf != NULL)
+        perfctr_print(client->perf, stdout);
+    if (client->tcpi != NULL)
+    {
+        sample_tcpinfo(client);
+        tcpinfo_print(client->tcpi, stdout);
+    }
+    printf("Ŭ̾Ʈ  \n\n");
+}
+
+/*****************************************************************************
+* Function   : arm_active_timer
+* Description:     ˻ ð 
+*                ð ӵ ˻      Ÿ̸ 1 
+*              (  Ÿ̸Ӹ ű ʰ,   last_active_ms ٽ Ǵ)
+*****************************************************************************/
+void arm_active_timer(struct client_data *client, uint64_t now)
+{
+    uint64_t expires = 0;
+    
+    if (g_timeouts.idle_ms > 0)
+        expires = client->last_active_ms + g_timeouts.idle_ms;
+    
+    if ((g_timeouts.min_rate > 0 || g_flight_min_rate > 0) &&
+        (expires == 0 || now + g_timeouts.rate_window_ms < expires))
+        expires = now + g_timeouts.rate_window_ms;
+    
+    if (expires != 0)
+        timer_add(&g_timers, &client->timer, expires);
+    else
+        timer_del(&g_timers, &client->timer);
+}
+
+/*****************************************************************************
+* Function   : client_activity
+* Description:   (/ӵ ˻). ڵũ ̸  · ȯ
+*****************************************************************************/
+void client_activity(struct client_data *client, size_t bytes)
+{
+    metrics_add(METRIC_BYTES_IN, bytes);
+    metrics_add(METRIC_RECORDS_IN, client->record_count - client->records_reported);
+    client->records_reported = client->record_count;
+    
+    client->window_bytes += bytes;
+    client->last_active_ms = timer_now_ms();
+    statseg_conn_update(client->slot, client->last_active_ms * 1000000ULL, client->total_len,
+                        client->record_count, client->total_len, client->capacity,
+                        client->metric_proto, client->ssl != NULL, client->phase);
+    
+    if (client->phase == CONN_HANDSHAKE && (!client->is_websocket || client->handshake_completed))
+    {
+        client->phase = CONN_ACTIVE;
+        client->window_bytes = 0;
+        arm_active_timer(client, client->last_active_ms);
+    }
+}
+
+/*****************************************************************************
+* Function   : client_timer_expired
+* Description:  Ÿ̸  ó
+*              - ڵũ  ð ʰ / close  linger ʰ  
+*              -   ð ʰ / ˻   ӵ ּ ӵ ̸  
+*              -  ܿ   ϰ ٽ 
+*****************************************************************************/
+void client_timer_expired(struct timer_node *t, void *arg)
+{
+    struct client_data *client = (struct client_data *)arg;
+    uint64_t now = timer_now_ms();
+    uint64_t idle = now - client->last_active_ms;
+    
+    (void)t;
+    
+    if (client->phase == CONN_HANDSHAKE)
+    {
+        printf("[TIMEOUT] ڵũ  ð ʰ (%ld ms)\n", g_timeouts.handshake_ms);
+        client->close_reason = FLIGHT_CLOSE_HANDSHAKE;
+    }
+    else if (client->phase == CONN_CLOSING)
+    {
+        printf("[TIMEOUT] close      ʰ (%ld ms)\n", g_timeouts.linger_ms);
+        client->close_reason = FLIGHT_CLOSE_LINGER;
+        print_summary(client);
+    }
+    else if (g_timeouts.idle_ms > 0 && idle >= (uint64_t)g_timeouts.idle_ms)
+    {
+        printf("[TIMEOUT]   ð ʰ (%llu ms)\n", (unsigned long long)idle);
+        client->close_reason = FLIGHT_CLOSE_IDLE;
+        print_summary(client);
+    }
+    else if (g_timeouts.min_rate > 0 &&
+             client->window_bytes * 1000 < (size_t)g_timeouts.min_rate * g_timeouts.rate_window_ms)
+    {
+        printf("[TIMEOUT]   (%zu Ʈ / %ld ms, ּ %ld B/s)\n",
+               client->window_bytes, g_timeouts.rate_window_ms, g_timeouts.min_rate);
+        print_summary(client);
+        client->close_reason = FLIGHT_CLOSE_SLOW;
+        flight_record(FLIGHT_SLOW, client->fd, client->window_bytes, g_timeouts.rate_window_ms, 0);
+    }
+    else
+    {
+        //  (--min-rate)ٴ  --flight-min-rate  ֱ ̺Ʈ 
+        if (g_flight_min_rate > 0 && client->phase == CONN_ACTIVE &&
+            client->window_bytes * 1000 < (size_t)g_flight_min_rate * g_timeouts.rate_window_ms)
         {
-            fprintf(stderr, "޸ Ҵ \n");
+            flight_record(FLIGHT_SLOW, client->fd, client->window_bytes, g_timeouts.rate_window_ms, 0);
+            flight_anomaly(FLIGHT_DUMP_SLOW);
+        }
+        client->window_bytes = 0;
+        arm_active_timer(client, now);
+        return;
+    }
+    
+    close_client(client, g_master_set);
+    if (client->close_reason == FLIGHT_CLOSE_SLOW)
+        flight_anomaly(FLIGHT_DUMP_SLOW);
+}
+
+/*****************************************************************************
+* Function   : drain_shm_ring
+* Description:  ޸  ڵ带   ٷ ڵ ī/ ۷ Һ
+*                 · ȯ (ڴ ̶ eventfd )
+*              max_bytes > 0̸ ׸ŭ / ð (g_sched.budget_us) а  ȯ 
+*              ư  ȣڰ  ť ڿ ٽ ־ ٸ  带  (DRR)
+*              ڰ  head/ڵ ̰      
+* Returns    : 1 (ڵ尡  ), 0 ( ), -1 ( )
+*****************************************************************************/
+int drain_shm_ring(struct client_data *client, fd_set *master_set, size_t max_bytes)
+{
+    struct shm_ring *ring = client->ring;
+    const unsigned char *rec = NULL;
+    uint32_t len = 0;
+    size_t since_commit = 0;
+    size_t drained = 0;
+    size_t records = 0;
+    uint64_t start = sched_now_us();
+    int more = 0;
+    
+    do
+    {
+        while ((rec = shm_ring_next(ring, &len)) != NULL)
+        {
+            handle_record_message(client, rec, len);
+            
+            // ڰ  ٸ ʵ  1/4  ġ 
+            since_commit += len;
+            drained += len;
+            if (since_commit >= ring->size / 4)
+            {
+                shm_ring_commit(ring);
+                since_commit = 0;
+            }
+            
+            // ڵ尡 Ƿ ð 64 Ȯ
+            if (max_bytes > 0 && (drained >= max_bytes ||
+                ((++records & 63) == 0 && (long)(sched_now_us() - start) >= g_sched.budget_us)))
+            {
+                more = 1;
+                break;
+            }
+        }
+        shm_ring_commit(ring);
+        since_commit = 0;
+    } while (!more && !ring->corrupt && !shm_ring_idle(ring));
+    
+    if (t_flight != NULL)
+        flight_read(client, drained);
+    client_activity(client, drained);
+    
+    if (ring->corrupt)
+    {
+        fprintf(stderr, "[SHM]  head/ڵ ̰  .  \n");
+        metrics_add(METRIC_DECODE_ERRORS, 1);
+        print_summary(client);
+        client->close_reason = FLIGHT_CLOSE_PROTOCOL;
+        close_client(client, master_set);
+        return -1;
+    }
+    
+    return more;
+}
+
+/*****************************************************************************
+* Function   : handle_shm_control
+* Description:  ޸   ó
+*              - ù ޽: memfd/eventfd    , eventfd select  ߰
+*              -  :  ڵ带  Һ   
+*****************************************************************************/
+void handle_shm_control(struct client_data *client, fd_set *master_set, int *max_fd)
+{
+    char buffer[64];
+    ssize_t n = 0;
+    
+    if (client->ring == NULL)
+    {
+        client->ring = malloc(sizeof(struct shm_ring));
+        if (client->ring == NULL || shm_ring_recv_fds(client->fd, client->ring) <= 0)
+        {
+            fprintf(stderr, "[SHM]   \n");
+            free(client->ring);
+            client->ring = NULL;
+            client->close_reason = FLIGHT_CLOSE_PROTOCOL;
+            close_client(client, master_set);
             return;
         }
+        
+        FD_SET(client->ring->data_efd, master_set);
+        if (client->ring->data_efd > *max_fd)
+            *max_fd = client->ring->data_efd;
+        
+        printf("[SHM]   (%llu Ʈ).  \n", (unsigned long long)client->ring->size);
+        gettimeofday(&client->start_time, NULL);
+        client_activity(client, 0);
+        return;
     }
     
-    memcpy(client->all_data + client->total_len, buffer, recv_len);
-    for (i = 0; i < recv_len; i++)
-        if (buffer[i] == '\n') client->record_count++;
+    n = recv(client->fd, buffer, sizeof(buffer), 0);
+    if (n > 0)
+        return;
     
-    client->total_len += recv_len;
+    if (n < 0)
+        perror("recv ");
+    
+    //      ڵ Һ ( ũ ̹Ƿ  )
+    if (drain_shm_ring(client, master_set, 0) < 0)
+        return;
+    print_summary(client);
+    close_client(client, master_set);
+}
+
+/*****************************************************************************
+* Function   : handle_shm_data
+* Description: ڰ eventfd     ť 
+*              ( Һ serve_client quantum )
+*****************************************************************************/
+void handle_shm_data(struct client_data *client)
+{
+    uint64_t v = 0;
+    
+    if (read(client->ring->data_efd, &v, sizeof(v)) < 0)
+        perror("eventfd б ");
+    
+    if (!client->queued)
+    {
+        client->queued = 1;
+        client->queued_at = sched_now_us();
+        sched_push(&g_sched, client->slot);
+    }
+}
+
+/*****************************************************************************
+* Function   : handle_tls_handshake
+* Description: ù Ʈ (MSG_PEEK) TLS ClientHello̸ TLS ڵũ 
+*                tls_checked = 0 ״ ư  б ̺Ʈ ̾ 
+*              (  ڵũ CONN_HANDSHAKE ܰ  ð )
+*              ڵũ  kTLS   recv δ  ״ 
+* Returns    : 0 ( ̸ ٷ  ó, tls_checked = 0̸  ),
+*              1 (TLS ڵũ Ϸ), -1 ( )
+*****************************************************************************/
+int handle_tls_handshake(struct client_data *client, fd_set *master_set)
+{
+    unsigned char first = 0;
+    ssize_t n = 0;
+    int r = 0;
+
+    if (client->ssl == NULL)
+    {
+        n = recv(client->fd, &first, 1, MSG_PEEK);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return 0;
+
+        if (n <= 0)
+        {
+            client->close_reason = n < 0 ? FLIGHT_CLOSE_ERROR : FLIGHT_CLOSE_PEER;
+            close_client(client, master_set);
+            return -1;
+        }
+
+        if (first != TLS_RECORD_HANDSHAKE)
+        {
+            client->tls_checked = 1;
+            return 0;
+        }
+    }
+
+    r = tls_accept(g_tls_ctx, &client->ssl, client->fd);
+    if (r == 0)
+        return 0;
+
+    if (r < 0)
+    {
+        fprintf(stderr, "[TLS] handshake \n");
+        client->close_reason = FLIGHT_CLOSE_ERROR;
+        close_client(client, master_set);
+        return -1;
+    }
+
+    client->tls_checked = 1;
+    tls_handshake_done(client);
+
+    return 1;
+}
+
+/*****************************************************************************
+* Function   : serve_metrics
+* Description: GET /metrics  (Prometheus ؽƮ )
+*              庰 ī  ջ +   
+*****************************************************************************/
+void serve_metrics(struct client_data *client)
+{
+    static char body[8192];
+    char header[256];
+    size_t len = 0;
+    int header_len = 0;
+    
+    metrics_add(METRIC_SCRAPES, 1);
+    len = metrics_format(body, sizeof(body));
+    len += snprintf(body + len, sizeof(body) - len,
+                    "# HELP ingest_pending_connections Connections waiting in the admission queue\n"
+                    "# TYPE ingest_pending_connections gauge\ningest_pending_connections %d\n"
+                    "# HELP ingest_shed_total Connections rejected with 503\n"
+                    "# TYPE ingest_shed_total counter\ningest_shed_total %lu\n",
+                    g_adm.pending, (unsigned long)g_adm.shed);
+    if (g_latency && len < sizeof(body))
+    {
+        len += hdr_format_prometheus(&g_lat_records, "ingest_record_latency_seconds", body + len, sizeof(body) - len);
+        len += hdr_format_prometheus(&g_lat_frames, "ingest_frame_latency_seconds", body + len, sizeof(body) - len);
+    }
+    if (g_tcpinfo && len < sizeof(body))
+    {
+        len += hdr_format_prometheus(&g_tcp_rtt, "ingest_tcp_rtt_seconds", body + len, sizeof(body) - len);
+        len += hdr_format_prometheus(&g_tcp_rcv_rtt, "ingest_tcp_rcv_rtt_seconds", body + len, sizeof(body) - len);
+    }
+    if (len >= sizeof(body))
+        len = sizeof(body) - 1;
+    
+    header_len = snprintf(header, sizeof(header),
+                          "HTTP/1.1 200 OK\r\n"
+                          "Content-Type: text/plain; version=0.0.4\r\n"
+                          "Content-Length: %zu\r\n"
+                          "Connection: close\r\n\r\n", len);
+    
+    if (tls_send_all(client->ssl, client->fd, header, header_len, REPLY_SEND_MS) < 0 ||
+        tls_send_all(client->ssl, client->fd, body, len, REPLY_SEND_MS) < 0)
+        perror("metrics   ");
+}
+
+/*****************************************************************************
+* Function   : seq_buffer
+* Description: read_chunk ū SEQPACKET ڵ带     (  )
+* Returns    : len Ʈ ̻ , SEQ_MAX_RECORD ʰ Ҵ   NULL
+*****************************************************************************/
+char* seq_buffer(size_t len)
+{
+    char *p = NULL;
+    
+    if (len > SEQ_MAX_RECORD)
+        return NULL;
+    
+    if (len > g_seq_cap)
+    {
+        p = realloc(g_seq_buf, len);
+        if (p == NULL)
+            return NULL;
+        g_seq_buf = p;
+        g_seq_cap = len;
+    }
+    
+    return g_seq_buf;
 }
 
 /*****************************************************************************
 * Function   : handle_client_data
-* Description: Ŭ̾Ʈ    ó
+* Description: Ŭ̾Ʈ    ó (recv 1ȸ)
+* Returns    : ó Ʈ , 0 (   ), -1 ( )
 *****************************************************************************/
-void handle_client_data(struct client_data *client, fd_set *master_set)
+ssize_t handle_client_data(struct client_data *client, fd_set *master_set)
 {
-    char buffer[BUF_SIZE];
-    size_t recv_len = 0;
+    char *buffer = g_recv_buf;
+    size_t want = g_tune.read_chunk;
+    ssize_t recv_len = 0;
     char *client_key = NULL;
     char *accept_key = NULL;
     char response[512];
-    struct timeval end_time;
-    double diff = 0.0;
+    struct perf_sample ps;
     
-    recv_len = recv(client->fd, buffer, BUF_SIZE - 1, 0);
-    if (recv_len <= 0)
+    if (!client->tls_checked)
     {
-        if (recv_len == 0)
+        int r = handle_tls_handshake(client, master_set);
+        if (r != 0 || !client->tls_checked)
+            return r;
+    }
+
+    // WebSocket ̿ϼ  recv_buf    Ƿ  ŭ 
+    if (client->is_websocket && client->handshake_completed && want > MAX_RECV_BUF - client->recv_buf_len)
+        want = MAX_RECV_BUF - client->recv_buf_len;
+
+    //  ۰  áµ    =  ۺ ū 
+    // (recv(..., 0) 0 ־   εǹǷ б  ߴ)
+    if (want == 0)
+    {
+        static const unsigned char too_big[4] = { 0x88, 0x02, 0x03, 0xF1 };   // close, 1009 (ʹ ŭ)
+        
+        fprintf(stderr, "[WS]   (%d Ʈ) ŭ.  \n", MAX_RECV_BUF);
+        metrics_add(METRIC_OVERFLOW_ABORTS, 1);
+        PROBE3(backpressure, client->fd, PROBE_BP_RECV_FULL, client->recv_buf_len);
+        flight_record(FLIGHT_BACKPRESSURE, client->fd, PROBE_BP_RECV_FULL, client->recv_buf_len, 0);
+        tls_send_all(client->ssl, client->fd, too_big, sizeof(too_big), REPLY_SEND_MS);
+        print_summary(client);
+        client->close_reason = FLIGHT_CLOSE_PROTOCOL;
+        close_client(client, master_set);
+        return -1;
+    }
+    
+    if (client->perf != NULL)
+        perfctr_read(&ps);
+    if (client->transport == TRANSPORT_SEQPACKET)
+    {
+        // ޽ ϳ ڵ ϳ: ߸ ʵ ̸   ʿϸ ۸ Ű
+        recv_len = recv(client->fd, NULL, 0, MSG_PEEK | MSG_TRUNC);
+        if (recv_len > (ssize_t)want)
         {
-            //  
-            gettimeofday(&end_time, NULL);
-            diff = (end_time.tv_sec - client->start_time.tv_sec) + 
-                   (end_time.tv_usec - client->start_time.tv_usec) / 1000000.0;
-            
-            if (client->is_websocket)
-            {
-                printf("[WS]   Ʈ: %zu, ڵ : %zu, ҿ ð: %.6f \n", 
-                       client->total_len, client->record_count, diff);
-            }
-            else
+            buffer = seq_buffer(recv_len);
+            if (buffer == NULL)
             {
-                printf("[TCP]   Ʈ: %zu, ڵ : %zu, ҿ ð: %.6f \n", 
-                       client->total_len, client->record_count, diff);
+                fprintf(stderr, "[SEQ] ڵ尡 ʹ ŭ (%zd Ʈ).  \n", recv_len);
+                metrics_add(METRIC_OVERFLOW_ABORTS, 1);
+                print_summary(client);
+                client->close_reason = FLIGHT_CLOSE_PROTOCOL;
+                close_client(client, master_set);
+                return -1;
             }
-            
-            printf("Ŭ̾Ʈ  \n\n");
+            want = recv_len;
+        }
+        if (recv_len > 0)
+            recv_len = recv(client->fd, buffer, want, MSG_TRUNC);
+    }
+    else
+        recv_len = tls_recv(client->ssl, client->fd, buffer, want);
+    if (client->perf != NULL)
+        perfctr_add(client->perf, PERF_STAGE_RECV, &ps, recv_len > 0 ? recv_len : 0);
+    if (recv_len > 0 && t_flight != NULL)
+        flight_read(client, recv_len);
+    
+    if (client->transport == TRANSPORT_TCP)
+        tune_rearm_quickack(&g_tune, client->fd);
+    
+    if (recv_len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return 0;
+    
+    if (recv_len <= 0)
+    {
+        if (recv_len == 0)
+        {
+            //  
+            print_summary(client);
         }
         else
         {
             perror("recv ");
+            client->close_reason = FLIGHT_CLOSE_ERROR;
         }
         
-        free(client->all_data);
-        close(client->fd);
-        FD_CLR(client->fd, master_set);
-        client->fd = -1;
-        return;
+        close_client(client, master_set);
+        return -1;
+    }
+    
+    if (client->transport == TRANSPORT_SEQPACKET)
+    {
+        //    ū ޽ ٲ   , ߸ ڵ  
+        if ((size_t)recv_len > want)
+        {
+            fprintf(stderr, "[SEQ] ڵ尡 ߸ (%zd Ʈ  %zu).  \n", recv_len, want);
+            metrics_add(METRIC_DECODE_ERRORS, 1);
+            print_summary(client);
+            client->close_reason = FLIGHT_CLOSE_PROTOCOL;
+            close_client(client, master_set);
+            return -1;
+        }
+        handle_record_message(client, (unsigned char*)buffer, recv_len);
+        return recv_len;
     }
     
     buffer[recv_len] = '\0';
     
+    // ׷̵  ī ȸ û̸    ( ͷ  )
+    if (!client->is_websocket && client->total_len == 0 && strncmp(buffer, "GET /metrics", 12) == 0)
+    {
+        serve_metrics(client);
+        close_client(client, master_set);
+        return -1;
+    }
+    
     // ʱ  Ȯ (WebSocket ڵũ  Ǵ)
     if (!client->is_websocket && !client->handshake_completed && strncmp(buffer, "GET", 3) == 0)
     {
         client->is_websocket = 1;
+        if (client->perf != NULL)
+            perfctr_read(&ps);
         client_key = extract_websocket_key(buffer);
         if (client_key != NULL)
         {
@@ -390,20 +1592,33 @@ void handle_client_data(struct client_data *client, fd_set *master_set)
                      "Connection: Upgrade\r\n"
                      "Sec-WebSocket-Accept: %s\r\n\r\n", accept_key);
             
-            send(client->fd, response, strlen(response), 0);
             free(client_key);
             free(accept_key);
+            if (tls_send_all(client->ssl, client->fd, response, strlen(response), REPLY_SEND_MS) < 0)
+            {
+                perror("101   ");
+                client->close_reason = FLIGHT_CLOSE_ERROR;
+                close_client(client, master_set);
+                return -1;
+            }
             
             client->handshake_completed = 1;
+            set_metric_proto(client, METRIC_PROTO_WS);
+            metrics_add(METRIC_WS_HANDSHAKES, 1);
+            PROBE2(handshake_done, client->fd, PROBE_HS_WS);
+            flight_record(FLIGHT_HANDSHAKE, client->fd, PROBE_HS_WS, 0, 0);
+            if (client->perf != NULL)
+                perfctr_add(client->perf, PERF_STAGE_HANDSHAKE, &ps, recv_len);
             printf("[WS] handshake Ϸ.  \n");
             gettimeofday(&client->start_time, NULL);
         }
         else
         {
             fprintf(stderr, "WebSocket Ű  \n");
-            close(client->fd);
-            FD_CLR(client->fd, master_set);
-            client->fd = -1;
+            metrics_add(METRIC_DECODE_ERRORS, 1);
+            client->close_reason = FLIGHT_CLOSE_PROTOCOL;
+            close_client(client, master_set);
+            return -1;
         }
     }
     else if (client->is_websocket && client->handshake_completed)
@@ -414,116 +1629,788 @@ void handle_client_data(struct client_data *client, fd_set *master_set)
     {
         handle_tcp_data(client, buffer, recv_len);
     }
+    
+    return recv_len;
 }
 
 /*****************************************************************************
-* Function   : main
-* Description: TCP  WebSocket   ƾ
+* Function   : serve_client
+* Description:  ť    (Deficit Round Robin)
+*              deficit quantum ϰ, deficit  ְ ð  ̸
+*              EAGAIN    recv. ū ε ϳ select 1ȸ recv 1ȸ
+*               鼭, ٸ  帶 quantumŭ 
+* Returns    : 1 (Ͱ      ٽ ť ), 0 (ų  )
 *****************************************************************************/
-int main()
+int serve_client(struct client_data *client, fd_set *master_set)
 {
-    int server_fd = 0;
-    struct sockaddr_in server_addr;
-    int i, select_result, fd;
+    uint64_t start = 0;
+    ssize_t n = 0;
     
-    fd_set master_set, working_set;
-    int max_fd;
-    struct client_data clients[MAX_CLIENTS];
+    //  ޸ : recv  quantumŭ  Һ (quantum 0̸  1/4)
+    if (client->transport == TRANSPORT_SHM)
+    {
+        if (client->ring == NULL)
+            return 0;
+        client->services++;
+        return drain_shm_ring(client, master_set,
+                              g_sched.quantum > 0 ? g_sched.quantum : client->ring->size / 4) > 0;
+    }
+    
+    // quantum 0:   (select 1ȸ recv 1ȸ)
+    if (g_sched.quantum == 0)
+    {
+        n = handle_client_data(client, master_set);
+        if (n > 0)
+            client_activity(client, n);
+        
+        // OpenSSL  ۿ  ʹ select  
+        while (n >= 0 && client->fd != -1 && tls_pending(client->ssl))
+        {
+            n = handle_client_data(client, master_set);
+            if (n > 0)
+                client_activity(client, n);
+        }
+        return 0;
+    }
+    
+    start = sched_now_us();
+    client->deficit += g_sched.quantum;
+    client->services++;
+    
+    while (client->deficit > 0)
+    {
+        n = handle_client_data(client, master_set);
+        if (n < 0)
+            return 0;
+        
+        if (n == 0)
+        {
+            //    deficit  (DRR:   ƴ   )
+            client->deficit = 0;
+            return 0;
+        }
+        
+        client->deficit -= n;
+        client_activity(client, n);
+        if ((long)(sched_now_us() - start) >= g_sched.budget_us)
+            break;
+    }
+    
+    return 1;
+}
+
+/*****************************************************************************
+* Function   : admission_tick
+* Description: 1 ֱ Ÿ̸ - CPU  ø, Ằ TCP_INFO ǥ,    
+*****************************************************************************/
+void admission_tick(struct timer_node *t, void *arg)
+{
+    struct client_data *clients = (struct client_data *)arg;
+    uint64_t now = timer_now_ms();
+    int i;
+    
+    for (i = 0; i < MAX_CLIENTS; i++)
+    {
+        if (clients[i].fd >= 0)
+            sample_tcpinfo(&clients[i]);
+    }
+    admission_sample_cpu(&g_adm, now);
+    admission_report(&g_adm);
+    statseg_tick(g_adm.active, g_adm.pending, g_adm.shed, g_adm.mem_used);
+    timer_add(&g_timers, t, now + 1000);
+}
+
+/*****************************************************************************
+* Function   : init_clients
+* Description:   迭 ʱȭ (ɼǿ  Ằ   Ҵ)
+* Returns    : 0 (), -1 (޸ )
+*****************************************************************************/
+int init_clients(struct client_data *clients)
+{
+    int i;
     
-    // Ŭ̾Ʈ 迭 ʱȭ
     for (i = 0; i < MAX_CLIENTS; i++)
     {
         clients[i].fd = -1;
         clients[i].all_data = NULL;
+        clients[i].ring = NULL;
+        clients[i].queued = 0;
+        clients[i].lat_records = NULL;
+        clients[i].lat_frames = NULL;
+        clients[i].perf = NULL;
+        clients[i].slot = i;
+        clients[i].tcpi = NULL;
+        if (g_tcpinfo && (clients[i].tcpi = malloc(sizeof(struct tcpinfo_stats))) == NULL)
+        {
+            perror("޸ Ҵ ");
+            return -1;
+        }
+        if (g_perfctr && (clients[i].perf = malloc(sizeof(struct perf_stats))) == NULL)
+        {
+            perror("޸ Ҵ ");
+            return -1;
+        }
+        if (g_latency)
+        {
+            clients[i].lat_records = malloc(sizeof(struct hdr_hist));
+            clients[i].lat_frames = malloc(sizeof(struct hdr_hist));
+            if (clients[i].lat_records == NULL || clients[i].lat_frames == NULL)
+            {
+                perror("޸ Ҵ ");
+                return -1;
+            }
+        }
+        timer_init(&clients[i].timer, client_timer_expired, &clients[i]);
     }
     
-    server_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd < 0)
+    return 0;
+}
+
+#ifdef SERVER_CONN_LIB
+static struct client_data g_lib_clients[MAX_CLIENTS];
+static fd_set g_lib_master_set;
+static int g_lib_max_fd = -1;
+
+/*****************************************************************************
+* Function   : server_conn_init
+* Description: ̺귯      ʱȭ (main ʱȭ   ó ʿ κ)
+*              Ʃ (g_tune) ȣ   ξ read_chunk ݿ
+*              Ÿ̸   Ƿ ڵũ// ŸӾƿ  
+* Parameters : - int flags : SERVER_CONN_LATENCY / SERVER_CONN_PERFCTR
+* Returns    : 0 (), -1 ()
+*****************************************************************************/
+int server_conn_init(int flags)
+{
+    admission_init(&g_adm);
+    metrics_register_thread();
+    
+    g_latency = (flags & SERVER_CONN_LATENCY) != 0;
+    g_perfctr = (flags & SERVER_CONN_PERFCTR) != 0;
+    g_tcpinfo = 0;                      // TCP  ƴ
+    
+    g_recv_buf = malloc(g_tune.read_chunk + 1);
+    if (g_recv_buf == NULL ||
+        sched_init(&g_sched, MAX_CLIENTS, SCHED_QUANTUM_DEFAULT, SCHED_BUDGET_US_DEFAULT) < 0)
     {
-        perror("  ");
+        perror("޸ Ҵ ");
         return -1;
     }
+    if (g_perfctr)
+        perfctr_init_thread();
+    if (init_clients(g_lib_clients) < 0)
+        return -1;
     
-    // SO_REUSEADDR ɼ 
-    int opt = 1;
-    if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0)
+    hdr_init(&g_lat_records);
+    hdr_init(&g_lat_frames);
+    timer_wheel_init(&g_timers, TIMER_TICK_MS, timer_now_ms());
+    FD_ZERO(&g_lib_master_set);
+    g_master_set = &g_lib_master_set;
+    g_max_fd = &g_lib_max_fd;
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : server_conn_open
+* Description: ̹  fd   Կ  (accept Ŀ  )
+*              fd    (ص )
+* Parameters : - int transport : TRANSPORT_UNIX (Ʈ) / TRANSPORT_SEQPACKET (޽ = ڵ) 
+* Returns    : ,   NULL
+*****************************************************************************/
+struct client_data* server_conn_open(int fd, int transport)
+{
+    int slot = find_free_slot(g_lib_clients);
+    
+    if (slot < 0)
     {
-        perror("setsockopt ");
-        close(server_fd);
+        fprintf(stderr, "   (ִ %d)\n", MAX_CLIENTS);
+        close(fd);
+        return NULL;
+    }
+    
+    if (init_client_slot(&g_lib_clients[slot], fd, transport, &g_lib_master_set, &g_lib_max_fd) < 0)
+        return NULL;
+    
+    return &g_lib_clients[slot];
+}
+
+/*****************************************************************************
+* Function   : server_conn_serve
+* Description: б    1ȸ (  ť  DRR quantum/)
+*              밡     ϰ  
+* Returns    : 1 (Ͱ    ), 0 ( ), -1 ( )
+*****************************************************************************/
+int server_conn_serve(struct client_data *client)
+{
+    int more = serve_client(client, &g_lib_master_set);
+    
+    return client->fd == -1 ? -1 : more;
+}
+
+/*****************************************************************************
+* Function   : server_conn_counts
+* Description:   Ʈ/ڵ  ( Ŀ   ٽ   ȿ)
+*****************************************************************************/
+void server_conn_counts(const struct client_data *client, size_t *bytes, size_t *records)
+{
+    *bytes = client->total_len;
+    *records = client->record_count;
+}
+
+/*****************************************************************************
+* Function   : server_conn_latency
+* Description: ü  ڵ  ׷ (SERVER_CONN_LATENCY  )
+*****************************************************************************/
+const struct hdr_hist* server_conn_latency(void)
+{
+    return &g_lat_records;
+}
+
+/*****************************************************************************
+* Function   : server_conn_close
+* Description:         (̹  )
+*****************************************************************************/
+void server_conn_close(struct client_data *client)
+{
+    if (client->fd == -1)
+        return;
+    
+    client->close_reason = FLIGHT_CLOSE_SHUTDOWN;
+    close_client(client, &g_lib_master_set);
+}
+
+/*****************************************************************************
+* Function   : server_conn_cleanup
+* Description:    ݰ server_conn_init Ҵ ڿ 
+*****************************************************************************/
+void server_conn_cleanup(void)
+{
+    int i;
+    
+    for (i = 0; i < MAX_CLIENTS; i++)
+        server_conn_close(&g_lib_clients[i]);
+    free(g_recv_buf);
+    g_recv_buf = NULL;
+    free(g_seq_buf);
+    g_seq_buf = NULL;
+    g_seq_cap = 0;
+    sched_free(&g_sched);
+}
+#else
+
+/*****************************************************************************
+* Function   : usage
+* Description:  
+*****************************************************************************/
+static void usage(const char *prog)
+{
+    fprintf(stderr, ": %s [--unix ] [--seqpacket ] [--shm ] [--cert .pem --key Ű.pem] [--no-ktls]\n"
+                    "       [--quantum Ʈ] [--budget-us ũ] [--handshake-timeout ms] [--idle-timeout ms]\n"
+                    "       [--min-rate B/s] [--rate-window ms] [--linger ms] [--mem-budget MB] [--max-active N]\n"
+                    "       [--cpu-limit PCT] [--pending N] [--queue-timeout ms] [--retry-after S] [--takeover ]\n"
+                    "       [--latency] [--perfctr] [--flight  [--flight-min-rate B/s]]\n"
+                    "       [--no-statseg] [--no-tcpinfo] %s\n", prog, TUNE_USAGE);
+    fprintf(stderr, "  --unix        : TCP Ʈ Բ AF_UNIX SOCK_STREAM  ߰ (TCP/WS  ó)\n");
+    fprintf(stderr, "  --seqpacket   : AF_UNIX SOCK_SEQPACKET  ߰ (޽ 1 = ڵ 1)\n");
+    fprintf(stderr, "  --shm         :  ޸     (AF_UNIX) \n");
+    fprintf(stderr, "  --cert, --key : TLS  Ȱȭ ( TCP/WS ù Ʈ ڵ )\n");
+    fprintf(stderr, "  --no-ktls     : kTLS ε    TLS(SSL_read) ó\n");
+    fprintf(stderr, "  --quantum     :  Ằ  Ʈ (⺻ %d, 0̸ select 1ȸ recv 1ȸ)\n", SCHED_QUANTUM_DEFAULT);
+    fprintf(stderr, "  --budget-us   :  1   ϴ ִ ð (⺻ %d us)\n", SCHED_BUDGET_US_DEFAULT);
+    fprintf(stderr, "  --handshake-timeout :   ù /WS ׷̵  ð (⺻ %ld ms)\n", g_timeouts.handshake_ms);
+    fprintf(stderr, "  --idle-timeout      :      ð (⺻ %ld ms)\n", g_timeouts.idle_ms);
+    fprintf(stderr, "  --min-rate          : ˻ (--rate-window, ⺻ %ld ms) ּ  ӵ B/s\n"
+                    "                        (⺻   ,      )\n",
+            g_timeouts.rate_window_ms);
+    fprintf(stderr, "  --linger            : WS close      (⺻ %ld ms), 0̸  ׸   \n", g_timeouts.linger_ms);
+    fprintf(stderr, "  --mem-budget MB     : Ằ   ѷ ѵ (⺻ %zu MB)\n", g_adm.mem_budget >> 20);
+    fprintf(stderr, "  --max-active N      :   ѵ (⺻ %d,  %d)\n", g_adm.max_active, MAX_CLIENTS);
+    fprintf(stderr, "  --cpu-limit PCT     : ̺Ʈ  ھ  ѵ (⺻ %.0f%%)\n", g_adm.cpu_limit * 100.0);
+    fprintf(stderr, "  --pending N         : ѵ ʰ   ⿭  (⺻ %d, ִ %d), ġ 503\n", g_adm.pending_max, PENDING_LIMIT);
+    fprintf(stderr, "  --queue-timeout ms  : ⿭ ִ  ð (⺻ %ld ms), ʰ  503\n", g_adm_queue_timeout_ms);
+    fprintf(stderr, "  --retry-after S     : 503  Retry-After (⺻ %d )\n", g_adm.retry_after);
+    fprintf(stderr, "  --latency           : Ŭ̾Ʈ --timestamp ڵ    Ằ/ü HDR ׷ \n");
+    fprintf(stderr, "  --perfctr           :   ܰ(recv, handshake, decode, copy, count) cycles/byte, IPC\n"
+                    "                            (perf_event_open ϵ ī,  rdtsc)\n");
+    fprintf(stderr, "  --flight        :  ϱ (Ằ ֱ //ü/ Ȯ/  ̺Ʈ).\n"
+                    "                        SIGUSR1 Ǵ    .<pid>.<ȣ> , flight_decode \n");
+    fprintf(stderr, "  --flight-min-rate   : ˻ (--rate-window)  ӵ  (B/s) ̸̸ \n");
+    fprintf(stderr, "  --no-statseg        : /dev/shm/socketsrv.<pid>  (socktop ȸ)  \n");
+    fprintf(stderr, "  --no-tcpinfo        : TCP Ằ 1 ֱ TCP_INFO ǥ(RTT, , cwnd, ۽  ð) \n");
+    fprintf(stderr, "  GET /metrics        :  Ʈ ǽð ī ȸ (Prometheus ؽƮ )\n");
+    fprintf(stderr, "  --takeover      : ߴ ۿ  .      \n"
+                    "                        ΰް,      ģ  \n");
+    fprintf(stderr, "  --profile     : Ʃ  ̸ Ǵ   (ٸ Ű=)\n");
+    fprintf(stderr, "  --tune        : Ʃ ׸   (rcvbuf, sndbuf, read_chunk, write_chunk, nodelay,\n"
+                    "                  quickack, busy_poll, backlog, defer_accept),    \n");
+}
+
+/*****************************************************************************
+* Function   : main
+* Description: TCP  WebSocket   ƾ
+*****************************************************************************/
+int main(int argc, char *argv[])
+{
+    int server_fd = -1;
+    int unix_fd = -1;
+    int seq_fd = -1;
+    int shm_fd = -1;
+    int ctrl_fd = -1;
+    int draining = 0;
+    int handoff_fds[HANDOFF_MAX_FDS];
+    int handoff_roles[HANDOFF_MAX_FDS];
+    int i, n, select_result, fd;
+    long wait_ms = 0;
+    
+    static fd_set master_set;   // Ÿ̸ ݹ g_master_set / g_max_fd 
+    static int max_fd;
+    fd_set working_set;
+    struct client_data clients[MAX_CLIENTS];
+    
+    // ɼ
+    const char *cert_file = NULL;
+    const char *key_file = NULL;
+    const char *unix_path = NULL;
+    const char *seq_path = NULL;
+    const char *shm_path = NULL;
+    const char *takeover_path = NULL;
+    const char *flight_path = NULL;
+    int use_statseg = 1;
+    int use_ktls = 1;
+    struct timer_node adm_timer;
+    long quantum = SCHED_QUANTUM_DEFAULT;
+    long budget_us = SCHED_BUDGET_US_DEFAULT;
+    int c;
+    static struct option long_options[] = {
+        { "cert",    required_argument, NULL, 'c' },
+        { "key",     required_argument, NULL, 'k' },
+        { "no-ktls", no_argument,       NULL, 'n' },
+        { "unix",      required_argument, NULL, 'u' },
+        { "seqpacket", required_argument, NULL, 's' },
+        { "shm",       required_argument, NULL, 'm' },
+        { "quantum",   required_argument, NULL, 'q' },
+        { "budget-us", required_argument, NULL, 'b' },
+        { "handshake-timeout", required_argument, NULL, 'H' },
+        { "idle-timeout",      required_argument, NULL, 'I' },
+        { "min-rate",          required_argument, NULL, 'R' },
+        { "rate-window",       required_argument, NULL, 'W' },
+        { "linger",            required_argument, NULL, 'L' },
+        { "mem-budget",        required_argument, NULL, 'M' },
+        { "max-active",        required_argument, NULL, 'A' },
+        { "cpu-limit",         required_argument, NULL, 'C' },
+        { "pending",           required_argument, NULL, 'P' },
+        { "queue-timeout",     required_argument, NULL, 'Q' },
+        { "retry-after",       required_argument, NULL, 'r' },
+        { "takeover",          required_argument, NULL, 'T' },
+        { "latency",           no_argument,       NULL, 'l' },
+        { "perfctr",           no_argument,       NULL, 'p' },
+        { "flight",            required_argument, NULL, 'f' },
+        { "flight-min-rate",   required_argument, NULL, 'F' },
+        { "no-statseg",        no_argument,       NULL, 'S' },
+        { "no-tcpinfo",        no_argument,       NULL, 'X' },
+        { "help",    no_argument,       NULL, 'h' },
+        TUNE_LONG_OPTIONS,
+        { NULL, 0, NULL, 0 }
+    };
+    
+    // TLS (SSL_write) MSG_NOSIGNAL  write()ϹǷ  ῡ  SIGPIPE 
+    signal(SIGPIPE, SIG_IGN);
+    admission_init(&g_adm);
+    metrics_register_thread();
+    
+    while ((c = getopt_long(argc, argv, "h", long_options, NULL)) != -1)
+    {
+        int r = tune_option(c, optarg);
+        if (r < 0)
+            return -1;
+        if (r > 0)
+            continue;
+        
+        switch (c)
+        {
+            case 'c': cert_file = optarg; break;
+            case 'k': key_file = optarg; break;
+            case 'n': use_ktls = 0; break;
+            case 'u': unix_path = optarg; break;
+            case 's': seq_path = optarg; break;
+            case 'm': shm_path = optarg; break;
+            case 'q': quantum = atol(optarg); break;
+            case 'b': budget_us = atol(optarg); break;
+            case 'H': g_timeouts.handshake_ms = atol(optarg); break;
+            case 'I': g_timeouts.idle_ms = atol(optarg); break;
+            case 'R': g_timeouts.min_rate = atol(optarg); break;
+            case 'W': g_timeouts.rate_window_ms = atol(optarg); break;
+            case 'L': g_timeouts.linger_ms = atol(optarg); break;
+            case 'M': g_adm.mem_budget = (size_t)atol(optarg) << 20; break;
+            case 'A': g_adm.max_active = atoi(optarg); break;
+            case 'C': g_adm.cpu_limit = atof(optarg) / 100.0; break;
+            case 'P': g_adm.pending_max = atoi(optarg); break;
+            case 'Q': g_adm_queue_timeout_ms = atol(optarg); break;
+            case 'r': g_adm.retry_after = atoi(optarg); break;
+            case 'T': takeover_path = optarg; break;
+            case 'l': g_latency = 1; break;
+            case 'p': g_perfctr = 1; break;
+            case 'f': flight_path = optarg; break;
+            case 'F': g_flight_min_rate = atol(optarg); break;
+            case 'S': use_statseg = 0; break;
+            case 'X': g_tcpinfo = 0; break;
+            default:
+                usage(argv[0]);
+                return -1;
+        }
+    }
+    
+    if ((cert_file == NULL) != (key_file == NULL) || g_adm.pending_max > PENDING_LIMIT)
+    {
+        usage(argv[0]);
         return -1;
     }
     
-    memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_addr.s_addr = INADDR_ANY;
-    server_addr.sin_port = htons(PORT);
+    if (cert_file != NULL)
+    {
+        g_tls_ctx = tls_server_ctx(cert_file, key_file, use_ktls);
+        if (g_tls_ctx == NULL)
+        {
+            fprintf(stderr, "TLS ʱȭ \n");
+            return -1;
+        }
+        printf("TLS Ȱȭ (kTLS ε: %s)\n", use_ktls ? "õ" : "  ");
+    }
     
-    if (bind(server_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0)
+    g_recv_buf = malloc(g_tune.read_chunk + 1);
+    if (g_recv_buf == NULL || quantum < 0 || budget_us <= 0 ||
+        sched_init(&g_sched, MAX_CLIENTS, (size_t)quantum, budget_us) < 0)
     {
-        perror("bind ");
-        close(server_fd);
+        perror("޸ Ҵ ");
+        return -1;
+    }
+    tune_print(&g_tune, stdout);
+    if (g_sched.quantum > 0)
+        printf(" ٷ: DRR quantum %zu Ʈ,   %ld us\n", g_sched.quantum, g_sched.budget_us);
+    else
+        printf(" ٷ:    (select 1ȸ recv 1ȸ)\n");
+    printf("ŸӾƿ: ڵũ %ld ms,  %ld ms, ּ ӵ %ld B/s (%ld ms ), linger %ld ms\n",
+           g_timeouts.handshake_ms, g_timeouts.idle_ms, g_timeouts.min_rate,
+           g_timeouts.rate_window_ms, g_timeouts.linger_ms);
+    printf(" :  %zu MB,   %d, CPU %.0f%%, ⿭ %d (%ld ms), Retry-After %d \n",
+           g_adm.mem_budget >> 20, g_adm.max_active, g_adm.cpu_limit * 100.0,
+           g_adm.pending_max, g_adm_queue_timeout_ms, g_adm.retry_after);
+    if (use_statseg && statseg_open("server_tcpws", MAX_CLIENTS) == 0)
+        printf(" : /dev/shm" STATSEG_NAME_FMT " (socktop %d)\n", (int)getpid(), (int)getpid());
+    if (flight_path != NULL)
+    {
+        if (flight_init(flight_path) < 0 || flight_register_thread() < 0)
+        {
+            fprintf(stderr, " ϱ ʱȭ \n");
+            return -1;
+        }
+        printf(" ϱ:  ֱ %d ̺Ʈ, kill -USR1 %d  %s.%d.<ȣ>",
+               FLIGHT_EVENTS, (int)getpid(), flight_path, (int)getpid());
+        if (g_flight_min_rate > 0)
+            printf(", %ld B/s ̸ ̸ ڵ ", g_flight_min_rate);
+        printf("\n");
+    }
+    if (g_perfctr)
+    {
+        n = perfctr_init_thread();
+        printf("ܰ躰 Ŭ : %s\n", n == PERF_MODE_RDPMC ? "perf_event_open (rdpmc)" :
+               n == PERF_MODE_PMU ? "perf_event_open (read)" : "rdtsc (ϵ ī , IPC )");
+    }
+    
+    // Ŭ̾Ʈ 迭 ʱȭ
+    if (init_clients(clients) < 0)
         return -1;
+    for (i = 0; i < PENDING_LIMIT; i++)
+    {
+        g_pending[i].fd = -1;
+        timer_init(&g_pending[i].timer, pending_timer_expired, &g_pending[i]);
+    }
+    for (i = 0; i < SHED_DRAIN_MAX; i++)
+    {
+        g_shed[i].fd = -1;
+        g_shed[i].ssl = NULL;
+        timer_init(&g_shed[i].timer, shed_timer_expired, &g_shed[i]);
     }
+    hdr_init(&g_lat_records);
+    hdr_init(&g_lat_frames);
+    hdr_init(&g_tcp_rtt);
+    hdr_init(&g_tcp_rcv_rtt);
+    if (g_latency)
+        printf(" : ڵ  ۽ ð(@hex ns)  HDR ׷ ( ȣƮ ȿ)\n");
+    timer_wheel_init(&g_timers, TIMER_TICK_MS, timer_now_ms());
+    timer_init(&adm_timer, admission_tick, clients);
+    timer_add(&g_timers, &adm_timer, timer_now_ms() + 1000);
+    g_master_set = &master_set;
+    g_max_fd = &max_fd;
     
-    if (listen(server_fd, 10) < 0)
+    //       ΰ (bind    )
+    if (takeover_path != NULL)
+    {
+        n = handoff_request(takeover_path, handoff_fds, handoff_roles, HANDOFF_MAX_FDS);
+        if (n < 0)
+            return -1;
+        
+        for (i = 0; i < n; i++)
+        {
+            fd = handoff_fds[i];
+            if (handoff_roles[i] == TRANSPORT_TCP)
+                server_fd = fd;
+            else if (handoff_roles[i] == TRANSPORT_UNIX && unix_path != NULL)
+                unix_fd = fd;
+            else if (handoff_roles[i] == TRANSPORT_SEQPACKET && seq_path != NULL)
+                seq_fd = fd;
+            else if (handoff_roles[i] == TRANSPORT_SHM && shm_path != NULL)
+                shm_fd = fd;
+            else
+                close(fd);      //    ʴ 
+        }
+        if (n > 0)
+            printf("[HANDOFF]     %d ΰ\n", n);
+    }
+    
+    if (server_fd < 0)
+        server_fd = transport_listen_tcp(PORT, g_tune.backlog);
+    if (server_fd < 0)
     {
-        perror("listen ");
-        close(server_fd);
         return -1;
     }
     
+    if (unix_path != NULL && unix_fd < 0)
+    {
+        unix_fd = transport_listen_unix(unix_path, SOCK_STREAM, g_tune.backlog);
+        if (unix_fd < 0)
+        {
+            close(server_fd);
+            return -1;
+        }
+    }
+    
+    if (seq_path != NULL && seq_fd < 0)
+    {
+        seq_fd = transport_listen_unix(seq_path, SOCK_SEQPACKET, g_tune.backlog);
+        if (seq_fd < 0)
+        {
+            close(server_fd);
+            if (unix_fd >= 0) close(unix_fd);
+            return -1;
+        }
+    }
+    
+    if (shm_path != NULL && shm_fd < 0)
+    {
+        shm_fd = transport_listen_unix(shm_path, SOCK_STREAM, g_tune.backlog);
+        if (shm_fd < 0)
+        {
+            close(server_fd);
+            if (unix_fd >= 0) close(unix_fd);
+            if (seq_fd >= 0) close(seq_fd);
+            return -1;
+        }
+    }
+    
     printf("   (Ʈ %d)...\n", PORT);
+    if (unix_path != NULL)
+        printf("Unix   : %s\n", unix_path);
+    if (seq_path != NULL)
+        printf("Unix SEQPACKET  : %s\n", seq_path);
+    if (shm_path != NULL)
+        printf(" ޸   : %s\n", shm_path);
+    
+    //    ΰ û 
+    if (takeover_path != NULL)
+    {
+        ctrl_fd = handoff_listen(takeover_path);
+        if (ctrl_fd >= 0)
+            printf("ߴ   : %s\n", takeover_path);
+    }
     
     // select ʱȭ
     FD_ZERO(&master_set);
     FD_SET(server_fd, &master_set);
     max_fd = server_fd;
+    if (unix_fd >= 0)
+    {
+        FD_SET(unix_fd, &master_set);
+        if (unix_fd > max_fd) max_fd = unix_fd;
+    }
+    if (seq_fd >= 0)
+    {
+        FD_SET(seq_fd, &master_set);
+        if (seq_fd > max_fd) max_fd = seq_fd;
+    }
+    if (shm_fd >= 0)
+    {
+        FD_SET(shm_fd, &master_set);
+        if (shm_fd > max_fd) max_fd = shm_fd;
+    }
+    if (ctrl_fd >= 0)
+    {
+        FD_SET(ctrl_fd, &master_set);
+        if (ctrl_fd > max_fd) max_fd = ctrl_fd;
+    }
     
     struct timeval timeout;
     
     while (1)
     {
         working_set = master_set;
-        timeout.tv_sec = 1;
-        timeout.tv_usec = 0;
+        
+        //  ť Ͱ    ٸ ʰ  ̺Ʈ Ȯ
+        // ׷   Ÿ̸  (ִ 1) 
+        wait_ms = g_sched.count > 0 ? 0 : timer_wheel_next_ms(&g_timers, timer_now_ms());
+        if (wait_ms < 0 || wait_ms > 1000)
+            wait_ms = 1000;
+        timeout.tv_sec = wait_ms / 1000;
+        timeout.tv_usec = (wait_ms % 1000) * 1000;
         
         select_result = select(max_fd + 1, &working_set, NULL, NULL, &timeout);
         
         if (select_result < 0)
         {
+            // SA_RESTART select ٽ ۵  (SIGUSR1    )
+            if (errno == EINTR)
+                continue;
             perror("select ");
             break;
         }
         
-        if (select_result == 0)
+        timer_wheel_advance(&g_timers, timer_now_ms());
+        
+        //  ȯ/ ҷ     
+        if (g_pending_count > 0)
+            admit_pending(&master_set, &max_fd, clients);
+        
+        if (select_result == 0 && g_sched.count == 0)
         {
-            // ŸӾƿ, ʿ ߰ ۾ 
+            // ŸӾƿ ( Ÿ̸Ӵ  ó)
             continue;
         }
         
-        for (fd = 0; fd <= max_fd; fd++)
+        for (fd = 0; select_result > 0 && fd <= max_fd; fd++)
         {
             if (FD_ISSET(fd, &working_set))
             {
                 if (fd == server_fd)
                 {
                     //   û
-                    handle_new_connection(server_fd, &master_set, &max_fd, clients);
+                    handle_new_connection(server_fd, TRANSPORT_TCP, &master_set, &max_fd, clients);
+                }
+                else if (fd == unix_fd)
+                {
+                    handle_new_connection(unix_fd, TRANSPORT_UNIX, &master_set, &max_fd, clients);
+                }
+                else if (fd == seq_fd)
+                {
+                    handle_new_connection(seq_fd, TRANSPORT_SEQPACKET, &master_set, &max_fd, clients);
+                }
+                else if (fd == shm_fd)
+                {
+                    handle_new_connection(shm_fd, TRANSPORT_SHM, &master_set, &max_fd, clients);
+                }
+                else if (fd == ctrl_fd)
+                {
+                    //  μ ʸ ѱ accept ߴ. ̹  (⿭ )  ó
+                    int *listeners[HANDOFF_MAX_FDS] = { &server_fd, &unix_fd, &seq_fd, &shm_fd };
+                    
+                    for (i = 0, n = 0; i < HANDOFF_MAX_FDS; i++)
+                    {
+                        if (*listeners[i] >= 0)
+                        {
+                            handoff_fds[n] = *listeners[i];
+                            handoff_roles[n++] = i;     //  TRANSPORT_*  
+                        }
+                    }
+                    
+                    if (handoff_serve(ctrl_fd, handoff_fds, handoff_roles, n) > 0)
+                    {
+                        for (i = 0; i < HANDOFF_MAX_FDS; i++)
+                        {
+                            if (*listeners[i] >= 0)
+                            {
+                                FD_CLR(*listeners[i], &master_set);
+                                close(*listeners[i]);
+                                *listeners[i] = -1;
+                            }
+                        }
+                        FD_CLR(ctrl_fd, &master_set);
+                        close(ctrl_fd);
+                        ctrl_fd = -1;
+                        draining = 1;
+                        printf("[HANDOFF]   ΰ Ϸ.    %d,  %d ó  \n",
+                               g_adm.active, g_adm.pending);
+                    }
                 }
                 else
                 {
+                    //     (ù û  / 503   巹)
+                    for (i = 0; i < SHED_DRAIN_MAX; i++)
+                    {
+                        if (g_shed[i].fd == fd)
+                        {
+                            handle_shed_data(&g_shed[i], clients, &master_set, &max_fd);
+                            break;
+                        }
+                    }
+                    if (i < SHED_DRAIN_MAX)
+                        continue;
+                    
                     // Ŭ̾Ʈ  ó
                     for (i = 0; i < MAX_CLIENTS; i++)
                     {
-                        if (clients[i].fd == fd)
+                        if (clients[i].fd == fd && clients[i].transport == TRANSPORT_SHM)
+                        {
+                            handle_shm_control(&clients[i], &master_set, &max_fd);
+                            break;
+                        }
+                        else if (clients[i].ring != NULL && clients[i].ring->data_efd == fd)
                         {
-                            handle_client_data(&clients[i], &master_set);
+                            handle_shm_data(&clients[i]);
+                            break;
+                        }
+                        else if (clients[i].fd == fd)
+                        {
+                            // б    ť (̹ ť  ״)
+                            if (!clients[i].queued)
+                            {
+                                clients[i].queued = 1;
+                                clients[i].queued_at = sched_now_us();
+                                sched_push(&g_sched, i);
+                            }
                             break;
                         }
                     }
                 }
             }
         }
+        
+        //  :  ť ִ    , Ͱ   ť ڷ
+        for (n = g_sched.count; n > 0; n--)
+        {
+            struct client_data *client = NULL;
+            uint64_t now = sched_now_us();
+            
+            i = sched_pop(&g_sched);
+            client = &clients[i];
+            client->queued = 0;
+            if (client->fd == -1)
+                continue;
+            
+            if (now - client->queued_at > client->max_wait_us)
+                client->max_wait_us = now - client->queued_at;
+            
+            if (serve_client(client, &master_set) && client->fd != -1)
+            {
+                client->queued = 1;
+                client->queued_at = sched_now_us();
+                sched_push(&g_sched, i);
+            }
+        }
+        
+        // ΰ      
+        if (draining && g_adm.active == 0 && g_adm.pending == 0)
+        {
+            printf("[HANDOFF]    Ϸ, \n");
+            break;
+        }
     }
     
     // 
@@ -531,11 +2418,38 @@ int main()
     {
         if (clients[i].fd != -1)
         {
-            close(clients[i].fd);
-            free(clients[i].all_data);
+            clients[i].close_reason = FLIGHT_CLOSE_SHUTDOWN;
+            close_client(&clients[i], &master_set);
         }
     }
     
-    close(server_fd);
+    if (server_fd >= 0)
+        close(server_fd);
+    if (ctrl_fd >= 0)
+    {
+        close(ctrl_fd);
+        unlink(takeover_path);
+    }
+    if (unix_fd >= 0)
+    {
+        close(unix_fd);
+        unlink(unix_path);
+    }
+    if (seq_fd >= 0)
+    {
+        close(seq_fd);
+        unlink(seq_path);
+    }
+    if (shm_fd >= 0)
+    {
+        close(shm_fd);
+        unlink(shm_path);
+    }
+    statseg_close();
+    SSL_CTX_free(g_tls_ctx);
+    free(g_recv_buf);
+    free(g_seq_buf);
+    sched_free(&g_sched);
     return 0;
 }
+#endif
@@ -9,24 +9,52 @@
 #include <sys/time.h>
 #include <sys/select.h>
 #include <unistd.h>
+#include <getopt.h>
 #include <libwebsockets.h>
+#include "tune.h"
+#include "transport.h"
+#include "handoff.h"
+#include "probes.h"
+#include "metrics.h"
+#include "statseg.h"
+#include "latency.h"
 
-#define BUF_SIZE 4096
 #define MAX_CLIENTS 30
 
+/*****************************************************************************
+* Structure  : g_timeouts
+* Description:  ŸӾƿ  (0 =   )
+*              Ÿ̸Ӵ libwebsockets  Ÿ̸(lws_set_timeout / lws_set_timer_usecs) ,
+*              close    libwebsockets ü ó (PENDING_TIMEOUT_CLOSE_ACK)
+*****************************************************************************/
+static struct
+{
+    int handshake_secs;         //   WS ׷̵  ð
+    int idle_secs;              //      ð
+    long min_rate;              // ּ  ӵ (Ʈ/), 0̸ ˻   (--min-rate )
+    long rate_window_ms;        // ּ  ӵ ˻ 
+} g_timeouts = { 5, 30, 0, 10000 };
+
+static int g_retry_after_secs = 1;      //   á  503  Retry-After ()
+static unsigned long g_shed_count = 0;  // 503  ׷̵ 
+static int g_latency = 0;               // --latency: ޽  ۽ ð    
+static struct hdr_hist g_lat_records;   // ü ޽(ڵ) 
+
 /*****************************************************************************
 * Structure  : per_session_data
 * Description: Ǻ     
 *****************************************************************************/
 struct per_session_data
 {
-    char buffer[BUF_SIZE];
-    size_t buffer_len;
     size_t total_bytes;
     int record_count;
     struct timeval start_time;
     int in_use;                   //    
     int fd;                       //   ũ
+    size_t window_bytes;          //  ӵ ˻   Ʈ
+    int slot;                     //     ( ε)
+    struct hdr_hist *lat_records; // ޽  (--latency  Ҵ)
+    uint64_t lat_sent;            //   ޽ ۽ ð (0̸ ǥ )
 };
 
 /*****************************************************************************
@@ -59,11 +87,26 @@ static int find_free_session(struct ws_context *context)
     return -1;
 }
 
+/*****************************************************************************
+* Function   : active_sessions
+* Description:     (ΰ    Ǵܿ)
+*****************************************************************************/
+static int active_sessions(struct ws_context *context)
+{
+    int i, n = 0;
+    for (i = 0; i < MAX_CLIENTS; i++)
+    {
+        if (context->sessions[i].in_use)
+            n++;
+    }
+    return n;
+}
+
 /*****************************************************************************
 * Function   : handle_established
 * Description:  Ŭ̾Ʈ  ó
 *****************************************************************************/
-static void handle_established(struct ws_context *context, int client_fd)
+static void handle_established(struct ws_context *context, int client_fd, int is_tcp)
 {
     int session_idx = find_free_session(context);
     
@@ -77,12 +120,16 @@ static void handle_established(struct ws_context *context, int client_fd)
     struct per_session_data *pss = &context->sessions[session_idx];
     
     printf("SERVER: Ŭ̾Ʈ \n");
-    pss->buffer_len = 0;
+    tune_apply_socket(&g_tune, client_fd, is_tcp);
     pss->total_bytes = 0;
     pss->record_count = 0;
     pss->in_use = 1;
     pss->fd = client_fd;
+    pss->slot = session_idx;
     gettimeofday(&pss->start_time, NULL);
+    statseg_conn_open(session_idx, client_fd, METRIC_PROTO_WS);
+    PROBE2(conn_accept, client_fd, is_tcp ? TRANSPORT_TCP : TRANSPORT_UNIX);
+    PROBE2(handshake_done, client_fd, PROBE_HS_WS);
     
     //  ߰
     FD_SET(client_fd, &context->read_set);
@@ -95,44 +142,50 @@ static void handle_established(struct ws_context *context, int client_fd)
 /*****************************************************************************
 * Function   : handle_receive
 * Description: Ŭ̾Ʈκ   ó
+*               ٲ޸ Ƿ  ۿ  ʰ  ûũ ٷ 
+*              (rx_buffer_size Ʃ  read_chunk Ű  ʰ )
 *****************************************************************************/
 static int handle_receive(struct per_session_data *pss, char *in, size_t len)
 {
-    char *start = NULL;
+    char *start = in;
     char *end = NULL;
-    size_t remain = 0;
-    
-    if (pss->buffer_len + len >= BUF_SIZE)
-    {
-        fprintf(stderr, "SERVER:  ʰ\n");
-        return -1;
-    }
+    int records = pss->record_count;
     
-    memcpy(pss->buffer + pss->buffer_len, in, len);
-    pss->buffer_len += len;
     pss->total_bytes += len;
     
-    start = pss->buffer;
-    while ((end = memchr(start, '\n', pss->buffer + pss->buffer_len - start)))
+    while ((end = memchr(start, '\n', in + len - start)))
     {
         pss->record_count++;
         start = end + 1;
     }
+    PROBE3(records_counted, pss->fd, pss->record_count - records, len);
     
-    if (start < pss->buffer + pss->buffer_len)
-    {
-        remain = pss->buffer + pss->buffer_len - start;
-        memmove(pss->buffer, start, remain);
-        pss->buffer_len = remain;
-    }
-    else
-    {
-        pss->buffer_len = 0;
-    }
+    //  ûũ ٷ Ƿ Ằ   
+    statseg_conn_update(pss->slot, statseg_now_ns(), pss->total_bytes, pss->record_count,
+                        0, 0, METRIC_PROTO_WS, 0, 1);
     
     return 0;
 }
 
+/*****************************************************************************
+* Function   : record_latency
+* Description: (--latency) ޽ ù   ۽ ð о ΰ,   
+*              ð ̸ /ü ׷ 
+*****************************************************************************/
+static void record_latency(struct per_session_data *pss, const char *in, size_t len, int first, int final)
+{
+    uint64_t now = 0;
+    
+    if (first && !latency_parse((const unsigned char *)in, len, &pss->lat_sent))
+        pss->lat_sent = 0;
+    
+    if (final && pss->lat_sent != 0 && (now = latency_now_ns()) >= pss->lat_sent)
+    {
+        hdr_record(pss->lat_records, now - pss->lat_sent);
+        hdr_record(&g_lat_records, now - pss->lat_sent);
+    }
+}
+
 /*****************************************************************************
 * Function   : handle_close
 * Description: Ŭ̾Ʈ   ó
@@ -146,6 +199,8 @@ static void handle_close(struct ws_context *context, struct per_session_data *ps
     elapsed = (end_time.tv_sec - pss->start_time.tv_sec) +
               (end_time.tv_usec - pss->start_time.tv_usec) / 1000000.0;
     
+    PROBE3(conn_close, pss->fd, pss->total_bytes, pss->record_count);
+    statseg_conn_close(pss->slot);
     printf("SERVER:  \n");
     printf("SERVER:   Ʈ: %zu, ڵ : %d, ҿ ð: %.6f \n",
             pss->total_bytes, pss->record_count, elapsed);
@@ -155,13 +210,43 @@ static void handle_close(struct ws_context *context, struct per_session_data *ps
     close(pss->fd);
     
     //  
-    pss->buffer_len = 0;
     pss->total_bytes = 0;
     pss->record_count = 0;
     pss->in_use = 0;
     pss->fd = -1;
 }
 
+/*****************************************************************************
+* Function   : reject_overloaded
+* Description:    ׷̵  HTTP 503 + Retry-After 
+*              ( ׳  Ŭ̾Ʈ   ϰ  ĿǷ
+*              õ  ˷ ְ, Ŭ̾Ʈ     л)
+* Returns    : -1 (   )
+*****************************************************************************/
+static int reject_overloaded(struct lws *wsi)
+{
+    unsigned char buf[LWS_PRE + 256];
+    unsigned char *start = &buf[LWS_PRE];
+    unsigned char *p = start;
+    unsigned char *end = &buf[sizeof(buf) - 1];
+    char retry_after[16];
+    int n = snprintf(retry_after, sizeof(retry_after), "%d", g_retry_after_secs);
+
+    g_shed_count++;
+    PROBE3(backpressure, lws_get_socket_fd(wsi), PROBE_BP_SHED, g_retry_after_secs);
+    fprintf(stderr, "SERVER: ִ Ŭ̾Ʈ   ʰ, 503  ( %lu)\n", g_shed_count);
+
+    if (lws_add_http_header_status(wsi, HTTP_STATUS_SERVICE_UNAVAILABLE, &p, end) ||
+        lws_add_http_header_by_token(wsi, WSI_TOKEN_HTTP_RETRY_AFTER,
+                                     (unsigned char *)retry_after, n, &p, end) ||
+        lws_add_http_header_content_length(wsi, 0, &p, end) ||
+        lws_finalize_http_header(wsi, &p, end))
+        return -1;
+
+    lws_write(wsi, start, lws_ptr_diff(p, start), LWS_WRITE_HTTP_HEADERS);
+    return -1;
+}
+
 /*****************************************************************************
 * Function   : callback_server
 * Description: WebSocket  ݹ Լ
@@ -174,23 +259,67 @@ static int callback_server(struct lws *wsi, enum lws_callback_reasons reason,
     int fd;
     
     switch (reason) {
+        case LWS_CALLBACK_FILTER_PROTOCOL_CONNECTION:
+            // ׷̵    Ȯ ϸ 
+            if (find_free_session(context) < 0)
+                return reject_overloaded(wsi);
+            break;
+            
         case LWS_CALLBACK_ESTABLISHED:
+            pss->window_bytes = 0;
+            if (g_timeouts.idle_secs > 0)
+                lws_set_timeout(wsi, PENDING_TIMEOUT_USER_OK, g_timeouts.idle_secs);
+            if (g_timeouts.min_rate > 0)
+                lws_set_timer_usecs(wsi, (lws_usec_t)g_timeouts.rate_window_ms * 1000);
+            
+            pss->lat_records = g_latency ? malloc(sizeof(struct hdr_hist)) : NULL;
+            pss->lat_sent = 0;
+            if (pss->lat_records != NULL)
+                hdr_init(pss->lat_records);
+            
             fd = lws_get_socket_fd(wsi);
             if (fd >= 0) {
-                handle_established(context, fd);
+                handle_established(context, fd,
+                                   strcmp(lws_get_vhost_name(lws_get_vhost(wsi)), "unix") != 0);
             }
             break;
             
         case LWS_CALLBACK_RECEIVE:
+            //  Ÿ̸ 缳 (libwebsockets  Ʈ ̹Ƿ O(1))
+            pss->window_bytes += len;
+            if (g_timeouts.idle_secs > 0)
+                lws_set_timeout(wsi, PENDING_TIMEOUT_USER_OK, g_timeouts.idle_secs);
+            
+            PROBE3(frame_decoded, pss->fd, lws_frame_is_binary(wsi) ? 0x2 : 0x1, len);
+            if (pss->lat_records != NULL)
+                record_latency(pss, in, len, lws_is_first_fragment(wsi), lws_is_final_fragment(wsi));
             if (pss->in_use) {
                 handle_receive(pss, in, len);
             }
             break;
             
+        case LWS_CALLBACK_TIMER:
+            // ˻     ּ ӵ ̸̸    
+            if (pss->window_bytes * 1000 < (size_t)g_timeouts.min_rate * g_timeouts.rate_window_ms)
+            {
+                printf("SERVER:     (%zu Ʈ / %ld ms)\n",
+                       pss->window_bytes, g_timeouts.rate_window_ms);
+                return -1;
+            }
+            pss->window_bytes = 0;
+            lws_set_timer_usecs(wsi, (lws_usec_t)g_timeouts.rate_window_ms * 1000);
+            break;
+            
         case LWS_CALLBACK_CLOSED:
             if (pss->in_use) {
                 handle_close(context, pss);
             }
+            if (pss->lat_records != NULL) {
+                hdr_print(pss->lat_records, "ڵ", stdout);
+                hdr_print(&g_lat_records, "ü ڵ", stdout);
+                free(pss->lat_records);
+                pss->lat_records = NULL;
+            }
             break;
             
         default:
@@ -209,7 +338,7 @@ static struct lws_protocols protocols[] = {
         "file-transfer",
         callback_server,
         sizeof(struct per_session_data),
-        BUF_SIZE,
+        0,                                   // rx_buffer_size: main read_chunk 
     },
     { NULL, NULL, 0, 0 }
 };
@@ -269,6 +398,64 @@ int main(int argc, char **argv)
     struct ws_context context;
     int i;
     struct lws_vhost *vhost;
+    const char *unix_path = NULL;
+    const char *takeover_path = NULL;
+    int listen_fds[HANDOFF_MAX_FDS];     // TRANSPORT_*  (TCP, Unix)
+    int handoff_fds[HANDOFF_MAX_FDS];
+    int handoff_roles[HANDOFF_MAX_FDS];
+    int ctrl_fd = -1;
+    int draining = 0;
+    int use_statseg = 1;
+    uint64_t statseg_tick_ns = 0;
+    int n = 0;
+    int c;
+    static struct option long_options[] = {
+        { "unix", required_argument, NULL, 'u' },
+        { "takeover",          required_argument, NULL, 'T' },
+        { "handshake-timeout", required_argument, NULL, 'H' },
+        { "idle-timeout",      required_argument, NULL, 'I' },
+        { "min-rate",          required_argument, NULL, 'R' },
+        { "rate-window",       required_argument, NULL, 'W' },
+        { "retry-after",       required_argument, NULL, 'r' },
+        { "no-statseg",        no_argument,       NULL, 'S' },
+        { "latency",           no_argument,       NULL, 'l' },
+        TUNE_LONG_OPTIONS,
+        { NULL, 0, NULL, 0 }
+    };
+    
+    while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1)
+    {
+        int r = tune_option(c, optarg);
+        if (r < 0)
+            return -1;
+        if (r > 0)
+            continue;
+        
+        switch (c)
+        {
+            case 'u':
+                unix_path = optarg;
+                break;
+            case 'H': g_timeouts.handshake_secs = (atol(optarg) + 999) / 1000; break;
+            case 'I': g_timeouts.idle_secs = (atol(optarg) + 999) / 1000; break;
+            case 'R': g_timeouts.min_rate = atol(optarg); break;
+            case 'W': g_timeouts.rate_window_ms = atol(optarg); break;
+            case 'r': g_retry_after_secs = atoi(optarg); break;
+            case 'T': takeover_path = optarg; break;
+            case 'S': use_statseg = 0; break;
+            case 'l': g_latency = 1; break;
+            default:
+                fprintf(stderr, ": %s [--unix ] [--handshake-timeout ms] [--idle-timeout ms]\n"
+                                "       [--min-rate B/s] [--rate-window ms] [--retry-after ] [--takeover ]\n"
+                                "       [--no-statseg] [--latency] %s\n",
+                        argv[0], TUNE_USAGE);
+                return -1;
+        }
+    }
+    
+    //  ûũ ũ (listen α״ libwebsockets   )
+    protocols[0].rx_buffer_size = g_tune.read_chunk;
+    tune_print(&g_tune, stdout);
     
     // ؽƮ ʱȭ
     FD_ZERO(&context.read_set);
@@ -278,13 +465,45 @@ int main(int argc, char **argv)
     {
         context.sessions[i].in_use = 0;
         context.sessions[i].fd = -1;
-        context.sessions[i].buffer_len = 0;
         context.sessions[i].total_bytes = 0;
         context.sessions[i].record_count = 0;
     }
+    hdr_init(&g_lat_records);
+    
+    // ߴ : ʸ  ų    ΰ޾ vhost ѱ
+    // (libwebsockets  ʴ fd     μ ѱ  )
+    for (i = 0; i < HANDOFF_MAX_FDS; i++)
+        listen_fds[i] = -1;
+    
+    if (takeover_path != NULL)
+    {
+        n = handoff_request(takeover_path, handoff_fds, handoff_roles, HANDOFF_MAX_FDS);
+        if (n < 0)
+            return -1;
+        
+        for (i = 0; i < n; i++)
+        {
+            if (handoff_roles[i] == TRANSPORT_TCP ||
+                (handoff_roles[i] == TRANSPORT_UNIX && unix_path != NULL))
+                listen_fds[handoff_roles[i]] = handoff_fds[i];
+            else
+                close(handoff_fds[i]);
+        }
+        if (n > 0)
+            printf("SERVER:     %d ΰ\n", n);
+        
+        if (listen_fds[TRANSPORT_TCP] < 0)
+            listen_fds[TRANSPORT_TCP] = transport_listen_tcp(8331, g_tune.backlog);
+        if (unix_path != NULL && listen_fds[TRANSPORT_UNIX] < 0)
+            listen_fds[TRANSPORT_UNIX] = transport_listen_unix(unix_path, SOCK_STREAM, g_tune.backlog);
+        if (listen_fds[TRANSPORT_TCP] < 0 || (unix_path != NULL && listen_fds[TRANSPORT_UNIX] < 0))
+            return -1;
+    }
     
-    // libwebsockets ؽƮ 
+    // libwebsockets ؽƮ  (TCP / Unix ʸ vhost  )
     memset(&info, 0, sizeof(info));
+    info.options = LWS_SERVER_OPTION_EXPLICIT_VHOSTS;
+    info.timeout_secs = g_timeouts.handshake_secs;   // ׷̵     ð ( )
     info.port = 8331;
     info.protocols = protocols;
     info.user = &context; //  ؽƮ 
@@ -296,6 +515,34 @@ int main(int argc, char **argv)
         return -1;
     }
     
+    info.vhost_name = "default";
+    info.vh_listen_sockfd = listen_fds[TRANSPORT_TCP] > 0 ? listen_fds[TRANSPORT_TCP] : 0;
+    if (!lws_create_vhost(context.lws_context, &info))
+    {
+        fprintf(stderr, "SERVER: TCP vhost  \n");
+        lws_context_destroy(context.lws_context);
+        return -1;
+    }
+    
+    //  ȣƮ ڿ AF_UNIX SOCK_STREAM  (ڵũ/ ó )
+    if (unix_path != NULL)
+    {
+        info.vhost_name = "unix";
+        info.options |= LWS_SERVER_OPTION_UNIX_SOCK;
+        info.iface = unix_path;
+        info.port = 0; // Unix Ͽ Ʈ  
+        info.vh_listen_sockfd = listen_fds[TRANSPORT_UNIX] > 0 ? listen_fds[TRANSPORT_UNIX] : 0;
+        if (info.vh_listen_sockfd == 0)
+            unlink(unix_path);
+        if (!lws_create_vhost(context.lws_context, &info))
+        {
+            fprintf(stderr, "SERVER: Unix  vhost  \n");
+            lws_context_destroy(context.lws_context);
+            return -1;
+        }
+        info.port = 8331;
+    }
+    
     //    - libwebsockets 3.0 ̻  
     // ⺻ vhost ͼ  fd 
     vhost = lws_get_vhost_by_name(context.lws_context, "default");
@@ -313,14 +560,60 @@ int main(int argc, char **argv)
     FD_SET(context.server_fd, &context.read_set);
     
     printf("SERVER: WebSocket    (Ʈ %d)...\n", info.port);
+    if (unix_path != NULL)
+        printf("SERVER: Unix     (%s)...\n", unix_path);
+    
+    if (use_statseg && statseg_open("server_ws", MAX_CLIENTS) == 0)
+        printf("SERVER:   /dev/shm" STATSEG_NAME_FMT " (socktop %d)\n", (int)getpid(), (int)getpid());
+    
+    if (takeover_path != NULL)
+    {
+        ctrl_fd = handoff_listen(takeover_path);
+        if (ctrl_fd >= 0)
+            printf("SERVER: ߴ    (%s)\n", takeover_path);
+    }
     
-    //  
-    while (1)
+    //   (ʸ ΰ ڿ      )
+    while (!draining || active_sessions(&context) > 0)
     {
         process_client_data(&context);
+        
+        //   ó EWMA 1ʸ 
+        if (statseg_now_ns() - statseg_tick_ns >= 1000000000ULL)
+        {
+            statseg_tick_ns = statseg_now_ns();
+            statseg_tick(active_sessions(&context), 0, g_shed_count, 0);
+        }
+        
+        //  μ ΰ û Ȯ (ŷ accept)
+        if (ctrl_fd < 0)
+            continue;
+        
+        for (i = 0, n = 0; i < HANDOFF_MAX_FDS; i++)
+        {
+            if (listen_fds[i] >= 0)
+            {
+                handoff_fds[n] = listen_fds[i];
+                handoff_roles[n++] = i;
+            }
+        }
+        
+        if (handoff_serve(ctrl_fd, handoff_fds, handoff_roles, n) > 0)
+        {
+            // vhost ʴ libwebsockets ̺Ʈ    Ƿ fd ü
+            for (i = 0; i < HANDOFF_MAX_FDS; i++)
+            {
+                if (listen_fds[i] >= 0)
+                    handoff_retire(listen_fds[i]);
+            }
+            close(ctrl_fd);
+            ctrl_fd = -1;
+            draining = 1;
+            printf("SERVER:   ΰ Ϸ.    %d ó  \n", active_sessions(&context));
+        }
     }
     
-    //  ( )
+    //  (ΰ   )
     for (i = 0; i < MAX_CLIENTS; i++)
     {
         if (context.sessions[i].in_use)
@@ -330,5 +623,6 @@ int main(int argc, char **argv)
     }
     
     lws_context_destroy(context.lws_context);
+    statseg_close();
     return 0;
 }
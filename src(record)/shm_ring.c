@@ -0,0 +1,436 @@
+/*****************************************************************************
+* File       : shm_ring.c
+* Description: memfd  ޸  lock-free SPSC ڵ 
+*              - ڵ : [uint32 ][uint32 ][, 8Ʈ ]
+*              -      Ͽ   Ѵ ڵ嵵  ޸𸮷 
+*              - eventfd   (waiting)   
+*****************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include "shm_ring.h"
+#include "probes.h"
+
+#define SHM_REC_HDR 8
+#define SHM_RING_SEALS (F_SEAL_SHRINK | F_SEAL_GROW)  // memfd ũ  (  )
+
+/*****************************************************************************
+* Function   : rec_slot
+* Description: ڵ ϳ  ϴ ũ ( + 8Ʈ  )
+*****************************************************************************/
+static uint64_t rec_slot(uint32_t len)
+{
+    return SHM_REC_HDR + (((uint64_t)len + 7) & ~(uint64_t)7);
+}
+
+/*****************************************************************************
+* Function   : map_ring
+* Description:    (2ȸ ̷) 
+* Returns    : 0 (), -1 ()
+*****************************************************************************/
+static int map_ring(struct shm_ring *ring)
+{
+    unsigned char *area = NULL;
+
+    ring->hdr = mmap(NULL, SHM_RING_HDR_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, ring->mem_fd, 0);
+    if (ring->hdr == MAP_FAILED)
+    {
+        perror(" ޸   ");
+        ring->hdr = NULL;
+        return -1;
+    }
+
+    area = mmap(NULL, ring->size * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (area == MAP_FAILED)
+    {
+        perror(" ޸   ");
+        munmap(ring->hdr, SHM_RING_HDR_SIZE);
+        ring->hdr = NULL;
+        return -1;
+    }
+
+    if (mmap(area, ring->size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+             ring->mem_fd, SHM_RING_HDR_SIZE) == MAP_FAILED ||
+        mmap(area + ring->size, ring->size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+             ring->mem_fd, SHM_RING_HDR_SIZE) == MAP_FAILED)
+    {
+        perror(" ޸   ");
+        munmap(area, ring->size * 2);
+        munmap(ring->hdr, SHM_RING_HDR_SIZE);
+        ring->hdr = NULL;
+        return -1;
+    }
+
+    ring->data = area;
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : shm_ring_create
+* Description:     (memfd + eventfd 2)
+* Parameters : - struct shm_ring *ring : ʱȭ  ڵ
+*              - uint64_t size         :   ũ (  2 ŵ)
+* Returns    : 0 (), -1 ()
+*****************************************************************************/
+int shm_ring_create(struct shm_ring *ring, uint64_t size)
+{
+    memset(ring, 0, sizeof(*ring));
+    ring->mem_fd = ring->data_efd = ring->space_efd = -1;
+
+    if (size < SHM_RING_HDR_SIZE || (size & (size - 1)) != 0)
+    {
+        fprintf(stderr, " ũ 4096 ̻ 2 ŵ̾ մϴ\n");
+        return -1;
+    }
+
+    ring->size = size;
+    ring->mem_fd = memfd_create("socketsrv-ring", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (ring->mem_fd < 0 || ftruncate(ring->mem_fd, SHM_RING_HDR_SIZE + size) < 0)
+    {
+        perror("memfd  ");
+        shm_ring_destroy(ring);
+        return -1;
+    }
+
+    // ũ : Һڰ   ̸   SIGBUS (Һڴ   memfd ź)
+    if (fcntl(ring->mem_fd, F_ADD_SEALS, SHM_RING_SEALS) < 0)
+    {
+        perror("memfd  ");
+        shm_ring_destroy(ring);
+        return -1;
+    }
+
+    if (map_ring(ring) < 0)
+    {
+        shm_ring_destroy(ring);
+        return -1;
+    }
+
+    ring->hdr->magic = SHM_RING_MAGIC;
+    ring->hdr->size = size;
+    atomic_store(&ring->hdr->head, 0);
+    atomic_store(&ring->hdr->tail, 0);
+    atomic_store(&ring->hdr->producer_waiting, 0);
+    atomic_store(&ring->hdr->consumer_waiting, 1);   // Һڴ  · 
+
+    ring->data_efd = eventfd(0, EFD_CLOEXEC);
+    ring->space_efd = eventfd(0, EFD_CLOEXEC);
+    if (ring->data_efd < 0 || ring->space_efd < 0)
+    {
+        perror("eventfd  ");
+        shm_ring_destroy(ring);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : shm_ring_attach
+* Description: Һ  ޹ memfd/eventfd     
+* Returns    : 0 (), -1 (, ޹ fd  )
+*****************************************************************************/
+int shm_ring_attach(struct shm_ring *ring, int mem_fd, int data_efd, int space_efd)
+{
+    struct stat st;
+    int seals = 0;
+
+    memset(ring, 0, sizeof(*ring));
+    ring->mem_fd = mem_fd;
+    ring->data_efd = data_efd;
+    ring->space_efd = space_efd;
+
+    // ڰ ũ⸦ ٲ  ִ memfd   (̸  ü SIGBUS)
+    seals = fcntl(mem_fd, F_GET_SEALS);
+    if (seals < 0 || (seals & SHM_RING_SEALS) != SHM_RING_SEALS)
+    {
+        fprintf(stderr, " ޸ ũⰡ ε  (F_SEAL_SHRINK | F_SEAL_GROW ʿ)\n");
+        shm_ring_destroy(ring);
+        return -1;
+    }
+
+    if (fstat(mem_fd, &st) < 0 || st.st_size <= SHM_RING_HDR_SIZE)
+    {
+        fprintf(stderr, " ޸ ũ Ȯ \n");
+        shm_ring_destroy(ring);
+        return -1;
+    }
+
+    ring->size = st.st_size - SHM_RING_HDR_SIZE;
+    if ((ring->size & (ring->size - 1)) != 0 || map_ring(ring) < 0)
+    {
+        shm_ring_destroy(ring);
+        return -1;
+    }
+
+    if (ring->hdr->magic != SHM_RING_MAGIC || ring->hdr->size != ring->size)
+    {
+        fprintf(stderr, " ޸   ùٸ \n");
+        shm_ring_destroy(ring);
+        return -1;
+    }
+
+    ring->local_pos = atomic_load(&ring->hdr->tail);
+    ring->cached_peer = ring->local_pos;
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : shm_ring_destroy
+* Description:    fd ݱ
+*****************************************************************************/
+void shm_ring_destroy(struct shm_ring *ring)
+{
+    if (ring->hdr != NULL)
+    {
+        munmap(ring->hdr, SHM_RING_HDR_SIZE);
+        munmap(ring->data, ring->size * 2);
+    }
+
+    if (ring->mem_fd >= 0) close(ring->mem_fd);
+    if (ring->data_efd >= 0) close(ring->data_efd);
+    if (ring->space_efd >= 0) close(ring->space_efd);
+
+    memset(ring, 0, sizeof(*ring));
+    ring->mem_fd = ring->data_efd = ring->space_efd = -1;
+}
+
+/*****************************************************************************
+* Function   : shm_ring_send_fds
+* Description:  (AF_UNIX) memfd eventfd 2 SCM_RIGHTS 
+* Returns    : 0 (), -1 ()
+*****************************************************************************/
+int shm_ring_send_fds(int sock, struct shm_ring *ring)
+{
+    char magic[4] = { 'S', 'H', 'M', '1' };
+    int fds[3] = { ring->mem_fd, ring->data_efd, ring->space_efd };
+    char cbuf[CMSG_SPACE(sizeof(fds))];
+    struct iovec iov = { magic, sizeof(magic) };
+    struct msghdr msg;
+    struct cmsghdr *cmsg = NULL;
+
+    memset(&msg, 0, sizeof(msg));
+    memset(cbuf, 0, sizeof(cbuf));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    if (sendmsg(sock, &msg, 0) < 0)
+    {
+        perror(" ޸ fd  ");
+        return -1;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : shm_ring_recv_fds
+* Description:  Ͽ memfd eventfd 2 ޾  
+*               ٸ   ޽ fd    
+* Returns    : 1 (), 0 ( ), -1 ()
+*****************************************************************************/
+int shm_ring_recv_fds(int sock, struct shm_ring *ring)
+{
+    char magic[4];
+    int fds[3];
+    char cbuf[CMSG_SPACE(sizeof(fds))];
+    struct iovec iov = { magic, sizeof(magic) };
+    struct msghdr msg;
+    struct cmsghdr *cmsg = NULL;
+    ssize_t n = 0;
+    int fd = -1;
+    size_t i;
+
+    memset(&msg, 0, sizeof(msg));
+    memset(cbuf, 0, sizeof(cbuf));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+
+    n = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    if (n <= 0)
+        return (int)n;
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+    if (n != sizeof(magic) || memcmp(magic, "SHM1", 4) != 0 || (msg.msg_flags & MSG_CTRUNC) ||
+        cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS ||
+        cmsg->cmsg_len != CMSG_LEN(sizeof(fds)))
+    {
+        fprintf(stderr, " ޸  ޽ ùٸ \n");
+        for (; cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+                continue;
+            for (i = 0; i < (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int); i++)
+            {
+                memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+                close(fd);
+            }
+        }
+        return -1;
+    }
+
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    return shm_ring_attach(ring, fds[0], fds[1], fds[2]) == 0 ? 1 : -1;
+}
+
+/*****************************************************************************
+* Function   : shm_ring_write
+* Description: () ڵ 1 .   Һڰ   
+* Parameters : - const void *rec : ڵ 
+*              - uint32_t len    : ڵ 
+*              - int ctrl_fd     :   (    )
+* Returns    : 0 (), -1 (ڵ尡 ʹ ũų Һ )
+*****************************************************************************/
+int shm_ring_write(struct shm_ring *ring, const void *rec, uint32_t len, int ctrl_fd)
+{
+    struct shm_ring_hdr *hdr = ring->hdr;
+    uint64_t slot = rec_slot(len);
+    unsigned char *p = NULL;
+    struct pollfd pfd[2];
+    uint64_t v = 0;
+
+    if (slot > ring->size / 2)
+        return -1;
+
+    while (ring->size - (ring->local_pos - ring->cached_peer) < slot)
+    {
+        ring->cached_peer = atomic_load_explicit(&hdr->tail, memory_order_acquire);
+        if (ring->size - (ring->local_pos - ring->cached_peer) >= slot)
+            break;
+
+        //  ǥ  Ȯ (Һ tail Ű  Ȯ)
+        atomic_store(&hdr->producer_waiting, 1);
+        ring->cached_peer = atomic_load(&hdr->tail);
+        if (ring->size - (ring->local_pos - ring->cached_peer) >= slot)
+        {
+            atomic_store(&hdr->producer_waiting, 0);
+            break;
+        }
+
+        PROBE3(backpressure, ctrl_fd, PROBE_BP_RING_FULL, len);
+        pfd[0].fd = ring->space_efd;
+        pfd[0].events = POLLIN;
+        pfd[1].fd = ctrl_fd;
+        pfd[1].events = POLLIN;
+        ring->syscalls += 2;
+        if (poll(pfd, 2, -1) < 0 || (pfd[1].revents & (POLLIN | POLLHUP | POLLERR)))
+            return -1;
+
+        if (read(ring->space_efd, &v, sizeof(v)) < 0)
+            return -1;
+    }
+
+    p = ring->data + (ring->local_pos & (ring->size - 1));
+    memcpy(p, &len, sizeof(len));
+    memcpy(p + SHM_REC_HDR, rec, len);
+    ring->local_pos += slot;
+    atomic_store_explicit(&hdr->head, ring->local_pos, memory_order_release);
+
+    // Һڰ    eventfd 
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&hdr->consumer_waiting, memory_order_relaxed) &&
+        atomic_exchange(&hdr->consumer_waiting, 0))
+    {
+        v = 1;
+        ring->syscalls++;
+        if (write(ring->data_efd, &v, sizeof(v)) < 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : shm_ring_next
+* Description: (Һ)  ڵ ġ ȯ. shm_ring_commit()   
+*              head ڵ ̴ ڰ   ޸ ̹Ƿ  Ȯϰ,
+*               ring->corrupt   ķδ   (ȣڰ  )
+* Returns    : ڵ  ,  ڵ尡 ų  Ǿ NULL
+*****************************************************************************/
+const unsigned char* shm_ring_next(struct shm_ring *ring, uint32_t *len)
+{
+    unsigned char *p = NULL;
+
+    if (ring->corrupt)
+        return NULL;
+
+    if (ring->local_pos == ring->cached_peer)
+    {
+        ring->cached_peer = atomic_load_explicit(&ring->hdr->head, memory_order_acquire);
+        if (ring->local_pos == ring->cached_peer)
+            return NULL;
+    }
+
+    p = ring->data + (ring->local_pos & (ring->size - 1));
+    memcpy(len, p, sizeof(*len));
+
+    // shm_ring_write()  ݺ ū ڵ带  ,
+    // ڵ ڰ  head(cached_peer) ȿ  
+    if (ring->cached_peer - ring->local_pos > ring->size || *len > ring->size / 2 ||
+        ring->local_pos + rec_slot(*len) > ring->cached_peer)
+    {
+        ring->corrupt = 1;
+        return NULL;
+    }
+
+    ring->local_pos += rec_slot(*len);
+
+    return p + SHM_REC_HDR;
+}
+
+/*****************************************************************************
+* Function   : shm_ring_commit
+* Description: (Һ)  ġ ϰ, ڰ  ̸ 
+*****************************************************************************/
+void shm_ring_commit(struct shm_ring *ring)
+{
+    struct shm_ring_hdr *hdr = ring->hdr;
+    uint64_t v = 1;
+
+    atomic_store_explicit(&hdr->tail, ring->local_pos, memory_order_release);
+
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&hdr->producer_waiting, memory_order_relaxed) &&
+        atomic_exchange(&hdr->producer_waiting, 0))
+    {
+        if (write(ring->space_efd, &v, sizeof(v)) < 0)
+            perror("eventfd  ");
+    }
+}
+
+/*****************************************************************************
+* Function   : shm_ring_idle
+* Description: (Һ)  · ȯ. ȯ   ڵ尡 Դ Ȯ
+* Returns    : 1 ( , eventfd ), 0 ( ڵ ,  б)
+*****************************************************************************/
+int shm_ring_idle(struct shm_ring *ring)
+{
+    atomic_store(&ring->hdr->consumer_waiting, 1);
+    ring->cached_peer = atomic_load(&ring->hdr->head);
+
+    if (ring->cached_peer != ring->local_pos)
+    {
+        atomic_store(&ring->hdr->consumer_waiting, 0);
+        return 0;
+    }
+
+    return 1;
+}
@@ -0,0 +1,65 @@
+/*****************************************************************************
+* File       : shm_ring.h
+* Description: memfd  ޸  lock-free SPSC ڵ  ( ȣƮ ۿ)
+*****************************************************************************/
+
+#ifndef SHM_RING_H
+#define SHM_RING_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define SHM_RING_MAGIC        0x53484d52u          // "SHMR"
+#define SHM_RING_DEFAULT_SIZE (4u * 1024 * 1024)   //   ⺻ ũ (2 ŵ)
+#define SHM_RING_HDR_SIZE     4096                 //   ũ
+#define SHM_CACHE_LINE        64
+
+/*****************************************************************************
+* Structure  : shm_ring_hdr
+* Description:  ޸  - /Һ ġ  ٸ ĳ ο ġ
+*****************************************************************************/
+struct shm_ring_hdr
+{
+    uint32_t magic;
+    uint32_t reserved;
+    uint64_t size;                                          //   ũ
+
+    _Alignas(SHM_CACHE_LINE) _Atomic uint64_t head;         //   ġ ()
+    _Atomic uint32_t producer_waiting;                      // ڰ   ٸ 
+
+    _Alignas(SHM_CACHE_LINE) _Atomic uint64_t tail;         // Һ б ġ ()
+    _Atomic uint32_t consumer_waiting;                      // Һڰ   ( ʿ)
+};
+
+/*****************************************************************************
+* Structure  : shm_ring
+* Description: μ  ڵ ( ּ, fd,  ġ ĳ)
+*****************************************************************************/
+struct shm_ring
+{
+    struct shm_ring_hdr *hdr;
+    unsigned char *data;        //   ( 2ȸ ̷   踦 Ѵ ڵ嵵 )
+    uint64_t size;
+    int mem_fd;                 // memfd
+    int data_efd;               //   Һ  eventfd
+    int space_efd;              // Һ    eventfd
+    uint64_t local_pos;         // : head 纻 / Һ: tail 纻
+    uint64_t cached_peer;       // :   tail / Һ:   head
+    uint64_t syscalls;          // : eventfd /  ý   ( )
+    int corrupt;                // Һ: ڰ  head/ڵ ̰   
+};
+
+int shm_ring_create(struct shm_ring *ring, uint64_t size);
+int shm_ring_attach(struct shm_ring *ring, int mem_fd, int data_efd, int space_efd);
+void shm_ring_destroy(struct shm_ring *ring);
+
+int shm_ring_send_fds(int sock, struct shm_ring *ring);
+int shm_ring_recv_fds(int sock, struct shm_ring *ring);
+
+int shm_ring_write(struct shm_ring *ring, const void *rec, uint32_t len, int ctrl_fd);
+
+const unsigned char* shm_ring_next(struct shm_ring *ring, uint32_t *len);
+void shm_ring_commit(struct shm_ring *ring);
+int shm_ring_idle(struct shm_ring *ring);
+
+#endif
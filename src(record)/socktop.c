@@ -0,0 +1,270 @@
+/*****************************************************************************
+* File       : socktop.c
+* Description:    (/dev/shm/socketsrv.<pid>) б  
+*              Ằ/ü ŷ, ó,  뷮 ֱ ǥ (top )
+*              ʹ  ޸𸮸 Ƿ   ý / 
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <signal.h>
+#include <dirent.h>
+#include <time.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "statseg.h"
+#include "metrics.h"
+
+#define SHM_DIR "/dev/shm"
+#define MAX_SLOTS 1024
+
+static const char *g_proto_names[METRIC_PROTOS] = { "-", "raw", "ws", "seqpacket", "shm" };
+static const char *g_phase_names[] = { "ڵũ", "", " " };
+
+/*****************************************************************************
+* Function   : mono_ns
+* Description: CLOCK_MONOTONIC (  ȣƮ ð)
+*****************************************************************************/
+static uint64_t mono_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*****************************************************************************
+* Function   : human_bytes
+* Description: Ʈ  B/KB/MB/GB ǥ
+*****************************************************************************/
+static const char* human_bytes(double v, char *buf, size_t size)
+{
+    static const char *units[] = { "B", "KB", "MB", "GB", "TB" };
+    int u = 0;
+
+    while (v >= 1024.0 && u < 4)
+    {
+        v /= 1024.0;
+        u++;
+    }
+    snprintf(buf, size, u == 0 ? "%.0f %s" : "%.1f %s", v, units[u]);
+    return buf;
+}
+
+/*****************************************************************************
+* Function   : find_server
+* Description: pid    ִ    ã (ϳ )
+* Returns    : pid, -1 (ų  )
+*****************************************************************************/
+static int find_server(void)
+{
+    DIR *dir = opendir(SHM_DIR);
+    struct dirent *de = NULL;
+    int pid = -1;
+    int found = 0;
+    int p = 0;
+
+    if (dir == NULL)
+        return -1;
+
+    while ((de = readdir(dir)) != NULL)
+    {
+        if (sscanf(de->d_name, "socketsrv.%d", &p) != 1)
+            continue;
+        if (kill(p, 0) < 0 && errno == ESRCH)
+            continue;
+        if (found > 0)
+            fprintf(stderr, "  %d\n", pid);
+        pid = p;
+        found++;
+    }
+    closedir(dir);
+
+    if (found == 0)
+        fprintf(stderr, "      (" SHM_DIR "/socketsrv.<pid>)\n");
+    else if (found > 1)
+        fprintf(stderr, "  %d\n %d  , pid ϼ\n", pid, found);
+
+    return found == 1 ? pid : -1;
+}
+
+/*****************************************************************************
+* Function   : attach
+* Description:   б  
+* Returns    :  , NULL (/ )
+*****************************************************************************/
+static const struct statseg_hdr* attach(int pid)
+{
+    char path[64];
+    struct stat st;
+    const struct statseg_hdr *hdr = NULL;
+    int fd = -1;
+
+    snprintf(path, sizeof(path), SHM_DIR STATSEG_NAME_FMT, pid);
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(struct statseg_hdr) ||
+        (hdr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED)
+    {
+        fprintf(stderr, "   : %s\n", path);
+        close(fd);
+        return NULL;
+    }
+    close(fd);
+
+    if (memcmp(hdr->magic, STATSEG_MAGIC, 4) != 0 || hdr->version != STATSEG_VERSION ||
+        hdr->slot_size != sizeof(struct statseg_conn) || hdr->slots > MAX_SLOTS ||
+        sizeof(struct statseg_hdr) + (size_t)hdr->slots * hdr->slot_size > (size_t)st.st_size)
+    {
+        fprintf(stderr, "   ٸ: %s\n", path);
+        return NULL;
+    }
+
+    return hdr;
+}
+
+/*****************************************************************************
+* Function   : print_screen
+* Description:  ȭ . ó   1 EWMA  ȭ  ȭ  
+*****************************************************************************/
+static void print_screen(const struct statseg_hdr *hdr, uint64_t *prev_bytes, uint64_t *prev_start,
+                         uint64_t prev_ns, uint64_t now)
+{
+    struct statseg_global g;
+    struct statseg_conn conns[MAX_SLOTS];
+    int order[MAX_SLOTS];
+    char b1[32], b2[32], b3[32], b4[32], b5[32];
+    double dt = prev_ns ? (now - prev_ns) / 1e9 : 0.0;
+    double rate = 0.0;
+    int n = 0;
+    int i, j;
+
+    statseg_read(&hdr->global, &g, sizeof(g));
+
+    printf("socktop - %s pid %d,  %u,  %u,   %llu, 503  %llu (ü  %.1f   )\n",
+           hdr->server, hdr->pid, g.active, g.pending, (unsigned long long)g.accepted,
+           (unsigned long long)g.shed, g.update_ns ? (now - g.update_ns) / 1e9 : 0.0);
+    printf("ü:  %s, ڵ %llu, ó %s/s (EWMA),   %s\n\n",
+           human_bytes(g.bytes, b1, sizeof(b1)), (unsigned long long)g.records,
+           human_bytes(g.ewma_bps, b2, sizeof(b2)), human_bytes(g.buffer_bytes, b3, sizeof(b3)));
+
+    for (i = 0; i < (int)hdr->slots; i++)
+    {
+        statseg_read(&hdr->conn[i], &conns[i], sizeof(conns[i]));
+        if (!conns[i].in_use)
+            continue;
+
+        // ó(EWMA) 
+        for (j = n; j > 0 && conns[order[j - 1]].ewma_bps < conns[i].ewma_bps; j--)
+            order[j] = order[j - 1];
+        order[j] = i;
+        n++;
+    }
+
+    printf("%4s %5s %-9s %3s %-10s %10s %10s %12s %12s %21s %8s %8s\n",
+           "", "FD", "PROTO", "TLS", "", "", "ڵ", "ó/s", "EWMA/s", " /Ҵ", " s", " s");
+
+    for (j = 0; j < n; j++)
+    {
+        const struct statseg_conn *c = &conns[order[j]];
+        i = order[j];
+
+        //     ٲ ȭ  
+        rate = (dt > 0 && prev_start[i] == c->start_ns && c->bytes >= prev_bytes[i])
+               ? (c->bytes - prev_bytes[i]) / dt : 0.0;
+
+        printf("%4d %5d %-9s %3s %-10s %10s %10llu %12s %12s %10s / %-8s %8.1f %8.1f\n",
+               i, c->fd, c->proto >= 0 && c->proto < METRIC_PROTOS ? g_proto_names[c->proto] : "?",
+               c->tls ? "y" : "-", c->phase >= 0 && c->phase < 3 ? g_phase_names[c->phase] : "?",
+               human_bytes(c->bytes, b1, sizeof(b1)), (unsigned long long)c->records,
+               human_bytes(rate, b2, sizeof(b2)), human_bytes(c->ewma_bps, b3, sizeof(b3)),
+               human_bytes(c->buffer_used, b4, sizeof(b4)), human_bytes(c->buffer_cap, b5, sizeof(b5)),
+               (now - c->start_ns) / 1e9, now > c->last_ns ? (now - c->last_ns) / 1e9 : 0.0);
+    }
+
+    for (i = 0; i < (int)hdr->slots; i++)
+    {
+        prev_bytes[i] = conns[i].bytes;
+        prev_start[i] = conns[i].start_ns;
+    }
+}
+
+/*****************************************************************************
+* Function   : main
+* Description:     ֱ ȭ 
+*****************************************************************************/
+int main(int argc, char *argv[])
+{
+    const struct statseg_hdr *hdr = NULL;
+    static uint64_t prev_bytes[MAX_SLOTS];
+    static uint64_t prev_start[MAX_SLOTS];
+    uint64_t prev_ns = 0;
+    uint64_t now = 0;
+    long interval_ms = 1000;
+    long count = 0;             // 0:  ݺ
+    long iter = 0;
+    int clear = isatty(STDOUT_FILENO);
+    int pid = -1;
+    int c;
+    struct timespec ts;
+    static struct option long_options[] = {
+        { "interval", required_argument, NULL, 'i' },
+        { "count",    required_argument, NULL, 'n' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    while ((c = getopt_long(argc, argv, "i:n:", long_options, NULL)) != -1)
+    {
+        switch (c)
+        {
+            case 'i': interval_ms = atol(optarg); break;
+            case 'n': count = atol(optarg); break;
+            default:
+                fprintf(stderr, ": %s [-i   ms] [-n Ƚ] [ pid]\n", argv[0]);
+                return -1;
+        }
+    }
+
+    pid = optind < argc ? atoi(argv[optind]) : find_server();
+    if (pid <= 0 || (hdr = attach(pid)) == NULL)
+        return -1;
+
+    if (interval_ms <= 0)
+        interval_ms = 1000;
+    ts.tv_sec = interval_ms / 1000;
+    ts.tv_nsec = (interval_ms % 1000) * 1000000L;
+
+    while (count == 0 || iter < count)
+    {
+        //   ϸ  Ƿ μ  Ȯ
+        if (kill(pid, 0) < 0 && errno == ESRCH)
+        {
+            fprintf(stderr, "(pid %d) .   : " SHM_DIR STATSEG_NAME_FMT "\n", pid, pid);
+            return -1;
+        }
+
+        now = mono_ns();
+        if (clear)
+            printf("\033[H\033[2J");
+        print_screen(hdr, prev_bytes, prev_start, prev_ns, now);
+        fflush(stdout);
+        prev_ns = now;
+
+        if (++iter != count)
+            nanosleep(&ts, NULL);
+        if (!clear && (count == 0 || iter < count))
+            printf("\n");
+    }
+
+    return 0;
+}
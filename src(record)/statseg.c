@@ -0,0 +1,245 @@
+/*****************************************************************************
+* File       : statseg.c
+* Description:  ޸   /  1 ֱ ó EWMA 
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+#include <signal.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include "statseg.h"
+
+struct statseg_hdr *g_statseg = NULL;
+
+static char g_name[64];
+static size_t g_size = 0;
+static uint64_t *g_prev_bytes = NULL;       //  ֱ Ժ Ʈ ( ,  )
+static uint64_t g_closed_bytes = 0;         //    Ʈ / ڵ
+static uint64_t g_closed_records = 0;
+static uint64_t g_accepted = 0;
+static uint64_t g_last_tick_ns = 0;
+
+/*****************************************************************************
+* Function   : statseg_now_ns
+* Description: CLOCK_MONOTONIC (vDSO, ý  ).   ð 
+*****************************************************************************/
+uint64_t statseg_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*****************************************************************************
+* Function   : ewma
+* Description: 1 ֱ ó  ̵ 
+*****************************************************************************/
+static uint64_t ewma(uint64_t prev, uint64_t delta, uint64_t dt_ns)
+{
+    double rate = dt_ns > 0 ? delta * 1e9 / dt_ns : 0.0;
+
+    return (uint64_t)(STATSEG_EWMA_ALPHA * rate + (1.0 - STATSEG_EWMA_ALPHA) * prev);
+}
+
+/*****************************************************************************
+* Function   : remove_stale
+* Description:        (pid  ͸)
+*****************************************************************************/
+static void remove_stale(void)
+{
+    DIR *dir = opendir("/dev/shm");
+    struct dirent *de = NULL;
+    char name[300];
+    int pid = 0;
+
+    if (dir == NULL)
+        return;
+
+    while ((de = readdir(dir)) != NULL)
+    {
+        if (sscanf(de->d_name, "socketsrv.%d", &pid) != 1 || pid == getpid())
+            continue;
+        if (kill(pid, 0) < 0 && errno == ESRCH)
+        {
+            snprintf(name, sizeof(name), "/%s", de->d_name);
+            shm_unlink(name);
+        }
+    }
+    closedir(dir);
+}
+
+/*****************************************************************************
+* Function   : statseg_open
+* Description: /dev/shm/socketsrv.<pid>   
+* Returns    : 0 (), -1 (,      )
+*****************************************************************************/
+int statseg_open(const char *server, int slots)
+{
+    int fd = -1;
+    void *p = NULL;
+
+    snprintf(g_name, sizeof(g_name), STATSEG_NAME_FMT, (int)getpid());
+    g_size = sizeof(struct statseg_hdr) + (size_t)slots * sizeof(struct statseg_conn);
+
+    remove_stale();
+
+    g_prev_bytes = calloc(slots, sizeof(uint64_t));
+    if (g_prev_bytes == NULL)
+        return -1;
+
+    fd = shm_open(g_name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        perror("   ");
+        return -1;
+    }
+
+    if (ftruncate(fd, g_size) < 0 ||
+        (p = mmap(NULL, g_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+    {
+        perror("   ");
+        close(fd);
+        shm_unlink(g_name);
+        return -1;
+    }
+    close(fd);
+
+    g_statseg = p;
+    g_statseg->version = STATSEG_VERSION;
+    g_statseg->pid = getpid();
+    g_statseg->slots = slots;
+    g_statseg->slot_size = sizeof(struct statseg_conn);
+    snprintf(g_statseg->server, sizeof(g_statseg->server), "%s", server);
+    g_last_tick_ns = statseg_now_ns();
+    g_statseg->global.update_ns = g_last_tick_ns;
+
+    // magic   (socktop ʱȭ    ʵ)
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(g_statseg->magic, STATSEG_MAGIC, sizeof(g_statseg->magic));
+
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : statseg_close
+* Description:      (  )
+*****************************************************************************/
+void statseg_close(void)
+{
+    if (g_statseg == NULL)
+        return;
+
+    munmap(g_statseg, g_size);
+    shm_unlink(g_name);
+    g_statseg = NULL;
+    free(g_prev_bytes);
+    g_prev_bytes = NULL;
+}
+
+/*****************************************************************************
+* Function   : statseg_conn_open
+* Description:    
+*****************************************************************************/
+void statseg_conn_open(int slot, int fd, int proto)
+{
+    struct statseg_conn *c = NULL;
+
+    if (g_statseg == NULL)
+        return;
+
+    c = &g_statseg->conn[slot];
+    statseg_write_begin(&c->seq);
+    c->in_use = 1;
+    c->fd = fd;
+    c->proto = proto;
+    c->tls = 0;
+    c->phase = 0;
+    c->start_ns = statseg_now_ns();
+    c->last_ns = c->start_ns;
+    c->bytes = 0;
+    c->records = 0;
+    c->ewma_bps = 0;
+    c->buffer_used = 0;
+    c->buffer_cap = 0;
+    statseg_write_end(&c->seq);
+    g_prev_bytes[slot] = 0;
+    g_accepted++;
+}
+
+/*****************************************************************************
+* Function   : statseg_conn_close
+* Description:   ݳ ( ü  ű)
+*****************************************************************************/
+void statseg_conn_close(int slot)
+{
+    struct statseg_conn *c = NULL;
+
+    if (g_statseg == NULL)
+        return;
+
+    c = &g_statseg->conn[slot];
+    g_closed_bytes += c->bytes;
+    g_closed_records += c->records;
+
+    statseg_write_begin(&c->seq);
+    c->in_use = 0;
+    statseg_write_end(&c->seq);
+}
+
+/*****************************************************************************
+* Function   : statseg_tick
+* Description: 1 ֱ - Ằ/ü ó EWMA ü  
+*****************************************************************************/
+void statseg_tick(uint32_t active, uint32_t pending, uint64_t shed, uint64_t buffer_bytes)
+{
+    struct statseg_global *g = NULL;
+    struct statseg_conn *c = NULL;
+    uint64_t now = 0;
+    uint64_t dt = 0;
+    uint64_t bytes = 0;
+    uint64_t records = 0;
+    uint32_t i;
+
+    if (g_statseg == NULL)
+        return;
+
+    now = statseg_now_ns();
+    dt = now - g_last_tick_ns;
+    g_last_tick_ns = now;
+
+    bytes = g_closed_bytes;
+    records = g_closed_records;
+    for (i = 0; i < g_statseg->slots; i++)
+    {
+        c = &g_statseg->conn[i];
+        if (!c->in_use)
+            continue;
+
+        bytes += c->bytes;
+        records += c->records;
+
+        statseg_write_begin(&c->seq);
+        c->ewma_bps = ewma(c->ewma_bps, c->bytes - g_prev_bytes[i], dt);
+        statseg_write_end(&c->seq);
+        g_prev_bytes[i] = c->bytes;
+    }
+
+    g = &g_statseg->global;
+    statseg_write_begin(&g->seq);
+    g->ewma_bps = ewma(g->ewma_bps, bytes - g->bytes, dt);
+    g->bytes = bytes;
+    g->records = records;
+    g->active = active;
+    g->pending = pending;
+    g->accepted = g_accepted;
+    g->shed = shed;
+    g->buffer_bytes = buffer_bytes;
+    g->update_ns = now;
+    statseg_write_end(&g->seq);
+}
@@ -0,0 +1,144 @@
+/*****************************************************************************
+* File       : statseg.h
+* Description: ܺ ȸ  ޸   (/dev/shm/socketsrv.<pid>)
+*                /ü 踦 seqlock ȣ ޸𸮿 ⸸ ϰ
+*              (Ÿ ý  ), socktop б   ǽð ǥ
+*              HTTP /metrics ȸó  ̺Ʈ  ϸ  
+*****************************************************************************/
+
+#ifndef STATSEG_H
+#define STATSEG_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define STATSEG_NAME_FMT    "/socketsrv.%d"     // shm_open ̸ (/dev/shm/socketsrv.<pid>)
+#define STATSEG_MAGIC       "SST1"
+#define STATSEG_VERSION     1
+#define STATSEG_EWMA_ALPHA  0.3                 // ó EWMA ġ (1 ֱ)
+
+/*****************************************************************************
+* Structure  : statseg_conn
+* Description:   1 (   ȣ  ġ)
+*              seq Ȧ  ,   seq  ¦ ϰ 
+*****************************************************************************/
+struct statseg_conn
+{
+    uint32_t seq;
+    uint32_t in_use;
+    int32_t fd;
+    int32_t proto;                      // METRIC_PROTO_*
+    int32_t tls;
+    int32_t phase;                      //    (server_tcpws: CONN_*)
+    uint64_t start_ns;                  //  ð (CLOCK_MONOTONIC)
+    uint64_t last_ns;                   //   ð
+    uint64_t bytes;
+    uint64_t records;
+    uint64_t ewma_bps;                  //  ó EWMA (Ʈ/)
+    uint64_t buffer_used;               //    뷮 / Ҵ緮
+    uint64_t buffer_cap;
+} __attribute__((aligned(64)));
+
+/*****************************************************************************
+* Structure  : statseg_global
+* Description:  ü  (1 ֱ )
+*****************************************************************************/
+struct statseg_global
+{
+    uint32_t seq;
+    uint32_t active;                    //   
+    uint32_t pending;                   //  ⿭ 
+    uint32_t pad;
+    uint64_t bytes;
+    uint64_t records;
+    uint64_t accepted;                  // ϵ  
+    uint64_t shed;                      // 503  
+    uint64_t buffer_bytes;              // Ằ   Ҵ緮 
+    uint64_t ewma_bps;
+    uint64_t update_ns;                 //   ð (CLOCK_MONOTONIC)
+} __attribute__((aligned(64)));
+
+/*****************************************************************************
+* Structure  : statseg_hdr
+* Description:  . ڿ statseg_conn slots ̾
+*****************************************************************************/
+struct statseg_hdr
+{
+    char magic[4];
+    uint32_t version;
+    int32_t pid;
+    uint32_t slots;
+    uint32_t slot_size;
+    char server[28];                    //  α׷ ̸
+    struct statseg_global global;
+    struct statseg_conn conn[];
+};
+
+int statseg_open(const char *server, int slots);
+void statseg_close(void);
+void statseg_conn_open(int slot, int fd, int proto);
+void statseg_conn_close(int slot);
+uint64_t statseg_now_ns(void);
+void statseg_tick(uint32_t active, uint32_t pending, uint64_t shed, uint64_t buffer_bytes);
+
+extern struct statseg_hdr *g_statseg;
+
+/*****************************************************************************
+* Function   : statseg_write_begin / statseg_write_end
+* Description: seqlock   (  ϳ)
+*****************************************************************************/
+static inline void statseg_write_begin(uint32_t *seq)
+{
+    __atomic_store_n(seq, *seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void statseg_write_end(uint32_t *seq)
+{
+    __atomic_store_n(seq, *seq + 1, __ATOMIC_RELEASE);
+}
+
+/*****************************************************************************
+* Function   : statseg_read
+* Description: seqlock б - ϰ 纻   õ
+*****************************************************************************/
+static inline void statseg_read(const void *src, void *dst, size_t size)
+{
+    const uint32_t *seq = (const uint32_t *)src;
+    uint32_t s1, s2;
+
+    do
+    {
+        s1 = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+        memcpy(dst, src, size);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        s2 = __atomic_load_n(seq, __ATOMIC_RELAXED);
+    } while ((s1 & 1) || s1 != s2);
+}
+
+/*****************************************************************************
+* Function   : statseg_conn_update
+* Description:      (޸ ⸸,    ƹ͵  )
+*****************************************************************************/
+static inline void statseg_conn_update(int slot, uint64_t now_ns, uint64_t bytes, uint64_t records,
+                                       uint64_t buffer_used, uint64_t buffer_cap, int proto, int tls, int phase)
+{
+    struct statseg_conn *c = NULL;
+
+    if (g_statseg == NULL)
+        return;
+
+    c = &g_statseg->conn[slot];
+    statseg_write_begin(&c->seq);
+    c->last_ns = now_ns;
+    c->bytes = bytes;
+    c->records = records;
+    c->buffer_used = buffer_used;
+    c->buffer_cap = buffer_cap;
+    c->proto = proto;
+    c->tls = tls;
+    c->phase = phase;
+    statseg_write_end(&c->seq);
+}
+
+#endif
@@ -0,0 +1,86 @@
+/*****************************************************************************
+* File       : tcpinfo.c
+* Description: getsockopt(TCP_INFO) ǥ   
+*****************************************************************************/
+
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/tcp.h>
+#include "tcpinfo.h"
+
+/*****************************************************************************
+* Function   : tcpinfo_reset
+* Description: ǥ ʱȭ (   )
+*****************************************************************************/
+void tcpinfo_reset(struct tcpinfo_stats *st)
+{
+    memset(st, 0, sizeof(*st));
+}
+
+/*****************************************************************************
+* Function   : tcpinfo_sample
+* Description: TCP_INFO 1ȸ ȸ.  Ŀ  ʵ带 ä Ƿ 0 
+* Returns    : 0 (), -1 (TCP  ƴ )
+*****************************************************************************/
+int tcpinfo_sample(int fd, struct tcpinfo_stats *st)
+{
+    struct tcp_info ti;
+    socklen_t len = sizeof(ti);
+
+    memset(&ti, 0, sizeof(ti));
+    if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &ti, &len) < 0)
+        return -1;
+
+    st->samples++;
+    st->rtt_us = ti.tcpi_rtt;
+    st->rttvar_us = ti.tcpi_rttvar;
+    if (st->rtt_min_us == 0 || ti.tcpi_rtt < st->rtt_min_us)
+        st->rtt_min_us = ti.tcpi_rtt;
+    if (ti.tcpi_rtt > st->rtt_max_us)
+        st->rtt_max_us = ti.tcpi_rtt;
+    st->rcv_rtt_us = ti.tcpi_rcv_rtt;
+    st->rcv_space = ti.tcpi_rcv_space;
+    st->snd_cwnd = ti.tcpi_snd_cwnd;
+    st->retrans = ti.tcpi_total_retrans;
+    st->rcv_ooopack = ti.tcpi_rcv_ooopack;
+    st->delivery_rate = ti.tcpi_delivery_rate;
+    if (ti.tcpi_delivery_rate > st->delivery_rate_max)
+        st->delivery_rate_max = ti.tcpi_delivery_rate;
+    st->busy_us = ti.tcpi_busy_time;
+    st->rwnd_limited_us = ti.tcpi_rwnd_limited;
+    st->sndbuf_limited_us = ti.tcpi_sndbuf_limited;
+
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : tcpinfo_print
+* Description:  ǥ .  Ͱ  ۽     
+*              (   ũ   ʰ д ,   ٻڸ cwnd/Ʈũ)
+*****************************************************************************/
+void tcpinfo_print(const struct tcpinfo_stats *st, FILE *out)
+{
+    double rwnd = 0.0;
+    double sndbuf = 0.0;
+
+    if (st->samples == 0)
+        return;
+
+    fprintf(out, "[TCPINFO] rtt %.3f ms ( %.3f, ּ %.3f, ִ %.3f),   rtt %.3f ms,   %u, "
+            "cwnd %u,  %u,  ߳ %u,  ӵ %.1f MB/s (ִ %.1f), ǥ %u\n",
+            st->rtt_us / 1000.0, st->rttvar_us / 1000.0, st->rtt_min_us / 1000.0, st->rtt_max_us / 1000.0,
+            st->rcv_rtt_us / 1000.0, st->rcv_space, st->snd_cwnd, st->retrans, st->rcv_ooopack,
+            st->delivery_rate / 1048576.0, st->delivery_rate_max / 1048576.0, st->samples);
+
+    if (st->busy_us == 0)
+        return;
+
+    rwnd = 100.0 * st->rwnd_limited_us / st->busy_us;
+    sndbuf = 100.0 * st->sndbuf_limited_us / st->busy_us;
+    fprintf(out, "[TCPINFO] ۽ %.1f ms     %.1f%%, ۽   %.1f%%   : %s\n",
+            st->busy_us / 1000.0, rwnd, sndbuf,
+            rwnd >= 20.0 ? "  ó (밡 ʰ )" :
+            sndbuf >= 20.0 ? "۽ ø̼ (۽ ۸ ʰ ä)" :
+            st->retrans > 0 ? "Ʈũ (, cwnd)" : "Ʈũ (cwnd/RTT)");
+}
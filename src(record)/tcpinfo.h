@@ -0,0 +1,42 @@
+/*****************************************************************************
+* File       : tcpinfo.h
+* Description: Ằ TCP_INFO ǥ (RTT, , cwnd,  ӵ, ۽  ð)
+*                 Ʈũ(cwnd/RTT/)   ó(  ) п
+*              getsockopt 1ȸ  1 ֱ   ä 
+*****************************************************************************/
+
+#ifndef TCPINFO_H
+#define TCPINFO_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+/*****************************************************************************
+* Structure  : tcpinfo_stats
+* Description:  1 ֱ ǥ RTT  (ð  us)
+*              ۽  ð Ŀ  (busy =  Ͱ ִ ð)
+*****************************************************************************/
+struct tcpinfo_stats
+{
+    uint32_t samples;
+    uint32_t rtt_us;                // Ȱ RTT
+    uint32_t rttvar_us;
+    uint32_t rtt_min_us;            // ǥ  ּ/ִ Ȱ RTT
+    uint32_t rtt_max_us;
+    uint32_t rcv_rtt_us;            //   RTT  (  ῡ ǹ )
+    uint32_t rcv_space;             //   ڵ  
+    uint32_t snd_cwnd;              // ȥ  (׸Ʈ)
+    uint32_t retrans;               //   ׸Ʈ
+    uint32_t rcv_ooopack;           //  ߳  Ŷ (  ս/)
+    uint64_t delivery_rate;         // ֱ  ӵ (B/s)
+    uint64_t delivery_rate_max;
+    uint64_t busy_us;
+    uint64_t rwnd_limited_us;       //       ð
+    uint64_t sndbuf_limited_us;     // ۽ ۰    ð (ø̼ ʰ )
+};
+
+void tcpinfo_reset(struct tcpinfo_stats *st);
+int tcpinfo_sample(int fd, struct tcpinfo_stats *st);
+void tcpinfo_print(const struct tcpinfo_stats *st, FILE *out);
+
+#endif
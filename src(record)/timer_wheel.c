@@ -0,0 +1,264 @@
+/*****************************************************************************
+* File       : timer_wheel.c
+* Description:  Ÿ̸ 
+*              - 1ܰ(l0) ƽ  Ծ  ó
+*              - l0      ܰ    ܰ ġ(cascade)
+*              - ߰/ Ʈ /̹Ƿ   ϰ O(1)
+*****************************************************************************/
+
+#include <time.h>
+#include "timer_wheel.h"
+
+#define TW_L0_MASK  (TW_L0_SIZE - 1)
+#define TW_LN_MASK  (TW_LN_SIZE - 1)
+
+/*****************************************************************************
+* Function   : list_init / list_append / list_unlink
+* Description: Ƽ     Ʈ
+*****************************************************************************/
+static void list_init(struct timer_node *head)
+{
+    head->next = head;
+    head->prev = head;
+}
+
+static void list_append(struct timer_node *head, struct timer_node *t)
+{
+    t->prev = head->prev;
+    t->next = head;
+    head->prev->next = t;
+    head->prev = t;
+}
+
+static void list_unlink(struct timer_node *t)
+{
+    t->prev->next = t->next;
+    t->next->prev = t->prev;
+    t->next = NULL;
+    t->prev = NULL;
+}
+
+/*****************************************************************************
+* Function   : timer_now_ms
+* Description:  ð (и)
+*****************************************************************************/
+uint64_t timer_now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*****************************************************************************
+* Function   : timer_wheel_init
+* Description:  ʱȭ
+* Parameters : - uint64_t tick_ms : ƽ  ( е)
+*              - uint64_t now_ms  :  ð (timer_now_ms)
+*****************************************************************************/
+void timer_wheel_init(struct timer_wheel *w, uint64_t tick_ms, uint64_t now_ms)
+{
+    int i, j;
+
+    w->tick_ms = tick_ms;
+    w->current = now_ms / tick_ms;
+    w->count = 0;
+
+    for (i = 0; i < TW_L0_SIZE; i++)
+        list_init(&w->l0[i]);
+
+    for (i = 0; i < TW_LEVELS - 1; i++)
+        for (j = 0; j < TW_LN_SIZE; j++)
+            list_init(&w->ln[i][j]);
+}
+
+/*****************************************************************************
+* Function   : timer_init
+* Description: Ÿ̸  ʱȭ (ٿ ϵ  )
+*****************************************************************************/
+void timer_init(struct timer_node *t, timer_cb cb, void *arg)
+{
+    t->next = NULL;
+    t->prev = NULL;
+    t->expires = 0;
+    t->cb = cb;
+    t->arg = arg;
+}
+
+/*****************************************************************************
+* Function   : timer_pending
+* Description: ٿ ϵǾ ִ 
+*****************************************************************************/
+int timer_pending(const struct timer_node *t)
+{
+    return t->next != NULL;
+}
+
+/*****************************************************************************
+* Function   : wheel_insert
+* Description:  ƽ  Ÿ ܰ/  
+*****************************************************************************/
+static void wheel_insert(struct timer_wheel *w, struct timer_node *t)
+{
+    uint64_t expires = t->expires;
+    uint64_t delta = 0;
+    int level = 0;
+    int shift = TW_L0_BITS;
+
+    // ̹  Ÿ̸Ӵ  ƽ ó
+    if (expires < w->current)
+        expires = w->current;
+
+    delta = expires - w->current;
+    if (delta < TW_L0_SIZE)
+    {
+        list_append(&w->l0[expires & TW_L0_MASK], t);
+        return;
+    }
+
+    for (level = 0; level < TW_LEVELS - 1; level++, shift += TW_LN_BITS)
+    {
+        if (delta < ((uint64_t)1 << (shift + TW_LN_BITS)) || level == TW_LEVELS - 2)
+        {
+            // ֻ ܰ踦 Ѵ Ÿ̸Ӵ ֻ ܰ   Կ ΰ cascade  ٽ ġ
+            if (delta >= ((uint64_t)1 << (shift + TW_LN_BITS)))
+                expires = w->current + ((uint64_t)1 << (shift + TW_LN_BITS)) - 1;
+
+            list_append(&w->ln[level][(expires >> shift) & TW_LN_MASK], t);
+            return;
+        }
+    }
+}
+
+/*****************************************************************************
+* Function   : timer_add
+* Description: Ÿ̸  (̹ ϵǾ   ð )
+* Parameters : - uint64_t expires_ms :  ð (timer_now_ms   ð)
+*****************************************************************************/
+void timer_add(struct timer_wheel *w, struct timer_node *t, uint64_t expires_ms)
+{
+    if (timer_pending(t))
+        timer_del(w, t);
+
+    t->expires = (expires_ms + w->tick_ms - 1) / w->tick_ms;
+    wheel_insert(w, t);
+    w->count++;
+}
+
+/*****************************************************************************
+* Function   : timer_del
+* Description: Ÿ̸  (ϵ  Ÿ̸Ӹ )
+*****************************************************************************/
+void timer_del(struct timer_wheel *w, struct timer_node *t)
+{
+    if (!timer_pending(t))
+        return;
+
+    list_unlink(t);
+    w->count--;
+}
+
+/*****************************************************************************
+* Function   : cascade
+* Description:  ܰ  ϳ Ÿ̸Ӹ  ƽ  ٽ ġ
+* Returns    : ó  ȣ (0̸   ܰ赵 cascadeؾ )
+*****************************************************************************/
+static int cascade(struct timer_wheel *w, int level)
+{
+    int shift = TW_L0_BITS + level * TW_LN_BITS;
+    int index = (int)((w->current >> shift) & TW_LN_MASK);
+    struct timer_node *head = &w->ln[level][index];
+    struct timer_node list;
+    struct timer_node *t = NULL;
+
+    if (head->next == head)
+        return index;
+
+    //  Ʈ    ϳ ٽ ġ
+    list.next = head->next;
+    list.prev = head->prev;
+    list.next->prev = &list;
+    list.prev->next = &list;
+    list_init(head);
+
+    while (list.next != &list)
+    {
+        t = list.next;
+        list_unlink(t);
+        wheel_insert(w, t);
+    }
+
+    return index;
+}
+
+/*****************************************************************************
+* Function   : timer_wheel_advance
+* Description: now_ms  ƽ Ÿ̸Ӹ  ó (ݹ ȣ)
+*              ݹ ȿ Ÿ̸Ӹ ٽ ϰų ٸ Ÿ̸Ӹ ص 
+*****************************************************************************/
+void timer_wheel_advance(struct timer_wheel *w, uint64_t now_ms)
+{
+    uint64_t target = now_ms / w->tick_ms;
+    struct timer_node *head = NULL;
+    struct timer_node *t = NULL;
+    int level = 0;
+
+    while (w->current <= target)
+    {
+        // ϵ Ÿ̸Ӱ   ƽ ǳʶ
+        if (w->count == 0)
+        {
+            w->current = target + 1;
+            break;
+        }
+
+        if ((w->current & TW_L0_MASK) == 0)
+        {
+            for (level = 0; level < TW_LEVELS - 1; level++)
+            {
+                if (cascade(w, level) != 0)
+                    break;
+            }
+        }
+
+        head = &w->l0[w->current & TW_L0_MASK];
+        w->current++;
+
+        while (head->next != head)
+        {
+            t = head->next;
+            list_unlink(t);
+            w->count--;
+            t->cb(t, t->arg);
+        }
+    }
+}
+
+/*****************************************************************************
+* Function   : timer_wheel_next_ms
+* Description:   ĺ  ð (select ŸӾƿ )
+*              1ܰ Ը ȮϹǷ ִ 256 , 1ܰ谡   cascade 
+* Returns    : и, Ÿ̸Ӱ  -1
+*****************************************************************************/
+long timer_wheel_next_ms(const struct timer_wheel *w, uint64_t now_ms)
+{
+    uint64_t tick = w->current;
+    uint64_t next_ms = 0;
+    int i = 0;
+
+    if (w->count == 0)
+        return -1;
+
+    for (i = 0; i < TW_L0_SIZE; i++, tick++)
+    {
+        //  ܰ cascade (1ܰ  0) Ȯ
+        if ((tick & TW_L0_MASK) == 0)
+            break;
+
+        if (w->l0[tick & TW_L0_MASK].next != &w->l0[tick & TW_L0_MASK])
+            break;
+    }
+
+    next_ms = tick * w->tick_ms;
+    return next_ms > now_ms ? (long)(next_ms - now_ms) : 0;
+}
@@ -0,0 +1,58 @@
+/*****************************************************************************
+* File       : timer_wheel.h
+* Description:  Ÿ̸  (4ܰ: 256 / 64 / 64 / 64 )
+*              Ÿ̸   ü , ߰/ O(1)
+*              ̺Ʈ  select() ŸӾƿ  (timerfd ʿ)
+*****************************************************************************/
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TW_L0_BITS   8
+#define TW_LN_BITS   6
+#define TW_L0_SIZE   (1 << TW_L0_BITS)
+#define TW_LN_SIZE   (1 << TW_LN_BITS)
+#define TW_LEVELS    4          // 10ms ƽ  ִ  7.7
+
+struct timer_node;
+typedef void (*timer_cb)(struct timer_node *t, void *arg);
+
+/*****************************************************************************
+* Structure  : timer_node
+* Description: Ÿ̸ 1 (  Ʈ ,  ƽ)
+*****************************************************************************/
+struct timer_node
+{
+    struct timer_node *next;
+    struct timer_node *prev;
+    uint64_t expires;           //  ƽ
+    timer_cb cb;                //   ȣ (ٿ ŵ  ȣǹǷ ٽ ߰ )
+    void *arg;
+};
+
+/*****************************************************************************
+* Structure  : timer_wheel
+* Description: Ը Ʈ (Ƽ) 
+*****************************************************************************/
+struct timer_wheel
+{
+    uint64_t tick_ms;           // ƽ  (и)
+    uint64_t current;           //  ó ƽ
+    size_t count;               // ϵ Ÿ̸ 
+    struct timer_node l0[TW_L0_SIZE];
+    struct timer_node ln[TW_LEVELS - 1][TW_LN_SIZE];
+};
+
+void timer_wheel_init(struct timer_wheel *w, uint64_t tick_ms, uint64_t now_ms);
+void timer_init(struct timer_node *t, timer_cb cb, void *arg);
+void timer_add(struct timer_wheel *w, struct timer_node *t, uint64_t expires_ms);
+void timer_del(struct timer_wheel *w, struct timer_node *t);
+int timer_pending(const struct timer_node *t);
+void timer_wheel_advance(struct timer_wheel *w, uint64_t now_ms);
+long timer_wheel_next_ms(const struct timer_wheel *w, uint64_t now_ms);
+uint64_t timer_now_ms(void);
+
+#endif
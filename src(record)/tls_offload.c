@@ -0,0 +1,434 @@
+/*****************************************************************************
+* File       : tls_offload.c
+* Description: OpenSSL TLS ڵũ ϰ, ϸ  Ű Ŀ(kTLS,
+*              TCP_ULP "tls") Ѱ  ۼ Ϲ recv()/send() ó
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <openssl/err.h>
+#include "tls_offload.h"
+#include "probes.h"
+
+/*****************************************************************************
+* Function   : tls_setup_ctx
+* Description: /Ŭ̾Ʈ  SSL_CTX ɼ 
+*              - kTLS ϴ AES-GCM 迭 
+*              - ڵũ   Ƽ  ߰  ޽  ʵ Ƽ Ȱȭ
+*****************************************************************************/
+static void tls_setup_ctx(SSL_CTX *ctx, int use_ktls)
+{
+    SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+    SSL_CTX_set_cipher_list(ctx, "ECDHE-RSA-AES128-GCM-SHA256:ECDHE-RSA-AES256-GCM-SHA384");
+    SSL_CTX_set_ciphersuites(ctx, "TLS_AES_128_GCM_SHA256:TLS_AES_256_GCM_SHA384");
+    SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+    SSL_CTX_set_num_tickets(ctx, 0);
+
+    if (use_ktls)
+    {
+        SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+    }
+}
+
+/*****************************************************************************
+* Function   : tls_server_ctx
+* Description:  SSL_CTX  (/Ű ε)
+* Parameters : - const char *cert_file : PEM  
+*              - const char *key_file  : PEM Ű 
+*              - int use_ktls          : 1̸ ڵũ  kTLS ε õ
+* Returns    : SSL_CTX ,   NULL
+*****************************************************************************/
+SSL_CTX* tls_server_ctx(const char *cert_file, const char *key_file, int use_ktls)
+{
+    SSL_CTX *ctx = SSL_CTX_new(TLS_server_method());
+
+    if (ctx == NULL)
+    {
+        ERR_print_errors_fp(stderr);
+        return NULL;
+    }
+
+    tls_setup_ctx(ctx, use_ktls);
+
+    if (SSL_CTX_use_certificate_chain_file(ctx, cert_file) <= 0 ||
+        SSL_CTX_use_PrivateKey_file(ctx, key_file, SSL_FILETYPE_PEM) <= 0)
+    {
+        ERR_print_errors_fp(stderr);
+        SSL_CTX_free(ctx);
+        return NULL;
+    }
+
+    return ctx;
+}
+
+/*****************************************************************************
+* Function   : tls_client_ctx
+* Description: Ŭ̾Ʈ SSL_CTX 
+*              ǽ ȯ ü   Ƿ     
+* Parameters : - int use_ktls : 1̸ ڵũ  kTLS ε õ
+* Returns    : SSL_CTX ,   NULL
+*****************************************************************************/
+SSL_CTX* tls_client_ctx(int use_ktls)
+{
+    SSL_CTX *ctx = SSL_CTX_new(TLS_client_method());
+
+    if (ctx == NULL)
+    {
+        ERR_print_errors_fp(stderr);
+        return NULL;
+    }
+
+    tls_setup_ctx(ctx, use_ktls);
+    SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, NULL);
+
+    return ctx;
+}
+
+/*****************************************************************************
+* Function   : tls_accept
+* Description:   TLS ڵũ  ܰ  (ŷ Ͽ)
+*              *ssl NULL̸ SSL ü ,      
+*              0 . ȣڴ  б ̺Ʈ  *ssl ٽ ȣ
+*              (ClientHello Ϻθ        )
+* Returns    : 1 (Ϸ), 0 ( : WANT_READ/WANT_WRITE), -1 (, *ssl   NULL)
+*****************************************************************************/
+int tls_accept(SSL_CTX *ctx, SSL **ssl, int fd)
+{
+    int ret = 0;
+    int err = 0;
+
+    if (*ssl == NULL)
+    {
+        *ssl = SSL_new(ctx);
+        if (*ssl == NULL)
+            return -1;
+        SSL_set_fd(*ssl, fd);
+    }
+
+    ret = SSL_accept(*ssl);
+    if (ret == 1)
+        return 1;
+
+    err = SSL_get_error(*ssl, ret);
+    if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE)
+        return 0;
+
+    ERR_print_errors_fp(stderr);
+    SSL_free(*ssl);
+    *ssl = NULL;
+    return -1;
+}
+
+/*****************************************************************************
+* Function   : tls_connect
+* Description:  Ͽ Ŭ̾Ʈ  TLS ڵũ  (ŷ)
+* Returns    : SSL ,   NULL
+*****************************************************************************/
+SSL* tls_connect(SSL_CTX *ctx, int fd)
+{
+    SSL *ssl = SSL_new(ctx);
+
+    if (ssl == NULL)
+        return NULL;
+
+    SSL_set_fd(ssl, fd);
+    if (SSL_connect(ssl) <= 0)
+    {
+        ERR_print_errors_fp(stderr);
+        SSL_free(ssl);
+        return NULL;
+    }
+
+    PROBE2(handshake_done, fd, PROBE_HS_TLS);
+    return ssl;
+}
+
+/*****************************************************************************
+* Function   : tls_close
+* Description: close_notify   SSL ü  ( ȣڰ )
+*****************************************************************************/
+void tls_close(SSL *ssl)
+{
+    if (ssl == NULL)
+        return;
+
+    // ڵũ     close_notify 
+    if (SSL_is_init_finished(ssl))
+        SSL_shutdown(ssl);
+    SSL_free(ssl);
+}
+
+/*****************************************************************************
+* Function   : tls_ktls_rx / tls_ktls_tx
+* Description: /۽  Ŀ TLS εǾ Ȯ
+*****************************************************************************/
+int tls_ktls_rx(SSL *ssl)
+{
+    return ssl != NULL && BIO_get_ktls_recv(SSL_get_rbio(ssl));
+}
+
+int tls_ktls_tx(SSL *ssl)
+{
+    return ssl != NULL && BIO_get_ktls_send(SSL_get_wbio(ssl));
+}
+
+/*****************************************************************************
+* Function   : tls_pending
+* Description: OpenSSL  ۿ  ȣȭ  
+*              (select()δ  Ƿ ȣڰ ߰ о )
+*****************************************************************************/
+int tls_pending(SSL *ssl)
+{
+    return ssl != NULL && !tls_ktls_rx(ssl) && SSL_pending(ssl) > 0;
+}
+
+/*****************************************************************************
+* Function   : tls_peek
+* Description: ̹   Һ ʰ  (ٸ , ŷ ϵ )
+*              ۽Ÿ ϴ Ŭ̾Ʈ  (503)  Ȯ  
+* Returns    :  Ʈ ,  Ͱ  0
+*****************************************************************************/
+ssize_t tls_peek(SSL *ssl, int fd, void *buf, size_t len)
+{
+    int flags = 0;
+    int n = 0;
+
+    if (ssl == NULL || tls_ktls_rx(ssl))
+    {
+        n = (int)recv(fd, buf, len, MSG_PEEK | MSG_DONTWAIT);
+        return n > 0 ? n : 0;
+    }
+
+    //  Ƽ   ڵ常   SSL_peek ŷ Ͽ ߹Ƿ  ŷ
+    flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+        return 0;
+    n = SSL_peek(ssl, buf, (int)len);
+    if (n <= 0)
+        ERR_clear_error();
+    fcntl(fd, F_SETFL, flags);
+
+    return n > 0 ? n : 0;
+}
+
+/*****************************************************************************
+* Function   : tls_recv
+* Description:  .  ̰ų kTLS    recv() ״ 
+* Returns    :  Ʈ , 0 ( ), -1 (, ŷ   errno = EAGAIN)
+*****************************************************************************/
+ssize_t tls_recv(SSL *ssl, int fd, void *buf, size_t len)
+{
+    ssize_t n = 0;
+    int err = 0;
+
+    if (ssl == NULL || tls_ktls_rx(ssl))
+    {
+        n = recv(fd, buf, len, 0);
+
+        // kTLS   application data ƴ ڵ(close_notify ) EIO 
+        if (n < 0 && errno == EIO && ssl != NULL)
+            return 0;
+
+        return n;
+    }
+
+    n = SSL_read(ssl, buf, (int)len);
+    if (n > 0)
+        return n;
+
+    err = SSL_get_error(ssl, (int)n);
+    if (err == SSL_ERROR_ZERO_RETURN)
+        return 0;
+
+    // ŷ :  TLS ڵ尡  
+    if (err == SSL_ERROR_WANT_READ)
+    {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    if (err == SSL_ERROR_SYSCALL && n == 0)
+        return 0;
+
+    return -1;
+}
+
+/*****************************************************************************
+* Function   : tls_send
+* Description:  ۽.  ̰ų kTLS ۽   send() ״ 
+* Returns    : ۽ Ʈ , -1 (, ŷ  ۽ ۰ á errno = EAGAIN)
+*****************************************************************************/
+ssize_t tls_send(SSL *ssl, int fd, const void *buf, size_t len)
+{
+    int n = 0;
+    int err = 0;
+
+    if (ssl == NULL || tls_ktls_tx(ssl))
+        return send(fd, buf, len, 0);
+
+    n = SSL_write(ssl, buf, (int)len);
+    if (n > 0)
+        return n;
+
+    // ŷ : ۽ ۰  ( /̷ ٽ ȣؾ )
+    err = SSL_get_error(ssl, n);
+    if (err == SSL_ERROR_WANT_WRITE || err == SSL_ERROR_WANT_READ)
+        errno = EAGAIN;
+
+    return -1;
+}
+
+/*****************************************************************************
+* Function   : tls_send_all
+* Description: len Ʈ    . ŷ Ͽ ۽ ۰ 
+*              (EAGAIN / SSL_ERROR_WANT_WRITE) POLLOUT ִ timeout_ms ٸ  ̾ 
+*               ª  (101, /metrics, Ϸ Ȯ, close )
+* Returns    : len, -1 ( Ǵ  ð ʰ)
+*****************************************************************************/
+ssize_t tls_send_all(SSL *ssl, int fd, const void *buf, size_t len, int timeout_ms)
+{
+    const unsigned char *p = buf;
+    struct pollfd pfd;
+    size_t done = 0;
+    ssize_t n = 0;
+
+    while (done < len)
+    {
+        n = tls_send(ssl, fd, p + done, len - done);
+        if (n > 0)
+        {
+            done += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n == 0 || errno != EAGAIN)
+            return -1;
+
+        pfd.fd = fd;
+        pfd.events = POLLOUT;
+        if (poll(&pfd, 1, timeout_ms) <= 0)
+            return -1;
+    }
+
+    return (ssize_t)len;
+}
+
+/*****************************************************************************
+* Function   : send_batch_init
+* Description: ۽   Ҵ
+* Parameters : - size_t cap :  ũ (0̸ put  ٷ )
+* Returns    : 0 (), -1 (޸ )
+*****************************************************************************/
+int send_batch_init(struct send_batch *b, size_t cap)
+{
+    b->len = 0;
+    b->cap = cap;
+    b->buf = NULL;
+    b->records = 0;
+    b->sent_bytes = 0;
+    b->sent_records = 0;
+    b->send_calls = 0;
+    b->partial_writes = 0;
+
+    if (cap == 0)
+        return 0;
+
+    b->buf = malloc(cap);
+    return b->buf != NULL ? 0 : -1;
+}
+
+/*****************************************************************************
+* Function   : batch_send
+* Description: len Ʈ     (κ ̸  ̾ )
+* Returns    : len, -1 ()
+*****************************************************************************/
+static ssize_t batch_send(struct send_batch *b, SSL *ssl, int fd, const void *data, size_t len)
+{
+    const unsigned char *p = data;
+    size_t done = 0;
+    ssize_t n = 0;
+
+    while (done < len)
+    {
+        n = tls_send(ssl, fd, p + done, len - done);
+        b->send_calls++;
+        if (n <= 0)
+            return -1;
+        if ((size_t)n < len - done)
+            b->partial_writes++;
+        done += n;
+    }
+
+    return (ssize_t)len;
+}
+
+/*****************************************************************************
+* Function   : send_batch_flush
+* Description:    
+* Returns    :  Ʈ , -1 ()
+*****************************************************************************/
+ssize_t send_batch_flush(struct send_batch *b, SSL *ssl, int fd)
+{
+    ssize_t n = 0;
+
+    if (b->len == 0)
+        return 0;
+
+    n = batch_send(b, ssl, fd, b->buf, b->len);
+    if (n > 0)
+    {
+        PROBE3(records_counted, fd, b->records, n);
+        b->sent_bytes += n;
+        b->sent_records += b->records;
+    }
+    b->len = 0;
+    b->records = 0;
+    return n;
+}
+
+/*****************************************************************************
+* Function   : send_batch_put
+* Description:  ߰.    ,  ū ʹ ٷ 
+* Returns    : 0 ̻ (), -1 ( )
+*****************************************************************************/
+ssize_t send_batch_put(struct send_batch *b, SSL *ssl, int fd, const void *data, size_t len)
+{
+    ssize_t n = 0;
+
+    if (b->len + len > b->cap && send_batch_flush(b, ssl, fd) < 0)
+        return -1;
+
+    if (len >= b->cap)
+    {
+        n = batch_send(b, ssl, fd, data, len);
+        if (n > 0)
+        {
+            PROBE3(records_counted, fd, 1, n);
+            b->sent_bytes += n;
+            b->sent_records++;
+        }
+        return n;
+    }
+
+    memcpy(b->buf + b->len, data, len);
+    b->len += len;
+    b->records++;
+    return (ssize_t)len;
+}
+
+/*****************************************************************************
+* Function   : send_batch_free
+* Description: ۽    ( ʹ ȣڰ  flush)
+*****************************************************************************/
+void send_batch_free(struct send_batch *b)
+{
+    free(b->buf);
+    b->buf = NULL;
+    b->len = 0;
+}
@@ -0,0 +1,53 @@
+/*****************************************************************************
+* File       : tls_offload.h
+* Description: OpenSSL ڵũ   Ű Ŀ(kTLS) ѱ TLS  Լ
+*****************************************************************************/
+
+#ifndef TLS_OFFLOAD_H
+#define TLS_OFFLOAD_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <openssl/ssl.h>
+
+#define TLS_RECORD_HANDSHAKE 0x16   // TLS ڵ Ÿ (ClientHello ù Ʈ)
+
+SSL_CTX* tls_server_ctx(const char *cert_file, const char *key_file, int use_ktls);
+SSL_CTX* tls_client_ctx(int use_ktls);
+
+int tls_accept(SSL_CTX *ctx, SSL **ssl, int fd);
+SSL* tls_connect(SSL_CTX *ctx, int fd);
+void tls_close(SSL *ssl);
+
+int tls_ktls_rx(SSL *ssl);
+int tls_ktls_tx(SSL *ssl);
+int tls_pending(SSL *ssl);
+
+ssize_t tls_recv(SSL *ssl, int fd, void *buf, size_t len);
+ssize_t tls_peek(SSL *ssl, int fd, void *buf, size_t len);
+ssize_t tls_send(SSL *ssl, int fd, const void *buf, size_t len);
+ssize_t tls_send_all(SSL *ssl, int fd, const void *buf, size_t len, int timeout_ms);
+
+/*****************************************************************************
+* Structure  : send_batch
+* Description:  ڵ/     ۽ 
+*              (Ʃ  write_chunk, 뷮 0̸  ʰ ٷ )
+*****************************************************************************/
+struct send_batch
+{
+    unsigned char *buf;
+    size_t len;
+    size_t cap;
+    size_t records;                 //   ִ ڵ() 
+    uint64_t sent_bytes;            //   Ʈ / ڵ (,  )
+    uint64_t sent_records;
+    uint64_t send_calls;            // send() / SSL_write ȣ 
+    uint64_t partial_writes;        // û   ȣ  ( ̾ )
+};
+
+int send_batch_init(struct send_batch *b, size_t cap);
+ssize_t send_batch_put(struct send_batch *b, SSL *ssl, int fd, const void *data, size_t len);
+ssize_t send_batch_flush(struct send_batch *b, SSL *ssl, int fd);
+void send_batch_free(struct send_batch *b);
+
+#endif
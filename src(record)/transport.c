@@ -0,0 +1,211 @@
+/*****************************************************************************
+* File       : transport.c
+* Description: TCP / Unix     Ŭ̾Ʈ  
+*               ȣƮ ڴ Unix  TCP  ġ ʰ 
+*****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/un.h>
+#include "transport.h"
+#include "tune.h"
+#include "probes.h"
+
+/*****************************************************************************
+* Function   : fill_unix_addr
+* Description: sockaddr_un ü ä
+* Returns    : 0 (), -1 (ΰ ʹ )
+*****************************************************************************/
+static int fill_unix_addr(struct sockaddr_un *addr, const char *path)
+{
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+
+    if (strlen(path) >= sizeof(addr->sun_path))
+    {
+        fprintf(stderr, "Unix  ΰ ʹ ϴ: %s\n", path);
+        return -1;
+    }
+
+    strcpy(addr->sun_path, path);
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : transport_listen_tcp
+* Description:  ̽ TCP Ʈ    (SO_REUSEADDR)
+*              Ʃ   ũ/TCP_DEFER_ACCEPT listen  
+* Returns    :  ,   -1
+*****************************************************************************/
+int transport_listen_tcp(int port, int backlog)
+{
+    int fd = 0;
+    int opt = 1;
+    struct sockaddr_in addr;
+
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        perror("  ");
+        return -1;
+    }
+
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0)
+    {
+        perror("setsockopt ");
+        close(fd);
+        return -1;
+    }
+
+    tune_apply_listener(&g_tune, fd, 1);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        perror("bind ");
+        close(fd);
+        return -1;
+    }
+
+    if (listen(fd, backlog) < 0)
+    {
+        perror("listen ");
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/*****************************************************************************
+* Function   : transport_listen_unix
+* Description: Unix     (     bind)
+* Parameters : - const char *path :   
+*              - int type         : SOCK_STREAM Ǵ SOCK_SEQPACKET
+*              - int backlog      : listen ⿭ 
+* Returns    :  ,   -1
+*****************************************************************************/
+int transport_listen_unix(const char *path, int type, int backlog)
+{
+    int fd = 0;
+    struct sockaddr_un addr;
+
+    if (fill_unix_addr(&addr, path) < 0)
+        return -1;
+
+    fd = socket(AF_UNIX, type, 0);
+    if (fd < 0)
+    {
+        perror("Unix   ");
+        return -1;
+    }
+
+    tune_apply_listener(&g_tune, fd, 0);
+
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        perror("Unix  bind ");
+        close(fd);
+        return -1;
+    }
+
+    if (listen(fd, backlog) < 0)
+    {
+        perror("Unix  listen ");
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/*****************************************************************************
+* Function   : transport_connect_tcp
+* Description: TCP   (  ũ SYN   ϹǷ connect  Ʃ )
+* Returns    :  ,   -1
+*****************************************************************************/
+int transport_connect_tcp(const char *ip, int port)
+{
+    int fd = 0;
+    struct sockaddr_in addr;
+
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        perror("  ");
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, ip, &addr.sin_addr);
+
+    tune_apply_socket(&g_tune, fd, 1);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        perror("  ");
+        close(fd);
+        return -1;
+    }
+
+    PROBE2(conn_connect, fd, TRANSPORT_TCP);
+    return fd;
+}
+
+/*****************************************************************************
+* Function   : transport_connect_unix
+* Description: Unix    
+* Parameters : - const char *path :   
+*              - int type         : SOCK_STREAM Ǵ SOCK_SEQPACKET
+* Returns    :  ,   -1
+*****************************************************************************/
+int transport_connect_unix(const char *path, int type)
+{
+    int fd = 0;
+    struct sockaddr_un addr;
+
+    if (fill_unix_addr(&addr, path) < 0)
+        return -1;
+
+    fd = socket(AF_UNIX, type, 0);
+    if (fd < 0)
+    {
+        perror("Unix   ");
+        return -1;
+    }
+
+    tune_apply_socket(&g_tune, fd, 0);
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        perror("  ");
+        close(fd);
+        return -1;
+    }
+
+    PROBE2(conn_connect, fd, type == SOCK_SEQPACKET ? TRANSPORT_SEQPACKET : TRANSPORT_UNIX);
+    return fd;
+}
+
+/*****************************************************************************
+* Function   : transport_name
+* Description: α ¿   ̸
+*****************************************************************************/
+const char* transport_name(int transport)
+{
+    switch (transport)
+    {
+        case TRANSPORT_UNIX:      return "unix";
+        case TRANSPORT_SEQPACKET: return "seqpacket";
+        case TRANSPORT_SHM:       return "shm";
+        default:                  return "tcp";
+    }
+}
@@ -0,0 +1,24 @@
+/*****************************************************************************
+* File       : transport.h
+* Description: TCP / Unix  (SOCK_STREAM, SOCK_SEQPACKET)    Լ
+*****************************************************************************/
+
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <sys/socket.h>
+
+#define TRANSPORT_TCP        0      // 127.0.0.1 / Ʈ 8331
+#define TRANSPORT_UNIX       1      // AF_UNIX SOCK_STREAM (WS ڵũ/ )
+#define TRANSPORT_SEQPACKET  2      // AF_UNIX SOCK_SEQPACKET (޽ 1 = ڵ 1)
+#define TRANSPORT_SHM        3      //  ޸  (AF_UNIX   )
+
+int transport_listen_tcp(int port, int backlog);
+int transport_listen_unix(const char *path, int type, int backlog);
+
+int transport_connect_tcp(const char *ip, int port);
+int transport_connect_unix(const char *path, int type);
+
+const char* transport_name(int transport);
+
+#endif
@@ -0,0 +1,276 @@
+/*****************************************************************************
+* File       : tune.c
+* Description:  Ʃ  - ̸ ִ ,  (Ű=),  
+*****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <ctype.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "tune.h"
+
+/*****************************************************************************
+* Structure  : presets
+* Description: ̸ ִ 
+*              - default    :  ϵڵ  (listen 10,  2KB recv, ڵ帶 send)
+*              - throughput : ū  /ûũ, ڵ带 64KB   send,
+*                             ū α, Ͱ   accept 
+*              - latency    : Nagle ,  ACK, busy poll, ڵ帶  send
+*****************************************************************************/
+static const struct tune_profile presets[] =
+{
+    { "default",    0,       0,       2048,  0,     0, 0, 0,  10,   0 },
+    { "throughput", 4194304, 4194304, 65536, 65536, 0, 0, 0,  1024, 1 },
+    { "latency",    0,       0,       16384, 0,     1, 1, 50, 128,  0 },
+};
+
+struct tune_profile g_tune = { "default", 0, 0, 2048, 0, 0, 0, 0, 10, 0 };
+
+/*****************************************************************************
+* Function   : tune_preset
+* Description: ̸  
+* Returns    : 0 (), -1 ( ̸)
+*****************************************************************************/
+int tune_preset(struct tune_profile *t, const char *name)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(presets) / sizeof(presets[0]); i++)
+    {
+        if (strcmp(presets[i].name, name) == 0)
+        {
+            *t = presets[i];
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+/*****************************************************************************
+* Function   : tune_set
+* Description: "Ű="  ׸  (    Ǵ --tune ɼ)
+*              preset≠  ش   
+* Returns    : 0 (), -1 (   Ű Ǵ ߸ )
+*****************************************************************************/
+int tune_set(struct tune_profile *t, const char *key_value)
+{
+    char key[32];
+    const char *eq = strchr(key_value, '=');
+    const char *val = NULL;
+    char *end = NULL;
+    size_t key_len = 0;
+    long v = 0;
+    long mult = 1;
+
+    if (eq == NULL)
+        return -1;
+
+    while (isspace((unsigned char)*key_value))
+        key_value++;
+
+    key_len = eq - key_value;
+    while (key_len > 0 && isspace((unsigned char)key_value[key_len - 1]))
+        key_len--;
+
+    if (key_len == 0 || key_len >= sizeof(key))
+        return -1;
+
+    memcpy(key, key_value, key_len);
+    key[key_len] = '\0';
+
+    val = eq + 1;
+    while (isspace((unsigned char)*val))
+        val++;
+
+    if (strcmp(key, "preset") == 0)
+    {
+        char name[32];
+        size_t n = strcspn(val, " \t\r\n");
+        if (n == 0 || n >= sizeof(name))
+            return -1;
+        memcpy(name, val, n);
+        name[n] = '\0';
+        return tune_preset(t, name);
+    }
+
+    errno = 0;
+    v = strtol(val, &end, 0);
+    if (errno != 0 || end == val || v < 0)
+        return -1;
+
+    // k/m ̻  (: rcvbuf=4m). ̻縦   int  Ȯ,
+    //  ڿ   ڰ  ("4x") ź
+    if (*end == 'k' || *end == 'K')
+    {
+        mult = 1024;
+        end++;
+    }
+    else if (*end == 'm' || *end == 'M')
+    {
+        mult = 1024 * 1024;
+        end++;
+    }
+    while (isspace((unsigned char)*end))
+        end++;
+    if (*end != '\0' || v > 0x7fffffff / mult)
+        return -1;
+    v *= mult;
+
+    if (strcmp(key, "rcvbuf") == 0)            t->rcvbuf = (int)v;
+    else if (strcmp(key, "sndbuf") == 0)       t->sndbuf = (int)v;
+    else if (strcmp(key, "read_chunk") == 0)   t->read_chunk = (int)v;
+    else if (strcmp(key, "write_chunk") == 0)  t->write_chunk = (int)v;
+    else if (strcmp(key, "nodelay") == 0)      t->nodelay = (int)v;
+    else if (strcmp(key, "quickack") == 0)     t->quickack = (int)v;
+    else if (strcmp(key, "busy_poll") == 0)    t->busy_poll = (int)v;
+    else if (strcmp(key, "backlog") == 0)      t->backlog = (int)v;
+    else if (strcmp(key, "defer_accept") == 0) t->defer_accept = (int)v;
+    else return -1;
+
+    if (t->read_chunk < 64)
+        t->read_chunk = 64;
+
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : tune_load
+* Description:  ̸ Ǵ  (ٸ Ű=, # ּ) 
+*                default   
+* Returns    : 0 (), -1 ()
+*****************************************************************************/
+int tune_load(struct tune_profile *t, const char *name_or_file)
+{
+    FILE *fp = NULL;
+    char line[256];
+    char *p = NULL;
+    int line_no = 0;
+
+    if (tune_preset(t, name_or_file) == 0)
+        return 0;
+
+    fp = fopen(name_or_file, "r");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "Ʃ  ã  : %s\n", name_or_file);
+        return -1;
+    }
+
+    tune_preset(t, "default");
+    while (fgets(line, sizeof(line), fp) != NULL)
+    {
+        line_no++;
+        if ((p = strchr(line, '#')) != NULL)
+            *p = '\0';
+
+        for (p = line; isspace((unsigned char)*p); p++)
+            ;
+        if (*p == '\0')
+            continue;
+
+        if (tune_set(t, p) < 0)
+        {
+            fprintf(stderr, "%s:%d: ߸ Ʃ ׸: %s", name_or_file, line_no, line);
+            fclose(fp);
+            return -1;
+        }
+    }
+
+    fclose(fp);
+    snprintf(t->name, sizeof(t->name), "%s", name_or_file);
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : tune_option
+* Description: getopt_long    Ʃ ɼ ó
+* Returns    : 1 (ó), 0 (Ʃ ɼ ƴ), -1 (߸ )
+*****************************************************************************/
+int tune_option(int c, const char *arg)
+{
+    if (c == TUNE_OPT_PROFILE)
+        return tune_load(&g_tune, arg) == 0 ? 1 : -1;
+
+    if (c == TUNE_OPT_SET)
+    {
+        if (tune_set(&g_tune, arg) < 0)
+        {
+            fprintf(stderr, "߸ Ʃ ׸: %s\n", arg);
+            return -1;
+        }
+        return 1;
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : set_int_opt
+* Description:  0 ƴ  setsockopt , д  
+*****************************************************************************/
+static void set_int_opt(int fd, int level, int name, int value, const char *label)
+{
+    if (value == 0)
+        return;
+
+    if (setsockopt(fd, level, name, &value, sizeof(value)) < 0)
+        fprintf(stderr, "setsockopt(%s=%d) : %s\n", label, value, strerror(errno));
+}
+
+/*****************************************************************************
+* Function   : tune_apply_listener
+* Description:  Ͽ  ( ũ accept Ͽ ӵ)
+*****************************************************************************/
+void tune_apply_listener(const struct tune_profile *t, int fd, int is_tcp)
+{
+    set_int_opt(fd, SOL_SOCKET, SO_RCVBUF, t->rcvbuf, "SO_RCVBUF");
+    set_int_opt(fd, SOL_SOCKET, SO_SNDBUF, t->sndbuf, "SO_SNDBUF");
+
+    if (is_tcp)
+        set_int_opt(fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, t->defer_accept, "TCP_DEFER_ACCEPT");
+}
+
+/*****************************************************************************
+* Function   : tune_apply_socket
+* Description:  Ͽ  (Ŭ̾Ʈ connect  ȣؾ   ݿ)
+*****************************************************************************/
+void tune_apply_socket(const struct tune_profile *t, int fd, int is_tcp)
+{
+    set_int_opt(fd, SOL_SOCKET, SO_RCVBUF, t->rcvbuf, "SO_RCVBUF");
+    set_int_opt(fd, SOL_SOCKET, SO_SNDBUF, t->sndbuf, "SO_SNDBUF");
+
+    if (!is_tcp)
+        return;
+
+    set_int_opt(fd, SOL_SOCKET, SO_BUSY_POLL, t->busy_poll, "SO_BUSY_POLL");
+    set_int_opt(fd, IPPROTO_TCP, TCP_NODELAY, t->nodelay, "TCP_NODELAY");
+    set_int_opt(fd, IPPROTO_TCP, TCP_QUICKACK, t->quickack, "TCP_QUICKACK");
+}
+
+/*****************************************************************************
+* Function   : tune_rearm_quickack
+* Description: TCP_QUICKACK Ŀ ٽ  ACK ǵǷ  ĸ 缳
+*****************************************************************************/
+void tune_rearm_quickack(const struct tune_profile *t, int fd)
+{
+    int one = 1;
+
+    if (t->quickack)
+        setsockopt(fd, IPPROTO_TCP, TCP_QUICKACK, &one, sizeof(one));
+}
+
+/*****************************************************************************
+* Function   : tune_print
+* Description:    
+*****************************************************************************/
+void tune_print(const struct tune_profile *t, FILE *fp)
+{
+    fprintf(fp, "Ʃ  [%s] rcvbuf=%d sndbuf=%d read_chunk=%d write_chunk=%d "
+                "nodelay=%d quickack=%d busy_poll=%d backlog=%d defer_accept=%d\n",
+            t->name, t->rcvbuf, t->sndbuf, t->read_chunk, t->write_chunk,
+            t->nodelay, t->quickack, t->busy_poll, t->backlog, t->defer_accept);
+}
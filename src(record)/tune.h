@@ -0,0 +1,53 @@
+/*****************************************************************************
+* File       : tune.h
+* Description:  Ʃ  ( ũ, TCP ɼ, listen α )
+*               /Ŭ̾Ʈ --profile / --tune ɼ 
+*****************************************************************************/
+
+#ifndef TUNE_H
+#define TUNE_H
+
+#include <stdio.h>
+#include <getopt.h>
+
+#define TUNE_OPT_PROFILE  0x100
+#define TUNE_OPT_SET      0x101
+
+//  α׷ long_options 迭 ߰ϴ  ɼ
+#define TUNE_LONG_OPTIONS \
+    { "profile", required_argument, NULL, TUNE_OPT_PROFILE }, \
+    { "tune",    required_argument, NULL, TUNE_OPT_SET }
+
+#define TUNE_USAGE "[--profile default|throughput|latency|] [--tune Ű= ...]"
+
+/*****************************************************************************
+* Structure  : tune_profile
+* Description:   ø̼  Ʃ  (0 = Ŀ/ ⺻ )
+*****************************************************************************/
+struct tune_profile
+{
+    char name[64];          //  ̸ Ǵ   
+    int rcvbuf;             // SO_RCVBUF (Ʈ)
+    int sndbuf;             // SO_SNDBUF (Ʈ)
+    int read_chunk;         //  recv() 1ȸ ũ (Ʈ)
+    int write_chunk;        // Ŭ̾Ʈ ۽  ũ (Ʈ, 0 = ڵ帶 send)
+    int nodelay;            // TCP_NODELAY (Nagle Ȱȭ)
+    int quickack;           // TCP_QUICKACK (recv ĸ 缳)
+    int busy_poll;          // SO_BUSY_POLL (ũ)
+    int backlog;            // listen() α
+    int defer_accept;       // TCP_DEFER_ACCEPT ()
+};
+
+extern struct tune_profile g_tune;
+
+int tune_preset(struct tune_profile *t, const char *name);
+int tune_load(struct tune_profile *t, const char *name_or_file);
+int tune_set(struct tune_profile *t, const char *key_value);
+int tune_option(int c, const char *arg);
+
+void tune_apply_listener(const struct tune_profile *t, int fd, int is_tcp);
+void tune_apply_socket(const struct tune_profile *t, int fd, int is_tcp);
+void tune_rearm_quickack(const struct tune_profile *t, int fd);
+void tune_print(const struct tune_profile *t, FILE *fp);
+
+#endif
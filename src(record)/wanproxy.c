@@ -0,0 +1,593 @@
+/*****************************************************************************
+* File       : wanproxy.c
+* Description:   WAN  ķ̼ ߰ (tc/netem, root  ʿ)
+*               RTT  ũʶ  /ڵ帶 send  巯 
+*              Ŭ̾Ʈ  ̿ Ʈ --mtu ũ Ŷ  ⺰  ť ְ
+*               ð 
+*              - --delay: ܹ  (RTT = 2  delay,  /101/Ϸ Ȯε  )
+*              - --jitter: Ŷ jitter յ  ( , TCPó  )
+*              - --rate: ⺰  뿪 (Ŷ ȭ ðŭ  Ŷ и)
+*              - --stall-prob / --stall: Ŷ Ȯ p ũ stall ms  
+*                (ս   ó  Ŷ  и head-of-line ü)
+*              - --queue: ⺰   Ʈ .  ۽   Ƿ ۽ڰ 
+*                (BDP/ȥ  , 뿪  RTT    ó)
+*               Ŭ̾Ʈ --unix ϹǷ Unix (--listen) ޾ (TCP 8331 Ǵ
+*              --unix) ߰. --port TCPε 
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "transport.h"
+#include "tune.h"
+#include "latency.h"
+
+#define PORT            8331
+#define MAX_SESSIONS    64
+#define MTU_DEFAULT     1448            // ̴ MSS (Ŷ 1 ִ ̷ε)
+#define QUEUE_DEFAULT   (4 * 1024 * 1024)
+#define STALL_DEFAULT   200             // ms (ּ RTO )
+#define POLL_IDLE_MS    1000
+
+/*****************************************************************************
+* Structure  : packet
+* Description:  ť Ŷ 1 ( Ʈ    ð)
+*****************************************************************************/
+struct packet
+{
+    struct packet *next;
+    uint64_t due_ns;
+    size_t len;
+    size_t off;                         // κ ۵ Ʈ
+    unsigned char data[];
+};
+
+/*****************************************************************************
+* Structure  : wan_link
+* Description:   (Ŭ̾Ʈ   Ǵ   Ŭ̾Ʈ) ũ 
+*****************************************************************************/
+struct wan_link
+{
+    int from;
+    int to;
+    struct packet *head;
+    struct packet *tail;
+    size_t queued;                      // ť ִ Ʈ
+    size_t max_queued;
+    uint64_t link_free_ns;              //   Ŷ ȭ  ð
+    uint64_t last_due_ns;               // Ͱ ־  
+    uint64_t bytes;
+    uint64_t packets;
+    uint64_t stalls;
+    int blocked;                        // to EAGAIN  POLLOUT 
+    int eof;                            // from ⸦  (Ǵ )
+    int done;                           // ť  to   
+};
+
+/*****************************************************************************
+* Structure  : wan_session
+* Description: ߰  1 (Ŭ̾Ʈ  )
+*****************************************************************************/
+struct wan_session
+{
+    int client_fd;                      // -1̸  ĭ
+    int server_fd;
+    int id;
+    uint64_t start_ns;
+    struct wan_link up;                 // Ŭ̾Ʈ  
+    struct wan_link down;               //   Ŭ̾Ʈ
+};
+
+/*****************************************************************************
+* Structure  : wan_conf
+* Description: ũ  ( ,  )
+*****************************************************************************/
+struct wan_conf
+{
+    uint64_t delay_ns;
+    uint64_t jitter_ns;
+    double rate;                        // Ʈ/ (0̸  )
+    double stall_prob;
+    uint64_t stall_ns;
+    size_t mtu;
+    size_t queue;
+};
+
+static uint64_t g_rand_state = 88172645463325252ULL;
+
+/*****************************************************************************
+* Function   : wan_rand
+* Description: xorshift64 (--seed  /ü  )
+* Returns    : [0, 1) յ 
+*****************************************************************************/
+static double wan_rand(void)
+{
+    g_rand_state ^= g_rand_state << 13;
+    g_rand_state ^= g_rand_state >> 7;
+    g_rand_state ^= g_rand_state << 17;
+    return (g_rand_state >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*****************************************************************************
+* Function   : parse_rate
+* Description: ӵ ڿ ؼ (k / m / g ̻, 1000 )
+* Returns    : ʴ Ʈ,   0
+*****************************************************************************/
+static double parse_rate(const char *s)
+{
+    char *end = NULL;
+    double v = strtod(s, &end);
+
+    if (end == s || v < 0)
+        return 0;
+
+    switch (*end)
+    {
+        case 'k': case 'K': v *= 1e3; break;
+        case 'm': case 'M': v *= 1e6; break;
+        case 'g': case 'G': v *= 1e9; break;
+        case '\0': break;
+        default: return 0;
+    }
+
+    return v;
+}
+
+/*****************************************************************************
+* Function   : link_init
+* Description:  1 ʱȭ
+*****************************************************************************/
+static void link_init(struct wan_link *l, int from, int to)
+{
+    memset(l, 0, sizeof(*l));
+    l->from = from;
+    l->to = to;
+}
+
+/*****************************************************************************
+* Function   : link_drop
+* Description: ť  Ŷ    (밡 ̹ ݾҰų )
+*****************************************************************************/
+static void link_drop(struct wan_link *l)
+{
+    struct packet *p = NULL;
+
+    while (l->head != NULL)
+    {
+        p = l->head;
+        l->head = p->next;
+        free(p);
+    }
+    l->tail = NULL;
+    l->queued = 0;
+    l->eof = 1;
+    l->done = 1;
+}
+
+/*****************************************************************************
+* Function   : link_schedule
+* Description:  Ŷ   ð 
+*                ð ȭ(len / rate)  ü(Ȯ)     
+*              ü link_free_ns ̷Ƿ  Ŷ Բ и
+*****************************************************************************/
+static uint64_t link_schedule(struct wan_link *l, const struct wan_conf *conf, size_t len, uint64_t now)
+{
+    uint64_t sent = now;
+    uint64_t due = 0;
+    double jitter = 0.0;
+
+    if (conf->rate > 0)
+    {
+        sent = (l->link_free_ns > now ? l->link_free_ns : now) + (uint64_t)(len * 1e9 / conf->rate);
+        l->link_free_ns = sent;
+    }
+
+    if (conf->stall_prob > 0 && wan_rand() < conf->stall_prob)
+    {
+        sent = (l->link_free_ns > sent ? l->link_free_ns : sent) + conf->stall_ns;
+        l->link_free_ns = sent;
+        l->stalls++;
+    }
+
+    due = sent + conf->delay_ns;
+    if (conf->jitter_ns > 0)
+    {
+        jitter = (wan_rand() * 2.0 - 1.0) * conf->jitter_ns;
+        due = jitter < 0 && (uint64_t)-jitter > due - sent ? sent : (uint64_t)(due + jitter);
+    }
+
+    if (due < l->last_due_ns)
+        due = l->last_due_ns;
+    l->last_due_ns = due;
+    return due;
+}
+
+/*****************************************************************************
+* Function   : link_read
+* Description: from   ִ ŭ(ť ѵ) MTU ũ Ŷ о  ť 
+*****************************************************************************/
+static void link_read(struct wan_link *l, const struct wan_conf *conf)
+{
+    struct packet *p = NULL;
+    uint64_t now = latency_now_ns();
+    ssize_t n = 0;
+
+    while (!l->eof && l->queued + conf->mtu <= conf->queue)
+    {
+        p = malloc(sizeof(*p) + conf->mtu);
+        if (p == NULL)
+        {
+            perror("޸ Ҵ ");
+            return;
+        }
+
+        n = read(l->from, p->data, conf->mtu);
+        if (n <= 0)
+        {
+            free(p);
+            if (n < 0 && (errno == EAGAIN || errno == EINTR))
+                return;
+            l->eof = 1;
+            return;
+        }
+
+        p->next = NULL;
+        p->len = n;
+        p->off = 0;
+        p->due_ns = link_schedule(l, conf, n, now);
+        if (l->tail != NULL)
+            l->tail->next = p;
+        else
+            l->head = p;
+        l->tail = p;
+        l->queued += n;
+        if (l->queued > l->max_queued)
+            l->max_queued = l->queued;
+        l->bytes += n;
+        l->packets++;
+    }
+}
+
+/*****************************************************************************
+* Function   : link_write
+* Description:  ð  Ŷ to . ť  from  to   
+*              밡 ̹ ݾ(EPIPE )  Ŷ 
+*****************************************************************************/
+static void link_write(struct wan_link *l, uint64_t now)
+{
+    struct packet *p = NULL;
+    ssize_t n = 0;
+
+    l->blocked = 0;
+    while ((p = l->head) != NULL && p->due_ns <= now)
+    {
+        n = send(l->to, p->data + p->off, p->len - p->off, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EAGAIN || errno == EINTR)
+            {
+                l->blocked = 1;
+                return;
+            }
+            link_drop(l);
+            return;
+        }
+
+        p->off += n;
+        if (p->off < p->len)
+        {
+            l->blocked = 1;
+            return;
+        }
+
+        l->head = p->next;
+        if (l->head == NULL)
+            l->tail = NULL;
+        l->queued -= p->len;
+        free(p);
+    }
+
+    if (l->head == NULL && l->eof && !l->done)
+    {
+        shutdown(l->to, SHUT_WR);
+        l->done = 1;
+    }
+}
+
+/*****************************************************************************
+* Function   : set_nonblocking
+* Description:  ŷ ȯ
+*****************************************************************************/
+static void set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+
+    if (flags >= 0)
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+/*****************************************************************************
+* Function   : session_open
+* Description:  Ŭ̾Ʈ  ϰ  ĭ 
+* Returns    : 0 (), -1 (, Ŭ̾Ʈ  )
+*****************************************************************************/
+static int session_open(struct wan_session *sessions, int client_fd, const char *server_unix, int id)
+{
+    struct wan_session *s = NULL;
+    int server_fd = -1;
+    int opt = 1;
+    int i;
+
+    for (i = 0; i < MAX_SESSIONS && sessions[i].client_fd >= 0; i++)
+        ;
+    if (i == MAX_SESSIONS)
+    {
+        fprintf(stderr, "߰   ʰ (ִ %d)\n", MAX_SESSIONS);
+        close(client_fd);
+        return -1;
+    }
+
+    server_fd = server_unix ? transport_connect_unix(server_unix, SOCK_STREAM)
+                            : transport_connect_tcp("127.0.0.1", PORT);
+    if (server_fd < 0)
+    {
+        close(client_fd);
+        return -1;
+    }
+
+    // ߰Ⱑ  Ŷ    Ƿ Nagle  ( Ŭ̾Ʈ )
+    if (!server_unix)
+        setsockopt(server_fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+    set_nonblocking(client_fd);
+    set_nonblocking(server_fd);
+
+    s = &sessions[i];
+    s->client_fd = client_fd;
+    s->server_fd = server_fd;
+    s->id = id;
+    s->start_ns = latency_now_ns();
+    link_init(&s->up, client_fd, server_fd);
+    link_init(&s->down, server_fd, client_fd);
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : session_close
+* Description: ߰    ⺰  
+*****************************************************************************/
+static void session_close(struct wan_session *s)
+{
+    double elapsed = (latency_now_ns() - s->start_ns) / 1e9;
+
+    printf("[WAN]  %d: %.3f , Ŭ̾Ʈ   %llu Ʈ (Ŷ %llu, ü %llu, ִ ť %zu), "
+           "  Ŭ̾Ʈ %llu Ʈ (Ŷ %llu, ü %llu), %.2f MB/s\n",
+           s->id, elapsed, (unsigned long long)s->up.bytes, (unsigned long long)s->up.packets,
+           (unsigned long long)s->up.stalls, s->up.max_queued,
+           (unsigned long long)s->down.bytes, (unsigned long long)s->down.packets,
+           (unsigned long long)s->down.stalls,
+           elapsed > 0 ? s->up.bytes / 1048576.0 / elapsed : 0.0);
+    fflush(stdout);
+
+    link_drop(&s->up);
+    link_drop(&s->down);
+    close(s->client_fd);
+    close(s->server_fd);
+    s->client_fd = -1;
+    s->server_fd = -1;
+}
+
+/*****************************************************************************
+* Function   : link_timeout
+* Description:    ð  ð poll  ð ̱
+*****************************************************************************/
+static void link_timeout(const struct wan_link *l, uint64_t now, int *timeout_ms)
+{
+    int ms = 0;
+
+    if (l->head == NULL || l->blocked)
+        return;
+
+    ms = l->head->due_ns > now ? (int)((l->head->due_ns - now + 999999) / 1000000) : 0;
+    if (*timeout_ms < 0 || ms < *timeout_ms)
+        *timeout_ms = ms;
+}
+
+/*****************************************************************************
+* Function   : run_proxy
+* Description:  / ⺰ б   ť   ð  (poll  )
+*              poll   ̸   ð (и ,  е ~1 ms)
+* Returns    : 0 ( ), -1 ( ߻ )
+*****************************************************************************/
+static int run_proxy(int listen_fds[2], const char *server_unix, const struct wan_conf *conf)
+{
+    static struct wan_session sessions[MAX_SESSIONS];
+    struct pollfd fds[2 + MAX_SESSIONS * 2];
+    int polled[MAX_SESSIONS];
+    struct wan_session *s = NULL;
+    uint64_t now = 0;
+    int next_id = 1;
+    int timeout_ms = 0;
+    int nfds = 0;
+    int client_fd = -1;
+    int i, k;
+
+    for (i = 0; i < MAX_SESSIONS; i++)
+        sessions[i].client_fd = -1;
+
+    while (1)
+    {
+        now = latency_now_ns();
+        timeout_ms = -1;
+        for (k = 0; k < 2; k++)
+        {
+            fds[k].fd = listen_fds[k];
+            fds[k].events = POLLIN;
+        }
+        nfds = 2;
+        for (i = 0; i < MAX_SESSIONS; i++)
+        {
+            s = &sessions[i];
+            fds[nfds].fd = fds[nfds + 1].fd = -1;
+            polled[i] = s->client_fd >= 0;
+            if (s->client_fd >= 0)
+            {
+                fds[nfds].fd = s->client_fd;
+                fds[nfds].events = (!s->up.eof && s->up.queued + conf->mtu <= conf->queue ? POLLIN : 0) |
+                                   (s->down.blocked ? POLLOUT : 0);
+                fds[nfds + 1].fd = s->server_fd;
+                fds[nfds + 1].events = (!s->down.eof && s->down.queued + conf->mtu <= conf->queue ? POLLIN : 0) |
+                                       (s->up.blocked ? POLLOUT : 0);
+                // ٸ ̺Ʈ  poll  (밡   events = 0̾
+                // POLLHUP  ֹǷ ״ θ poll ٷ  CPU Ҹ)
+                if (fds[nfds].events == 0)
+                    fds[nfds].fd = -1;
+                if (fds[nfds + 1].events == 0)
+                    fds[nfds + 1].fd = -1;
+                link_timeout(&s->up, now, &timeout_ms);
+                link_timeout(&s->down, now, &timeout_ms);
+            }
+            nfds += 2;
+        }
+        if (timeout_ms < 0 || timeout_ms > POLL_IDLE_MS)
+            timeout_ms = POLL_IDLE_MS;
+
+        if (poll(fds, nfds, timeout_ms) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("poll ");
+            return -1;
+        }
+
+        for (k = 0; k < 2; k++)
+        {
+            if (fds[k].fd >= 0 && (fds[k].revents & POLLIN))
+            {
+                client_fd = accept(fds[k].fd, NULL, NULL);
+                if (client_fd >= 0 && session_open(sessions, client_fd, server_unix, next_id) == 0)
+                    next_id++;
+            }
+        }
+
+        for (i = 0; i < MAX_SESSIONS; i++)
+        {
+            s = &sessions[i];
+            if (s->client_fd < 0 || !polled[i])
+                continue;   // ̹ poll ڿ   ĭ
+
+            if (fds[2 + i * 2].revents & (POLLIN | POLLHUP | POLLERR))
+                link_read(&s->up, conf);
+            if (fds[2 + i * 2 + 1].revents & (POLLIN | POLLHUP | POLLERR))
+                link_read(&s->down, conf);
+
+            now = latency_now_ns();
+            link_write(&s->up, now);
+            link_write(&s->down, now);
+            if (s->up.done && s->down.done)
+                session_close(s);
+        }
+    }
+
+    return 0;
+}
+
+/*****************************************************************************
+* Function   : main
+* Description: ɼ ؼ,     ߰ 
+* Returns    : 0 ( ), -1 ( ߻ )
+*****************************************************************************/
+int main(int argc, char *argv[])
+{
+    struct wan_conf conf;
+    const char *listen_path = NULL;
+    const char *server_unix = NULL;
+    char bandwidth[32] = "";
+    int listen_fds[2] = { -1, -1 };
+    int port = 0;
+    int bad = 0;
+    int c;
+    static struct option long_options[] = {
+        { "listen",     required_argument, NULL, 'l' },
+        { "port",       required_argument, NULL, 'P' },
+        { "unix",       required_argument, NULL, 'u' },
+        { "delay",      required_argument, NULL, 'd' },
+        { "jitter",     required_argument, NULL, 'J' },
+        { "rate",       required_argument, NULL, 'r' },
+        { "stall-prob", required_argument, NULL, 'p' },
+        { "stall",      required_argument, NULL, 's' },
+        { "mtu",        required_argument, NULL, 'm' },
+        { "queue",      required_argument, NULL, 'q' },
+        { "seed",       required_argument, NULL, 'S' },
+        TUNE_LONG_OPTIONS,
+        { NULL, 0, NULL, 0 }
+    };
+
+    memset(&conf, 0, sizeof(conf));
+    conf.stall_ns = STALL_DEFAULT * 1000000ULL;
+    conf.mtu = MTU_DEFAULT;
+    conf.queue = QUEUE_DEFAULT;
+
+    while ((c = getopt_long(argc, argv, "", long_options, NULL)) != -1)
+    {
+        int r = tune_option(c, optarg);
+        if (r < 0)
+            return -1;
+        if (r > 0)
+            continue;
+
+        switch (c)
+        {
+            case 'l': listen_path = optarg; break;
+            case 'P': port = atoi(optarg); break;
+            case 'u': server_unix = optarg; break;
+            case 'd': conf.delay_ns = (uint64_t)(atof(optarg) * 1e6); break;
+            case 'J': conf.jitter_ns = (uint64_t)(atof(optarg) * 1e6); break;
+            case 'r': conf.rate = parse_rate(optarg); bad |= conf.rate <= 0; break;
+            case 'p': conf.stall_prob = atof(optarg); break;
+            case 's': conf.stall_ns = (uint64_t)(atof(optarg) * 1e6); break;
+            case 'm': conf.mtu = strtoul(optarg, NULL, 10); break;
+            case 'q': conf.queue = (size_t)parse_rate(optarg); break;
+            case 'S': g_rand_state = strtoull(optarg, NULL, 10) | 1; break;
+            default: bad = 1; break;
+        }
+    }
+
+    if (bad || optind != argc || (listen_path == NULL && port <= 0) || port == PORT ||
+        conf.mtu == 0 || conf.queue < conf.mtu || conf.stall_prob < 0 || conf.stall_prob > 1)
+    {
+        fprintf(stderr, ": %s --listen  | --port Ʈ [--unix ]\n"
+                        "       [--delay ms] [--jitter ms] [--rate Ʈ/] [--stall-prob p] [--stall ms]\n"
+                        "       [--mtu Ʈ] [--queue Ʈ] [--seed n] %s\n"
+                        "       (/뿪 ⺰, RTT = 2  delay, ӵ/ť k/m/g ̻)\n",
+                argv[0], TUNE_USAGE);
+        return -1;
+    }
+
+    if (listen_path != NULL && (listen_fds[0] = transport_listen_unix(listen_path, SOCK_STREAM, g_tune.backlog)) < 0)
+        return -1;
+    if (port > 0 && (listen_fds[1] = transport_listen_tcp(port, g_tune.backlog)) < 0)
+        return -1;
+
+    if (conf.rate > 0)
+        snprintf(bandwidth, sizeof(bandwidth), "%.2f MB/s", conf.rate / 1048576.0);
+    printf("WAN ߰:  %s, ܹ  %.1f ms  %.1f ms, 뿪 %s, ü Ȯ %g (%.0f ms), "
+           "MTU %zu, ť %zu Ʈ\n",
+           server_unix ? server_unix : "127.0.0.1:8331", conf.delay_ns / 1e6, conf.jitter_ns / 1e6,
+           bandwidth, conf.stall_prob, conf.stall_ns / 1e6, conf.mtu, conf.queue);
+    if (listen_path != NULL)
+        printf("Unix   : %s (Ŭ̾Ʈ --unix %s)\n", listen_path, listen_path);
+    if (port > 0)
+        printf("TCP  Ʈ: %d\n", port);
+    fflush(stdout);
+
+    return run_proxy(listen_fds, server_unix, &conf);
+}
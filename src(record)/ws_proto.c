@@ -0,0 +1,231 @@
+/*****************************************************************************
+* File       : ws_proto.c
+* Description: WebSocket ڵũ Ű ,  ŷ/ڵ,  ٲ 
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <openssl/sha.h>
+#include <openssl/bio.h>
+#include <openssl/evp.h>
+#include <openssl/buffer.h>
+#include "ws_proto.h"
+
+/*****************************************************************************
+* Function   : base64_encode
+* Description: ̳ʸ ͸ base64 ڵ
+*****************************************************************************/
+char* base64_encode(const unsigned char *input, int length)
+{
+    BIO *bmem = NULL;
+    BIO *b64 = NULL;
+    BUF_MEM *bptr = NULL;
+    char *buff = NULL;
+
+    b64 = BIO_new(BIO_f_base64());
+    bmem = BIO_new(BIO_s_mem());
+    b64 = BIO_push(b64, bmem);
+
+    BIO_set_flags(b64, BIO_FLAGS_BASE64_NO_NL);
+    BIO_write(b64, input, length);
+    BIO_flush(b64);
+    BIO_get_mem_ptr(b64, &bptr);
+
+    buff = (char *)malloc(bptr->length + 1);
+    memcpy(buff, bptr->data, bptr->length);
+    buff[bptr->length] = '\0';
+
+    BIO_free_all(b64);
+
+    return buff;
+}
+
+/*****************************************************************************
+* Function   : compute_accept_key
+* Description: WebSocket ڵũ Accept Ű 
+*****************************************************************************/
+char* compute_accept_key(const char *client_key)
+{
+    char concatenated[256];
+    unsigned char hash[SHA_DIGEST_LENGTH];
+
+    snprintf(concatenated, sizeof(concatenated), "%s%s", client_key, WS_GUID);
+    SHA1((unsigned char*)concatenated, strlen(concatenated), hash);
+
+    return base64_encode(hash, SHA_DIGEST_LENGTH);
+}
+
+/*****************************************************************************
+* Function   : extract_websocket_key
+* Description: û  Sec-WebSocket-Key 
+*****************************************************************************/
+char* extract_websocket_key(const char *request)
+{
+    const char *key_header = "Sec-WebSocket-Key: ";
+    char *key_start = NULL;
+    char *key_end = NULL;
+    char *key = NULL;
+    size_t key_len = 0;
+
+    key_start = strstr(request, key_header);
+    if (key_start == 0)
+        return NULL;
+
+    key_start += strlen(key_header);
+    key_end = strstr(key_start, "\r\n");
+    if (key_end == 0) 
+        return NULL;
+
+    key_len = key_end - key_start;
+    key = malloc(key_len + 1);
+    strncpy(key, key_start, key_len);
+    key[key_len] = '\0';
+
+    return key;
+}
+
+/*****************************************************************************
+* Function   : decode_ws_frame
+* Description: WebSocket  ڵϰ ŷ  (ҿ   ó )
+*****************************************************************************/
+int decode_ws_frame(const unsigned char *frame, size_t length, unsigned char *output, size_t *frame_len_out)
+{
+    size_t payload_len = 0;
+    size_t offset = 0;
+    size_t i = 0;
+    const unsigned char *mask_key = NULL;
+    const unsigned char *payload = NULL;
+
+    if (length < 6)
+        return 0; //     
+
+    payload_len = frame[1] & 0x7F;
+    offset = 2;
+
+    if (payload_len == 126)
+    {
+        if (length < 4)
+            return 0;
+
+        payload_len = (frame[2] << 8) | frame[3];
+        offset += 2;
+    }
+    else if (payload_len == 127)
+    {
+        if (length < 10)
+            return 0;
+
+        payload_len = 0;
+        for (i = 0; i < 8; i++)
+        {
+            payload_len |= ((size_t)frame[offset + i]) << (8 * (7 - i));
+        }
+        offset += 8;
+    }
+
+    if (length < offset + 4 + payload_len)
+        return 0; // Ͱ   ŵ   
+
+    mask_key = frame + offset;
+    payload = frame + offset + 4;
+
+    for (i = 0; i < payload_len; i++)
+    {
+        output[i] = payload[i] ^ mask_key[i % 4];
+    }
+
+    if (frame_len_out)
+    {
+        *frame_len_out = offset + 4 + payload_len;
+    }
+
+    return (int)payload_len;
+}
+
+/*****************************************************************************
+* Function   : create_ws_frame_masked
+* Description: Ŭ̾Ʈ WebSocket   (ŷ )
+* Parameters : - const unsigned char *payload :  ̷ε
+*              - size_t payload_len           : ̷ε 
+*              - size_t *frame_len            :    ȯ 
+* Returns    :   (heap ޸)
+*****************************************************************************/
+unsigned char* create_ws_frame_masked(const unsigned char* payload, size_t payload_len, size_t* frame_len)
+{
+    unsigned char *frame = NULL;
+    size_t header_len = 2;
+    size_t extra_len = 0;
+    size_t mask_len = 4;
+    unsigned char mask_key[4] = {0x12, 0x34, 0x56, 0x78};
+    size_t i = 0;
+
+    if (payload_len > 125 && payload_len < 65536)
+    {
+        extra_len = 2;
+    }
+    else if (payload_len >= 65536)
+    {
+        extra_len = 8;
+    }
+
+    *frame_len = header_len + extra_len + mask_len + payload_len;
+    frame = malloc(*frame_len);
+    if (!frame)
+    {
+        return NULL;
+    }
+
+    frame[0] = 0x81;
+
+    if (payload_len <= 125)
+    {
+        frame[1] = 0x80 | (unsigned char)payload_len;
+        memcpy(frame + 2, mask_key, 4);
+        for (i = 0; i < payload_len; i++)
+        {
+            frame[6 + i] = payload[i] ^ mask_key[i % 4];
+        }
+    }
+    else if (payload_len < 65536)
+    {
+        frame[1] = 0x80 | 126;
+        frame[2] = (payload_len >> 8) & 0xFF;
+        frame[3] = payload_len & 0xFF;
+        memcpy(frame + 4, mask_key, 4);
+        for (i = 0; i < payload_len; i++)
+        {
+            frame[8 + i] = payload[i] ^ mask_key[i % 4];
+        }
+    }
+    else
+    {
+        frame[1] = 0x80 | 127;
+        for (i = 0; i < 8; i++)
+        {
+            frame[2 + i] = (payload_len >> ((7 - i) * 8)) & 0xFF;
+        }
+        memcpy(frame + 10, mask_key, 4);
+        for (i = 0; i < payload_len; i++)
+        {
+            frame[14 + i] = payload[i] ^ mask_key[i % 4];
+        }
+    }
+
+    return frame;
+}
+
+/*****************************************************************************
+* Function   : count_newlines
+* Description:   ٲ(ڵ ) 
+*****************************************************************************/
+size_t count_newlines(const unsigned char *buf, size_t len)
+{
+    size_t count = 0;
+    size_t i = 0;
+
+    for (i = 0; i < len; i++)
+        if (buf[i] == '\n') count++;
+
+    return count;
+}
@@ -0,0 +1,21 @@
+/*****************************************************************************
+* File       : ws_proto.h
+* Description: WebSocket ڵũ/ ó ڵ( ٲ) 
+*              /Ŭ̾Ʈ š۽  ٽ Լ (microbench  )
+*****************************************************************************/
+
+#ifndef WS_PROTO_H
+#define WS_PROTO_H
+
+#include <stddef.h>
+
+#define WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+char* base64_encode(const unsigned char *input, int length);
+char* compute_accept_key(const char *client_key);
+char* extract_websocket_key(const char *request);
+int decode_ws_frame(const unsigned char *frame, size_t length, unsigned char *output, size_t *frame_len_out);
+unsigned char* create_ws_frame_masked(const unsigned char* payload, size_t payload_len, size_t* frame_len);
+size_t count_newlines(const unsigned char *buf, size_t len);
+
+#endif